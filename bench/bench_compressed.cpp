@@ -0,0 +1,114 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_compressed.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+typedef dna_container<dna_alph> dna;
+
+//! DNA weighted string of n positions where one position in 20 is uncertain
+static w_string_dna mostly_certain_ws(size_t n, unsigned seed = 42)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> letter(0, 3);
+    std::uniform_real_distribution<double> uniform(.5, 1.);
+
+    w_string_dna ws;
+    ws.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        dna wc;
+
+        if (0 == i % 20) {
+            double p = uniform(gen);
+            int l = letter(gen);
+
+            wc["ACGT"[l]] = p;
+            wc["ACGT"[(l + 1) % 4]] = 1. - p;
+        }
+        else {
+            wc["ACGT"[letter(gen)]] = 1.;
+        }
+
+        ws.emplace_back(wc, false);
+    }
+
+    return ws;
+}
+
+//! Heaviest string of 2^20 positions, from the weighted string (argument 0) or from its compressed form (argument 1)
+static void BM_CompressedHeaviest(benchmark::State& state)
+{
+    w_string_dna ws = mostly_certain_ws(1 << 20);
+    compressed_ws<dna> cws(ws);
+    std::vector<char> out(ws.size());
+
+    for (auto _ : state) {
+        size_t length = 0 == state.range(0) ? ws.heaviest(out.data()) : cws.heaviest(out.data());
+        benchmark::DoNotOptimize(length);
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+    state.counters["bytes_per_position"] = static_cast<double>(0 == state.range(0) ? ws.size() * sizeof(ws[0]) : cws.memory()) / ws.size();
+}
+
+BENCHMARK(BM_CompressedHeaviest)->Arg(0)->Arg(1);
+
+//! Occurrences of patterns of 12 letters in 2^20 positions with z = 16, with the matcher of each form
+static void BM_CompressedFind(benchmark::State& state)
+{
+    w_string_dna ws = mostly_certain_ws(1 << 20);
+    compressed_ws<dna> cws(ws);
+
+    std::string h = ws.heaviest();
+    std::vector<std::string> patterns = {h.substr(1000, 12), h.substr(500000, 12), random_letters(alph4, 12)};
+
+    weighted_pattern_matcher<w_string_dna> matcher(ws, 16.);
+    compressed_pattern_matcher<dna> compressed_matcher(cws, 16.);
+
+    for (auto _ : state) {
+        auto occ = 0 == state.range(0) ? matcher.find_all(patterns) : compressed_matcher.find_all(patterns);
+        benchmark::DoNotOptimize(occ.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size() * patterns.size());
+}
+
+BENCHMARK(BM_CompressedFind)->Arg(0)->Arg(1);
+
+//! Random access to the probability of a letter
+static void BM_CompressedAccess(benchmark::State& state)
+{
+    w_string_dna ws = mostly_certain_ws(1 << 20);
+    compressed_ws<dna> cws(ws);
+
+    std::mt19937 gen(1);
+    std::uniform_int_distribution<size_t> position(0, ws.size() - 1);
+    std::vector<size_t> positions(1 << 12);
+
+    for (size_t& i : positions) {
+        i = position(gen);
+    }
+
+    for (auto _ : state) {
+        double sum = 0.;
+
+        for (size_t i : positions) {
+            sum += 0 == state.range(0) ? ws[i].p('A') : cws.p(i, 'A');
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * positions.size());
+}
+
+BENCHMARK(BM_CompressedAccess)->Arg(0)->Arg(1);
\ No newline at end of file
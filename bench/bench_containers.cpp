@@ -0,0 +1,255 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+
+#include <wstr/dna_weighted_string.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+/*!
+  *
+  * Comparison of containers (w_char_map and w_char_array) on the queries of weighted strings
+  * Each benchmark is instantiated for alphabets of 4, 20 and 62 letters, the argument is the length of the weighted string
+  * (see bench_lengths)
+  *
+ */
+
+#define WSTR_BENCH_CONTAINERS(BM)                                               \
+    BENCHMARK_TEMPLATE(BM, w_string_map, alph4)->Apply(bench_lengths);           \
+    BENCHMARK_TEMPLATE(BM, w_string_array<alph4>, alph4)->Apply(bench_lengths);  \
+    BENCHMARK_TEMPLATE(BM, w_string_map, alph20)->Apply(bench_lengths);          \
+    BENCHMARK_TEMPLATE(BM, w_string_array<alph20>, alph20)->Apply(bench_lengths);\
+    BENCHMARK_TEMPLATE(BM, w_string_map, alph62)->Apply(bench_lengths);          \
+    BENCHMARK_TEMPLATE(BM, w_string_array<alph62>, alph62)->Apply(bench_lengths)
+
+//! Probability of a random letter at each position
+template <class WString, const char* alph>
+static void BM_Lookup(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, state.range(0));
+    std::string letters = random_letters(alph, ws.size());
+
+    for (auto _ : state) {
+        double p = 0.;
+
+        for (size_t i = 0; i < ws.size(); ++i) {
+            p += ws[i].p(letters[i]);
+        }
+
+        benchmark::DoNotOptimize(p);
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+WSTR_BENCH_CONTAINERS(BM_Lookup);
+
+template <class WString, const char* alph>
+static void BM_Heaviest(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, state.range(0));
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ws.heaviest());
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+WSTR_BENCH_CONTAINERS(BM_Heaviest);
+
+//! heaviest_ungap with the last letter of the alphabet as gap
+template <class WString, const char* alph>
+static void BM_HeaviestUngap(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, state.range(0));
+    ws.set_gap(std::string(alph).back());
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ws.heaviest_ungap());
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+WSTR_BENCH_CONTAINERS(BM_HeaviestUngap);
+
+template <class WString, const char* alph>
+static void BM_IsGood(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, state.range(0));
+
+    for (auto _ : state) {
+        size_t good = 0;
+
+        for (const auto& wc : ws) {
+            good += wc.is_good(1e-9);
+        }
+
+        benchmark::DoNotOptimize(good);
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+WSTR_BENCH_CONTAINERS(BM_IsGood);
+
+//! Probability of letters of the extended DNA alphabet, the argument is the length of the weighted string
+template <class WString>
+static void BM_DnaExtendedAt(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(dna_alph, state.range(0));
+    std::string letters = random_letters("RYMKSWHBVDN", ws.size());
+
+    for (auto _ : state) {
+        double p = 0.;
+
+        for (size_t i = 0; i < ws.size(); ++i) {
+            p += ws[i].p(letters[i]);
+        }
+
+        benchmark::DoNotOptimize(p);
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_DnaExtendedAt, w_string_dna)->Apply(bench_lengths);
+
+//! Same with letters of the DNA alphabet, for comparison
+template <class WString>
+static void BM_DnaAt(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(dna_alph, state.range(0));
+    std::string letters = random_letters(dna_alph, ws.size());
+
+    for (auto _ : state) {
+        double p = 0.;
+
+        for (size_t i = 0; i < ws.size(); ++i) {
+            p += ws[i].p(letters[i]);
+        }
+
+        benchmark::DoNotOptimize(p);
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_DnaAt, w_string_dna)->Apply(bench_lengths);
+
+//! Probability of one letter of the extended DNA alphabet at all positions with dna_p_range
+template <class WString>
+static void BM_DnaExtendedRange(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(dna_alph, state.range(0));
+    std::vector<double> p(ws.size());
+
+    for (auto _ : state) {
+        dna_p_range(ws.data(), ws.size(), 'R', p.data());
+        benchmark::DoNotOptimize(p.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_DnaExtendedRange, w_string_dna)->Apply(bench_lengths);
+
+//! Quantized storages against doubles, on a DNA alphabet with gap
+inline constexpr char alph5[] = "ACGT-";
+
+#define WSTR_BENCH_QUANTIZED(BM)                                                        \
+    BENCHMARK_TEMPLATE(BM, w_string_array<alph5>, alph5)->Apply(bench_lengths);          \
+    BENCHMARK_TEMPLATE(BM, w_string_float_array<alph5>, alph5)->Apply(bench_lengths);    \
+    BENCHMARK_TEMPLATE(BM, w_string_u16_array<alph5>, alph5)->Apply(bench_lengths);      \
+    BENCHMARK_TEMPLATE(BM, w_string_u8_array<alph5>, alph5)->Apply(bench_lengths)
+
+WSTR_BENCH_QUANTIZED(BM_Lookup);
+WSTR_BENCH_QUANTIZED(BM_Heaviest);
+WSTR_BENCH_QUANTIZED(BM_IsGood);
+
+//! Sparse profiles: 2 non-zero probabilities per position over 62 letters
+#define WSTR_BENCH_SPARSE(BM)                                                           \
+    BENCHMARK_TEMPLATE(BM, w_string_map, alph62)->Apply(bench_lengths);                  \
+    BENCHMARK_TEMPLATE(BM, w_string_sparse, alph62)->Apply(bench_lengths);               \
+    BENCHMARK_TEMPLATE(BM, w_string_array<alph62>, alph62)->Apply(bench_lengths)
+
+template <class WString, const char* alph>
+static void BM_SparseBuild(benchmark::State& state)
+{
+    for (auto _ : state) {
+        WString ws = random_sparse_ws<WString>(alph, state.range(0), 2);
+        benchmark::DoNotOptimize(ws.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <class WString, const char* alph>
+static void BM_SparseLookup(benchmark::State& state)
+{
+    WString ws = random_sparse_ws<WString>(alph, state.range(0), 2);
+    std::string letters = random_letters(alph, ws.size());
+
+    for (auto _ : state) {
+        double p = 0.;
+
+        for (size_t i = 0; i < ws.size(); ++i) {
+            p += ws[i].p(letters[i]);
+        }
+
+        benchmark::DoNotOptimize(p);
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+template <class WString, const char* alph>
+static void BM_SparseHeaviest(benchmark::State& state)
+{
+    WString ws = random_sparse_ws<WString>(alph, state.range(0), 2);
+
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ws.heaviest());
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+WSTR_BENCH_SPARSE(BM_SparseBuild);
+WSTR_BENCH_SPARSE(BM_SparseLookup);
+WSTR_BENCH_SPARSE(BM_SparseHeaviest);
+
+//! Heaviest strings written into a preallocated output, with the scalar and the dispatched (AVX2) kernels
+template <class WString, const char* alph, bool with_gap, bool scalar>
+static void BM_HeaviestKernel(benchmark::State& state)
+{
+    constexpr size_t N = std::char_traits<char>::length(alph);
+
+    WString ws = random_ws<WString>(alph, state.range(0));
+    std::string letters(alph);
+    std::string h(ws.size(), ' ');
+    size_t gap = with_gap ? N : N - 1;
+
+    for (auto _ : state) {
+        const double* p = ws.data()->probabilities().data();
+
+        if (scalar) {
+            benchmark::DoNotOptimize(heaviest_letters_scalar<N>(p, ws.size(), letters.data(), gap, &h[0]));
+        }
+        else {
+            benchmark::DoNotOptimize(heaviest_letters<N>(p, ws.size(), letters.data(), gap, &h[0]));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_HeaviestKernel, w_string_array<alph4>, alph4, true, true)->Apply(bench_lengths);
+BENCHMARK_TEMPLATE(BM_HeaviestKernel, w_string_array<alph4>, alph4, true, false)->Apply(bench_lengths);
+BENCHMARK_TEMPLATE(BM_HeaviestKernel, w_string_array<alph5>, alph5, false, true)->Apply(bench_lengths);
+BENCHMARK_TEMPLATE(BM_HeaviestKernel, w_string_array<alph5>, alph5, false, false)->Apply(bench_lengths);
\ No newline at end of file
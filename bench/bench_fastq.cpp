@@ -0,0 +1,112 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_fastq.hpp>
+#include <wstr/weighted_reader.hpp>
+#include <wstr/weighted_writer.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+typedef dna_container<dna_alph> dna;
+
+//! Text of n FASTQ records of 150 random bases
+static std::string random_fastq(size_t n, unsigned seed = 42)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> base(0, 3), quality('#', 'J');
+
+    std::string text;
+
+    for (size_t k = 0; k < n; ++k) {
+        text += "@read" + std::to_string(k) + "\n";
+
+        for (size_t i = 0; i < 150; ++i) {
+            text += "ACGT"[base(gen)];
+        }
+
+        text += "\n+\n";
+
+        for (size_t i = 0; i < 150; ++i) {
+            text += static_cast<char>(quality(gen));
+        }
+
+        text += "\n";
+    }
+
+    return text;
+}
+
+//! Read 2^14 reads of 150 bases with fastq_reader into weighted strings, the argument is the number of threads
+static void BM_ReadFastq(benchmark::State& state)
+{
+    std::string text = random_fastq(1 << 14);
+
+    for (auto _ : state) {
+        std::istringstream in(text);
+        fastq_reader<dna> reader(in);
+        std::vector<w_string_dna> reads;
+
+        while (reader.read(reads, 1 << 12, nullptr, state.range(0))) {
+
+        }
+
+        benchmark::DoNotOptimize(reads.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ReadFastq)->Arg(1)->Arg(2)->UseRealTime();
+
+//! Same into a flat collection
+static void BM_ReadFastqFlat(benchmark::State& state)
+{
+    std::string text = random_fastq(1 << 14);
+
+    for (auto _ : state) {
+        std::istringstream in(text);
+        fastq_reader<dna> reader(in);
+        flat_ws_collection<dna> reads;
+
+        while (reader.read(reads, 1 << 12)) {
+
+        }
+
+        benchmark::DoNotOptimize(reads.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ReadFastqFlat);
+
+//! Same by converting the reads to the weighted string format and parsing it, the text is not timed
+static void BM_ReadFastqConverted(benchmark::State& state)
+{
+    std::string text = random_fastq(1 << 14);
+
+    std::vector<w_string_dna> reads;
+    std::istringstream in(text);
+    fastq_reader<dna>(in).read(reads);
+
+    std::ostringstream out;
+    ws_writer(out).write(reads);
+    std::string converted = out.str();
+
+    for (auto _ : state) {
+        std::vector<w_string_dna> parsed;
+        parse_ws(converted.data(), converted.data() + converted.size(), parsed, ws_options{false, false});
+        benchmark::DoNotOptimize(parsed.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ReadFastqConverted);
\ No newline at end of file
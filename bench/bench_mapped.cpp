@@ -0,0 +1,61 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_reader.hpp>
+#include <wstr/weighted_mapped.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+//! Startup cost of a text file: read and parse all positions
+static void BM_StartupText(benchmark::State& state)
+{
+    w_string_dna ws = random_ws<w_string_dna>(dna_alph, state.range(0));
+    std::string path = "wstr_bench_" + std::to_string(state.range(0)) + ".tmp";
+
+    {
+        std::ofstream out(path);
+        out.precision(17);
+        out << ws.size() << "\n" << dna_alph << "\n";
+
+        for (const auto& wc : ws) {
+            out << wc.p('A') << " " << wc.p('C') << " " << wc.p('G') << " " << wc.p('T') << "\n";
+        }
+    }
+
+    ws_options options;
+    options.precision = 1e-9;
+
+    for (auto _ : state) {
+        w_string_dna loaded;
+        load_ws(path, loaded, options);
+        benchmark::DoNotOptimize(loaded.data());
+    }
+
+    std::remove(path.c_str());
+}
+
+//! Startup cost of a binary file: map it and read one position
+static void BM_StartupMapped(benchmark::State& state)
+{
+    w_string_dna ws = random_ws<w_string_dna>(dna_alph, state.range(0));
+    std::string path = "wstr_bench_" + std::to_string(state.range(0)) + ".tmp";
+
+    save_ws_binary(path, ws);
+
+    for (auto _ : state) {
+        mapped_ws_collection<dna_container<dna_alph>> wsc(path);
+        benchmark::DoNotOptimize(wsc[0][0].p('A'));
+    }
+
+    std::remove(path.c_str());
+}
+
+BENCHMARK(BM_StartupText)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_StartupMapped)->Arg(1 << 12)->Arg(1 << 16)->Arg(1 << 20)->Unit(benchmark::kMicrosecond);
\ No newline at end of file
@@ -0,0 +1,93 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <string>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_pwm.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+//! Scan 2^20 random bases with a random motif of 16 positions through p(), as without a scanner
+static void BM_ScanNaive(benchmark::State& state)
+{
+    w_string_dna motif = random_ws<w_string_dna>(alph4, 16);
+    std::string genome = random_letters(alph4, 1 << 20);
+
+    pwm_scanner scanner(motif);
+    double threshold = .8 * scanner.max_score();
+
+    for (auto _ : state) {
+        size_t hits = 0;
+
+        for (size_t i = 0; i + motif.size() <= genome.size(); ++i) {
+            double score = 0.;
+
+            for (size_t j = 0; j < motif.size(); ++j) {
+                score += std::log2(motif[j].p(genome[i + j]) / .25);
+            }
+
+            hits += score >= threshold;
+        }
+
+        benchmark::DoNotOptimize(hits);
+    }
+
+    state.SetItemsProcessed(state.iterations() * genome.size());
+}
+
+BENCHMARK(BM_ScanNaive);
+
+//! Same with a pwm_scanner on ASCII bases, the argument is 1 to use AVX2 instructions
+static void BM_Scan(benchmark::State& state)
+{
+    w_string_dna motif = random_ws<w_string_dna>(alph4, 16);
+    std::string genome = random_letters(alph4, 1 << 20);
+
+    pwm_scanner scanner(motif);
+    scanner.set_simd(1 == state.range(0));
+    double threshold = .8 * scanner.max_score();
+
+    for (auto _ : state) {
+        size_t hits = 0;
+
+        scanner.scan(genome.data(), genome.size(), threshold, [&hits](size_t, float) {
+            ++hits;
+        });
+
+        benchmark::DoNotOptimize(hits);
+    }
+
+    state.SetItemsProcessed(state.iterations() * genome.size());
+}
+
+BENCHMARK(BM_Scan)->Arg(0)->Arg(1);
+
+//! Same on bases packed on 2 bits
+static void BM_Scan2bit(benchmark::State& state)
+{
+    w_string_dna motif = random_ws<w_string_dna>(alph4, 16);
+    std::string genome = random_letters(alph4, 1 << 20);
+    std::vector<std::uint8_t> packed = pack_dna(genome);
+
+    pwm_scanner scanner(motif);
+    scanner.set_simd(1 == state.range(0));
+    double threshold = .8 * scanner.max_score();
+
+    for (auto _ : state) {
+        size_t hits = 0;
+
+        scanner.scan_2bit(packed.data(), 0, genome.size(), threshold, [&hits](size_t, float) {
+            ++hits;
+        });
+
+        benchmark::DoNotOptimize(hits);
+    }
+
+    state.SetItemsProcessed(state.iterations() * genome.size());
+}
+
+BENCHMARK(BM_Scan2bit)->Arg(0)->Arg(1);
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include <benchmark/benchmark.h>
+
+#include <sstream>
+#include <string>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_reader.hpp>
+#include <wstr/weighted_flat.hpp>
+#include <wstr/weighted_stream.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+//! Read with the >> operator, the argument is the number of positions
+template <class WString, const char* alph>
+static void BM_ReadStream(benchmark::State& state)
+{
+    std::string text = random_ws_text(alph, state.range(0));
+
+    for (auto _ : state) {
+        std::istringstream in(text);
+        WString ws;
+
+        in >> ws_set_precision(1e-6) >> ws;
+        benchmark::DoNotOptimize(ws.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+//! Read with the buffer reader, the argument is the number of positions
+template <class WString, const char* alph>
+static void BM_ReadBuffer(benchmark::State& state)
+{
+    std::string text = random_ws_text(alph, state.range(0));
+    ws_options options;
+    options.precision = 1e-6;
+
+    for (auto _ : state) {
+        WString ws;
+
+        parse_ws(text.data(), text.data() + text.size(), ws, options);
+        benchmark::DoNotOptimize(ws.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK_TEMPLATE(BM_ReadStream, w_string_array<alph4>, alph4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ReadBuffer, w_string_array<alph4>, alph4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ReadStream, w_string_dna, alph4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ReadBuffer, w_string_dna, alph4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ReadStream, w_string_map, alph4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ReadBuffer, w_string_map, alph4)->Arg(1 << 16);
+BENCHMARK_TEMPLATE(BM_ReadStream, w_string_array<alph20>, alph20)->Arg(1 << 14);
+BENCHMARK_TEMPLATE(BM_ReadBuffer, w_string_array<alph20>, alph20)->Arg(1 << 14);
+BENCHMARK_TEMPLATE(BM_ReadStream, w_string_map, alph20)->Arg(1 << 14);
+BENCHMARK_TEMPLATE(BM_ReadBuffer, w_string_map, alph20)->Arg(1 << 14);
+
+//! Read a collection with the >> operator, arguments are the number of strings and their length
+template <class WString, const char* alph>
+static void BM_ReadCollectionStream(benchmark::State& state)
+{
+    std::string text = random_wsc_text(alph, state.range(0), state.range(1));
+
+    for (auto _ : state) {
+        std::istringstream in(text);
+        std::vector<WString> wsc;
+
+        in >> ws_set_precision(1e-6) >> wsc;
+        benchmark::DoNotOptimize(wsc.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK_TEMPLATE(BM_ReadCollectionStream, w_string_dna, alph4)->Args({4096, 64});
+BENCHMARK_TEMPLATE(BM_ReadCollectionStream, w_string_map, alph4)->Args({4096, 64});
+
+//! Read a collection of 4096 weighted strings with the buffer reader, the argument is the number of threads (0 for sequential)
+static void BM_ReadCollection(benchmark::State& state)
+{
+    std::string text = random_wsc_text(alph4, 4096, 64);
+    ws_options options;
+    options.precision = 1e-6;
+
+    for (auto _ : state) {
+        std::vector<w_string_dna> wsc;
+
+        if (0 == state.range(0)) {
+            parse_ws(text.data(), text.data() + text.size(), wsc, options);
+        }
+        else {
+            parse_ws_parallel(text.data(), text.data() + text.size(), wsc, options, state.range(0));
+        }
+
+        benchmark::DoNotOptimize(wsc.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ReadCollection)->Arg(0)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+//! Heaviest string of a weighted string read from a stream, the whole string at once (block size 0) or by blocks
+/*!
+  * The arguments are the block size and 1 to parse the next block in the background.
+ */
+static void BM_ReadBlocks(benchmark::State& state)
+{
+    std::string text = random_ws_text(alph4, 1 << 18);
+    ws_options options;
+    options.precision = 1e-6;
+
+    for (auto _ : state) {
+        std::string h;
+        std::istringstream in(text);
+
+        if (0 == state.range(0)) {
+            std::string buffer(std::istreambuf_iterator<char>(in), {});
+            w_string_dna ws;
+
+            parse_ws(buffer.data(), buffer.data() + buffer.size(), ws, options);
+            h = ws.heaviest();
+        }
+        else {
+            ws_stream_reader<dna_container<dna_alph>> reader(in, state.range(0), options, state.range(1));
+            weighted_string_view<dna_container<dna_alph>> block;
+
+            while (reader.next(block)) {
+                h += block.heaviest();
+            }
+        }
+
+        benchmark::DoNotOptimize(h.data());
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_ReadBlocks)->Args({0, 0})->Args({1 << 12, 0})->Args({1 << 12, 1})->Args({1 << 16, 0})->Args({1 << 16, 1})->UseRealTime();
+
+//! Read a collection of 2^16 short weighted strings into a vector of weighted strings or a flat collection
+template <class WStringCollection>
+static void BM_ReadFlat(benchmark::State& state)
+{
+    std::string text = random_wsc_text(alph4, 1 << 16, 16);
+    ws_options options;
+    options.precision = 1e-6;
+
+    for (auto _ : state) {
+        WStringCollection wsc;
+
+        parse_ws(text.data(), text.data() + text.size(), wsc, options);
+        benchmark::DoNotOptimize(&wsc);
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK_TEMPLATE(BM_ReadFlat, std::vector<w_string_dna>);
+BENCHMARK_TEMPLATE(BM_ReadFlat, flat_ws_collection<dna_container<dna_alph>>);
+
+//! Sum of the probabilities of A at all positions of a collection of 2^16 short weighted strings
+template <class WStringCollection>
+static void BM_ScanFlat(benchmark::State& state)
+{
+    std::string text = random_wsc_text(alph4, 1 << 16, 16);
+    WStringCollection wsc;
+    parse_ws(text.data(), text.data() + text.size(), wsc, ws_options{true, false, 1e-6});
+
+    for (auto _ : state) {
+        double sum = 0.;
+
+        for (const auto& ws : wsc) {
+            for (const auto& wc : ws) {
+                sum += wc.p('A');
+            }
+        }
+
+        benchmark::DoNotOptimize(sum);
+    }
+
+    state.SetItemsProcessed(state.iterations() * (1 << 20));
+}
+
+BENCHMARK_TEMPLATE(BM_ScanFlat, std::vector<w_string_dna>);
+BENCHMARK_TEMPLATE(BM_ScanFlat, flat_ws_collection<dna_container<dna_alph>>);
+
+//! Load a collection of 4096 weighted strings of maps and destroy it, with the default allocator or a monotonic resource
+/*!
+  * The argument is 1 to allocate the whole collection (down to the nodes of the maps) in a monotonic buffer
+  * resource, which is released at once instead of freeing each node.
+ */
+static void BM_LoadDropMap(benchmark::State& state)
+{
+    std::string text = random_wsc_text(alph4, 4096, 64);
+    ws_options options;
+    options.precision = 1e-6;
+
+    for (auto _ : state) {
+        if (0 == state.range(0)) {
+            w_string_map_collection wsc;
+
+            parse_ws(text.data(), text.data() + text.size(), wsc, options);
+            benchmark::DoNotOptimize(wsc.data());
+        }
+        else {
+            std::pmr::monotonic_buffer_resource resource(1 << 20);
+            pmr::w_string_map_collection wsc(&resource);
+
+            parse_ws(text.data(), text.data() + text.size(), wsc, options);
+            benchmark::DoNotOptimize(wsc.data());
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+BENCHMARK(BM_LoadDropMap)->Arg(0)->Arg(1);
\ No newline at end of file
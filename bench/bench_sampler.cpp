@@ -0,0 +1,83 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_sampler.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+//! Draw strings of 2^16 positions with the alias tables of a sampler
+template <class WString, const char* alph>
+static void BM_Sample(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, 1 << 16);
+    ws_sampler sampler(ws);
+
+    splitmix64 rng(42);
+    std::string s(ws.size(), '\0');
+
+    for (auto _ : state) {
+        sampler.sample(&s[0], rng);
+        benchmark::DoNotOptimize(s.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_Sample, w_string_dna, alph4);
+BENCHMARK_TEMPLATE(BM_Sample, w_string_map, alph4);
+BENCHMARK_TEMPLATE(BM_Sample, w_string_array<alph20>, alph20);
+
+//! Same with a std::discrete_distribution per position, built for each position of each string
+template <class WString, const char* alph>
+static void BM_SampleDiscrete(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, 1 << 16);
+    std::string letters(alph);
+
+    std::mt19937_64 rng(42);
+    std::string s(ws.size(), '\0');
+    std::vector<double> p(letters.size());
+
+    for (auto _ : state) {
+        for (size_t i = 0; i < ws.size(); ++i) {
+            for (size_t k = 0; k < letters.size(); ++k) {
+                p[k] = ws[i].p(letters[k]);
+            }
+
+            std::discrete_distribution<size_t> distribution(p.begin(), p.end());
+            s[i] = letters[distribution(rng)];
+        }
+
+        benchmark::DoNotOptimize(s.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_SampleDiscrete, w_string_dna, alph4);
+
+//! Draw a batch of 256 strings of 4096 positions, the argument is the number of threads
+static void BM_SampleBatch(benchmark::State& state)
+{
+    w_string_dna ws = random_ws<w_string_dna>(alph4, 4096);
+    ws_sampler sampler(ws);
+
+    const size_t count = 256;
+    std::vector<char> out(count * ws.size());
+    std::uint64_t seed = 0;
+
+    for (auto _ : state) {
+        sampler.sample_batch(out.data(), nullptr, count, seed++, 0, state.range(0));
+        benchmark::DoNotOptimize(out.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * count * ws.size());
+}
+
+BENCHMARK(BM_SampleBatch)->Arg(1)->Arg(4)->UseRealTime();
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include <benchmark/benchmark.h>
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+
+#include <wstr/weighted_top.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+//! The k most probable strings of 16 positions over "ab-" (as in wsv2.txt), with ws_top_strings
+static void BM_TopK(benchmark::State& state)
+{
+    w_string_map ws = random_sparse_ws<w_string_map>("ab-", 16, 2);
+    size_t k = state.range(0);
+
+    for (auto _ : state) {
+        auto strings = top_k_strings(ws, k);
+        benchmark::DoNotOptimize(strings.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * k);
+}
+
+BENCHMARK(BM_TopK)->Arg(10)->Arg(100)->Arg(1000);
+
+//! Same by expanding all the strings and sorting the k most probable ones
+static void BM_TopKBruteForce(benchmark::State& state)
+{
+    w_string_map ws = random_sparse_ws<w_string_map>("ab-", 16, 2);
+    size_t k = state.range(0);
+
+    for (auto _ : state) {
+        std::vector<std::pair<std::string, double>> strings = {{"", 0.}}, longer;
+
+        for (const auto& wc : ws) {
+            longer.clear();
+
+            for (const auto& s : strings) {
+                wc.probabilities().for_each([&](char c, double p) {
+                    longer.emplace_back(s.first + c, s.second + std::log(p));
+                });
+            }
+
+            std::swap(strings, longer);
+        }
+
+        std::partial_sort(strings.begin(), strings.begin() + std::min(k, strings.size()), strings.end(),
+                          [](const auto& a, const auto& b) { return a.second > b.second; });
+        strings.resize(std::min(k, strings.size()));
+        benchmark::DoNotOptimize(strings.data());
+    }
+
+    state.SetItemsProcessed(state.iterations() * k);
+}
+
+BENCHMARK(BM_TopKBruteForce)->Arg(10)->Arg(100)->Arg(1000);
+
+//! The k most probable strings of 2^12 positions over ACGT, too long to be expanded
+static void BM_TopKLong(benchmark::State& state)
+{
+    w_string_map ws = random_sparse_ws<w_string_map>(alph4, 1 << 12, 2);
+    size_t k = state.range(0);
+
+    for (auto _ : state) {
+        ws_top_strings top(ws);
+        std::string s;
+        double log_p;
+
+        for (size_t _ = 0; _ < k && top.next(s, log_p); ++_) {
+            benchmark::DoNotOptimize(s.data());
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * k);
+}
+
+BENCHMARK(BM_TopKLong)->Arg(10)->Arg(1000);
\ No newline at end of file
@@ -0,0 +1,90 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <string>
+
+#include <wstr/dna_weighted_string.hpp>
+
+using namespace wstr;
+
+//! Previous w_char_array, with the linear scan translator
+template <const char* alph>
+using basic_char_array = wc_array<strlen(alph), basic_ws_translator<alph>>;
+
+//! Random letters where `miss` is the proportion of letters which are not in the alphabet
+static std::string random_letters(const char* alph, double miss, size_t n = 4096)
+{
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<size_t> letter(0, strlen(alph) - 1);
+    std::bernoulli_distribution out(miss);
+
+    std::string s(n, ' ');
+
+    for (char& c : s) {
+        c = out(gen) ? 'x' : alph[letter(gen)];
+    }
+
+    return s;
+}
+
+template <class Translator>
+static void BM_GetIndice(benchmark::State& state)
+{
+    std::string letters = random_letters(dna_alph_gap, 0.);
+
+    for (auto _ : state) {
+        for (char c : letters) {
+            benchmark::DoNotOptimize(Translator::get_indice(c));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * letters.size());
+}
+
+BENCHMARK_TEMPLATE(BM_GetIndice, basic_ws_translator<dna_alph_gap>);
+BENCHMARK_TEMPLATE(BM_GetIndice, static_ws_translator<dna_alph_gap>);
+
+//! Lookup through w_array::at, the argument is the percentage of letters outside the alphabet
+template <class Container>
+static void BM_ArrayAt(benchmark::State& state)
+{
+    std::string letters = random_letters(dna_alph_gap, state.range(0) / 100.);
+
+    Container wc;
+    for (const char* c = dna_alph_gap; *c; ++c) {
+        wc[*c] = .2;
+    }
+
+    for (auto _ : state) {
+        for (char c : letters) {
+            benchmark::DoNotOptimize(wc.at(c));
+        }
+    }
+
+    state.SetItemsProcessed(state.iterations() * letters.size());
+}
+
+BENCHMARK_TEMPLATE(BM_ArrayAt, basic_char_array<dna_alph_gap>)->Arg(0)->Arg(10)->Arg(50);
+BENCHMARK_TEMPLATE(BM_ArrayAt, w_char_array<dna_alph_gap>)->Arg(0)->Arg(10)->Arg(50);
+
+//! Lookup of a whole weighted string
+template <class WString>
+static void BM_StringProba(benchmark::State& state)
+{
+    std::string letters = random_letters(dna_alph, 0.);
+
+    WString ws(letters.size(), typename WString::w_char({.1, .2, .3, .4}));
+
+    for (auto _ : state) {
+        double p = 0.;
+        for (size_t i = 0; i < letters.size(); ++i) {
+            p += ws[i].p(letters[i]);
+        }
+        benchmark::DoNotOptimize(p);
+    }
+
+    state.SetItemsProcessed(state.iterations() * letters.size());
+}
+
+BENCHMARK_TEMPLATE(BM_StringProba, weighted_string<basic_char_array<dna_alph>>);
+BENCHMARK_TEMPLATE(BM_StringProba, w_string_array<dna_alph>);
\ No newline at end of file
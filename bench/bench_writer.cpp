@@ -0,0 +1,142 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdio>
+#include <limits>
+#include <sstream>
+#include <string>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_reader.hpp>
+#include <wstr/weighted_writer.hpp>
+
+#include "synthetic.hpp"
+
+using namespace wstr;
+using namespace wstr_bench;
+
+//! Stream buffer which drops everything, to measure the formatting alone
+class null_buffer : public std::streambuf
+{
+    protected:
+
+        std::streamsize xsputn(const char*, std::streamsize n) override
+        {
+            return n;
+        }
+
+        int overflow(int c) override
+        {
+            return c;
+        }
+};
+
+//! Write 2^16 positions with ws_writer into a stream which drops them, the argument is the precision (-1 for shortest)
+template <class WString, const char* alph>
+static void BM_WriteText(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, 1 << 16);
+
+    null_buffer buffer;
+    std::ostream out(&buffer);
+
+    std::ostringstream text;
+    ws_writer(text, state.range(0)).write(ws);
+
+    for (auto _ : state) {
+        ws_writer writer(out, state.range(0));
+        writer.write(ws);
+        writer.flush();
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.str().size());
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_WriteText, w_string_dna, alph4)->Arg(-1)->Arg(6);
+BENCHMARK_TEMPLATE(BM_WriteText, w_string_map, alph4)->Arg(-1)->Arg(6);
+BENCHMARK_TEMPLATE(BM_WriteText, w_string_array<alph20>, alph20)->Arg(-1)->Arg(6);
+
+//! Write 2^16 positions read from a text with 9 significant digits, as when a file is rewritten
+template <class WString, const char* alph>
+static void BM_WriteParsed(benchmark::State& state)
+{
+    std::string input = random_ws_text(alph, 1 << 16);
+    WString ws;
+    parse_ws(input.data(), input.data() + input.size(), ws, ws_options{false, false});
+
+    null_buffer buffer;
+    std::ostream out(&buffer);
+
+    std::ostringstream text;
+    ws_writer(text, state.range(0)).write(ws);
+
+    for (auto _ : state) {
+        ws_writer writer(out, state.range(0));
+        writer.write(ws);
+        writer.flush();
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.str().size());
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_WriteParsed, w_string_dna, alph4)->Arg(-1)->Arg(6);
+BENCHMARK_TEMPLATE(BM_WriteParsed, w_string_array<alph20>, alph20)->Arg(-1)->Arg(6);
+
+//! Same with a loop of << on each probability (with 17 digits, to read back the same doubles)
+template <class WString, const char* alph>
+static void BM_WriteStream(benchmark::State& state)
+{
+    WString ws = random_ws<WString>(alph, 1 << 16);
+    std::string letters(alph);
+
+    null_buffer buffer;
+    std::ostream out(&buffer);
+    out.precision(std::numeric_limits<double>::max_digits10);
+
+    std::ostringstream text;
+    ws_writer(text).write(ws);
+
+    for (auto _ : state) {
+        out << ws.size() << '\n' << letters << '\n';
+
+        for (const auto& wc : ws) {
+            for (size_t k = 0; k < letters.size(); ++k) {
+                out << wc.p(letters[k]) << (k + 1 == letters.size() ? '\n' : ' ');
+            }
+        }
+    }
+
+    state.SetBytesProcessed(state.iterations() * text.str().size());
+    state.SetItemsProcessed(state.iterations() * ws.size());
+}
+
+BENCHMARK_TEMPLATE(BM_WriteStream, w_string_dna, alph4);
+BENCHMARK_TEMPLATE(BM_WriteStream, w_string_array<alph20>, alph20);
+
+//! Save 2^16 positions to a file, with save_ws (argument 0) or by writing the same text already formatted (argument 1)
+static void BM_SaveFile(benchmark::State& state)
+{
+    w_string_dna ws = random_ws<w_string_dna>(alph4, 1 << 16);
+    std::string path = "wstr_bench_save.tmp";
+
+    std::ostringstream text;
+    ws_writer(text).write(ws);
+    std::string formatted = text.str();
+
+    for (auto _ : state) {
+        if (0 == state.range(0)) {
+            save_ws(path, ws);
+        }
+        else {
+            std::ofstream out(path, std::ios::binary);
+            out.write(formatted.data(), formatted.size());
+        }
+    }
+
+    std::remove(path.c_str());
+
+    state.SetBytesProcessed(state.iterations() * formatted.size());
+}
+
+BENCHMARK(BM_SaveFile)->Arg(0)->Arg(1)->UseRealTime();
\ No newline at end of file
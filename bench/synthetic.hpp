@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+#include <wstr/weighted_string.hpp>
+
+//! Generators of synthetic inputs shared by all benchmarks
+namespace wstr_bench
+{
+
+//! Alphabets of several sizes, to be used as template arguments of array containers
+inline constexpr char alph4[] = "ACGT";
+inline constexpr char alph20[] = "ACDEFGHIKLMNPQRSTVWY";
+inline constexpr char alph62[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz";
+
+//! Add the lengths of weighted strings to a benchmark
+/*!
+  * Lengths are read from the WSTR_BENCH_LENGTHS environment variable (comma separated, such as "1000,1000000"),
+  * the default lengths are 2^10 and 2^16.
+ */
+inline void bench_lengths(benchmark::internal::Benchmark* bm)
+{
+    const char* env = std::getenv("WSTR_BENCH_LENGTHS");
+
+    if (nullptr == env || '\0' == *env) {
+        bm->Arg(1 << 10)->Arg(1 << 16);
+        return;
+    }
+
+    std::istringstream lengths(env);
+    std::string length;
+
+    while (std::getline(lengths, length, ',')) {
+        bm->Arg(std::stoll(length));
+    }
+}
+
+//! Random probabilities of one position, their sum is 1
+inline std::vector<double> random_probabilities(size_t sigma, std::mt19937& gen)
+{
+    std::uniform_real_distribution<double> proba(0., 1.);
+    std::vector<double> p(sigma);
+    double sum = 0.;
+
+    for (double& v : p) {
+        v = proba(gen);
+        sum += v;
+    }
+
+    for (double& v : p) {
+        v /= sum;
+    }
+
+    return p;
+}
+
+//! Random weighted string of n positions over an alphabet
+/*!
+  * \tparam WString     A weighted_string, the alphabet should fit its Container
+ */
+template <class WString>
+WString random_ws(const std::string& alph, size_t n, unsigned seed = 42)
+{
+    typedef std::decay_t<decltype(std::declval<typename WString::w_char>().probabilities())> Container;
+
+    std::mt19937 gen(seed);
+    WString ws;
+    ws.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        std::vector<double> p = random_probabilities(alph.size(), gen);
+        Container wc;
+
+        for (size_t k = 0; k < alph.size(); ++k) {
+            wc[alph[k]] = p[k];
+        }
+
+        ws.emplace_back(std::move(wc), false);
+    }
+
+    return ws;
+}
+
+//! Random weighted string of n positions where each position has k non-zero probabilities
+/*!
+  * \tparam WString     A weighted_string, the alphabet should fit its Container
+ */
+template <class WString>
+WString random_sparse_ws(const std::string& alph, size_t n, size_t k, unsigned seed = 42)
+{
+    typedef std::decay_t<decltype(std::declval<typename WString::w_char>().probabilities())> Container;
+
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> letter(0, alph.size() - 1);
+    WString ws;
+    ws.reserve(n);
+
+    for (size_t i = 0; i < n; ++i) {
+        std::vector<double> p = random_probabilities(k, gen);
+        Container wc;
+
+        for (size_t j = 0; j < k; ++j) {
+            wc[alph[letter(gen)]] += p[j];
+        }
+
+        ws.emplace_back(std::move(wc), false);
+    }
+
+    return ws;
+}
+
+//! Random string of n letters of an alphabet
+inline std::string random_letters(const std::string& alph, size_t n, unsigned seed = 42)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<size_t> letter(0, alph.size() - 1);
+
+    std::string s(n, ' ');
+
+    for (char& c : s) {
+        c = alph[letter(gen)];
+    }
+
+    return s;
+}
+
+//! Write n random positions in the file format (one per line)
+inline void random_positions(std::ostream& out, size_t sigma, size_t n, std::mt19937& gen)
+{
+    for (size_t i = 0; i < n; ++i) {
+        std::vector<double> p = random_probabilities(sigma, gen);
+
+        for (size_t k = 0; k < sigma; ++k) {
+            out << p[k] << (k + 1 == sigma ? '\n' : '\t');
+        }
+    }
+}
+
+//! Text of a random weighted string of n positions, in the file format
+inline std::string random_ws_text(const std::string& alph, size_t n, unsigned seed = 42)
+{
+    std::mt19937 gen(seed);
+
+    std::ostringstream out;
+    out.precision(9);
+    out << n << "\n" << alph << "\n";
+    random_positions(out, alph.size(), n, gen);
+
+    return out.str();
+}
+
+//! Text of a collection of l random weighted strings of n positions, in the file format
+inline std::string random_wsc_text(const std::string& alph, size_t l, size_t n, unsigned seed = 42)
+{
+    std::mt19937 gen(seed);
+
+    std::ostringstream out;
+    out.precision(9);
+    out << l << "\n" << alph << "\n";
+
+    for (size_t i = 0; i < l; ++i) {
+        out << n << "\n";
+        random_positions(out, alph.size(), n, gen);
+    }
+
+    return out.str();
+}
+
+}
\ No newline at end of file
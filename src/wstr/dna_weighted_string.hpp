@@ -1,5 +1,8 @@
 #pragma once
 
+#include <iterator>
+#include <unordered_map>
+
 #include "weighted_string.hpp"
 
 namespace wstr
@@ -14,8 +17,8 @@ inline constexpr char dna_alph_gap[] = "ACGT-";
 // Gap of the alphabet
 inline constexpr char dna_gap = '-';
 
-//! Extended DNA alphabet, a letter can represent other letters from the DNA alphabet
-static const std::unordered_map<char, std::string> dna_ext_alph = {
+//! IUPAC codes of the extended DNA alphabet with the letters they represent
+inline constexpr std::pair<char, const char*> dna_iupac_codes[] = {
     {'R', "GA"},
     {'Y', "TC"},
     {'M', "AC"},
@@ -29,6 +32,9 @@ static const std::unordered_map<char, std::string> dna_ext_alph = {
     {'N', "GATC"}
 };
 
+//! Extended DNA alphabet, a letter can represent other letters from the DNA alphabet (built from dna_iupac_codes)
+static const std::unordered_map<char, std::string> dna_ext_alph(std::begin(dna_iupac_codes), std::end(dna_iupac_codes));
+
 //! Specific container for DNA
 /*!
   * \tparam alph    Which alphabet we use (with or without gap)
@@ -36,28 +42,146 @@ static const std::unordered_map<char, std::string> dna_ext_alph = {
   * What is specific about the dna container is that when we ask the probability
   * of a character from the extended alphabet, the result is the sum of probabilities
   * of all letters which are represented by this letter.
+  *
+  * Each letter is translated at compile time into a mask over the indices of the alphabet
+  * (one bit for a letter of the alphabet, several bits for an IUPAC code, no bit for other letters),
+  * so `at` is a branch-free masked sum for all letters. The probabilities of an IUPAC code are added in the order
+  * of the alphabet, not in the order of dna_iupac_codes, so the last bit can differ for codes of 3 or 4 letters.
+  *
+  * \sa wstr::dna_p_range
  */
 template <const char* alph>
 class dna_container : public w_char_array<alph>
 {
     public:
 
+        typedef static_ws_translator<alph> translator;
+
+        static_assert(translator::size <= 8, "The alphabet of a dna_container must have at most 8 letters");
+
         using w_char_array<alph>::w_char_array;
 
+        //! Return the mask of the letters of the alphabet represented by a letter
+        static constexpr unsigned char mask(char c)
+        {
+            return _masks[static_cast<unsigned char>(c)];
+        }
+
+        //! Return true if the letter belongs to the extended alphabet (and so represents several letters)
+        static constexpr bool is_extended(char c)
+        {
+            return _extended[static_cast<unsigned char>(c)];
+        }
+
         double at(const char& key) const
         {
-            if (dna_ext_alph.find(key) != dna_ext_alph.end()) {
-                double p = 0.;
-                for (const char c : dna_ext_alph.at(key)) {
-                    p += w_char_array<alph>::at(c);
+            return masked_sum(mask(key));
+        }
+
+        //! Sum of probabilities of the letters of a mask
+        double masked_sum(unsigned char m) const
+        {
+            double p = 0.;
+
+            for (size_t i = 0; i < translator::size; ++i) {
+                p += ((m >> i) & 1) ? (*this).data()[i] : 0.;
+            }
+
+            return p;
+        }
+
+    private:
+
+        static constexpr std::array<unsigned char, 256> _build_masks()
+        {
+            std::array<unsigned char, 256> masks{};
+
+            for (size_t c = 0; c < masks.size(); ++c) {
+                size_t i = translator::find_indice(static_cast<char>(c));
+                masks[c] = (translator::npos == i) ? 0 : static_cast<unsigned char>(1 << i);
+            }
+
+            for (const auto& code : dna_iupac_codes) {
+                unsigned char m = 0;
+
+                for (const char* l = code.second; *l; ++l) {
+                    size_t i = translator::find_indice(*l);
+                    m |= (translator::npos == i) ? 0 : static_cast<unsigned char>(1 << i);
                 }
-                return p;
+
+                masks[static_cast<unsigned char>(code.first)] = m;
+            }
+
+            return masks;
+        }
+
+        static constexpr std::array<bool, 256> _build_extended()
+        {
+            std::array<bool, 256> extended{};
+
+            for (const auto& code : dna_iupac_codes) {
+                extended[static_cast<unsigned char>(code.first)] = true;
             }
 
-            return w_char_array<alph>::at(key);
+            return extended;
         }
+
+        static constexpr std::array<unsigned char, 256> _masks = _build_masks();
+        static constexpr std::array<bool, 256> _extended = _build_extended();
 };
 
+//! Probability of a letter (of the alphabet or an IUPAC code) over a range of positions
+/*!
+  * \param first    First weighted char of the range
+  * \param n        Number of positions
+  * \param c        The letter
+  * \param out      Output, out[i] is the probability of c at position i (it should have n values)
+  *
+  * The loop over positions is the masked sum of dna_container::at with a fixed mask, written so that
+  * the compiler vectorizes it. Results are the same as calling `p(c)` on each position.
+ */
+template <const char* alph>
+void dna_p_range(const weighted_char<dna_container<alph>>* first, size_t n, char c, double* out)
+{
+    constexpr size_t N = static_ws_translator<alph>::size;
+    static_assert(sizeof(weighted_char<dna_container<alph>>) == N * sizeof(double), "Positions should be stored as contiguous probabilities");
+
+    unsigned char m = dna_container<alph>::mask(c);
+    const double* probabilities = first->probabilities().data();
+
+    double weights[N];
+
+    for (size_t k = 0; k < N; ++k) {
+        weights[k] = ((m >> k) & 1) ? 1. : 0.;
+    }
+
+    for (size_t i = 0; i < n; ++i) {
+        double p = 0.;
+
+        for (size_t k = 0; k < N; ++k) {
+            p += probabilities[i * N + k] * weights[k];
+        }
+
+        out[i] = p;
+    }
+}
+
+//! Probability of a letter (of the alphabet or an IUPAC code) at each position of a weighted string
+/*!
+  * \sa wstr::dna_p_range
+ */
+template <class WString>
+std::vector<double> dna_p_range(const WString& ws, char c)
+{
+    std::vector<double> out(ws.size());
+
+    if (!ws.empty()) {
+        dna_p_range(ws.data(), ws.size(), c, out.data());
+    }
+
+    return out;
+}
+
 //! Weighted string for the dna alphabet with gaps
 class w_string_dna_gap : public weighted_string<dna_container<dna_alph_gap>>
 {
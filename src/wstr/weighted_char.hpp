@@ -71,6 +71,35 @@ class wc_map : public w_map<char, Hash, KeyEqual, Allocator>
 };
 
 
+//! Container for weighted character storing only non-zero probabilities
+/*!
+  * \sa w_sparse
+ */ 
+template<
+    std::size_t Capacity = 4,
+    class Allocator = std::allocator<std::pair<char, double>>
+>
+class wc_sparse : public w_sparse<char, Capacity, std::less<char>, Allocator>
+{
+    public:
+
+        using w_sparse<char, Capacity, std::less<char>, Allocator>::w_sparse;
+
+        char heaviest_non_gap(char gap) const
+        {
+            if (this->empty()) {
+                throw std::runtime_error("There is no value with probability greater than 0.");
+            }
+
+            return std::max_element(this->begin(), this->end(), [&gap](auto& p1, auto& p2) {
+                if (p1.first == gap) { return true; }
+                if (p2.first == gap) { return false; }
+                return p1.second < p2.second;
+            })->first;
+        }
+};
+
+
 //! Container for weighted character based on array
 /*!
   * \sa w_array
@@ -106,4 +135,75 @@ class wc_array : public w_array<char, N, Translator>
         }
 };
 
+
+
+//! Container for weighted character based on an array of log-probabilities
+/*!
+  * \sa w_log_array
+ */ 
+template<
+    std::size_t N,
+    class Translator
+>
+class wc_log_array : public w_log_array<char, N, Translator>
+{
+    public:
+
+        using w_log_array<char, N, Translator>::w_log_array;
+
+        char heaviest_non_gap(char gap) const
+        {
+            size_t pos = Translator::get_indice(gap);
+            size_t maxp = N;
+
+            for (size_t i = 0; i < N; ++i) {
+                if (i != pos && (N == maxp || std::array<double, N>::at(i) > std::array<double, N>::at(maxp))) {
+                    maxp = i;
+                }
+            }
+
+            if (N == maxp) {
+                throw std::runtime_error("Your alphabet only have one letter, so the heaviest letter without this letter doesn't exist\n");
+            }
+
+            return Translator::get_element(maxp);
+        }
+};
+
+
+//! Container for weighted character based on an array of quantized probabilities
+/*!
+  * \sa w_quantized_array
+ */ 
+template<
+    std::size_t N,
+    class Translator,
+    class Storage,
+    std::uint64_t Scale = default_quantization_scale<Storage>()
+>
+class wc_quantized_array : public w_quantized_array<char, N, Translator, Storage, Scale>
+{
+    public:
+
+        using w_quantized_array<char, N, Translator, Storage, Scale>::w_quantized_array;
+
+        char heaviest_non_gap(char gap) const
+        {
+            size_t pos = Translator::get_indice(gap);
+            size_t maxp = N;
+
+            for (size_t i = 0; i < N; ++i) {
+                if (i != pos && (N == maxp || std::array<Storage, N>::at(i) > std::array<Storage, N>::at(maxp))) {
+                    maxp = i;
+                }
+            }
+
+            if (N == maxp) {
+                throw std::runtime_error("Your alphabet only have one letter, so the heaviest letter without this letter doesn't exist\n");
+            }
+
+            return Translator::get_element(maxp);
+        }
+};
+
 }
\ No newline at end of file
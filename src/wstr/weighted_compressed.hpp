@@ -0,0 +1,564 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+#include <stdexcept>
+
+#include "weighted_ungap.hpp"
+#include "weighted_matching.hpp"
+
+namespace wstr
+{
+
+//! Weighted string which stores the certain positions as letters and only the distributions of the other positions
+/*!
+  * \tparam Container   Container of the weighted chars
+  *
+  * A position is certain if its heaviest letter has a probability greater or equal to 1 - epsilon. In real data
+  * most positions are certain, so the heaviest letter of every position is stored on 2, 4 or 8 bits (depending on
+  * the number of different heaviest letters, 2 bits for DNA), and the weighted chars of the uncertain positions
+  * are stored in a vector. A bitvector with rank tells which positions are uncertain and where their weighted
+  * char is, so access to any position is O(1).
+  *
+  * Certain positions are read back with the probability 1 for their letter and 0 for others. With epsilon = 0,
+  * only positions with a letter of probability 1 are certain, so the compression is lossless when the probabilities
+  * of each position sum to 1.
+  *
+  * The heaviest string is read from the letters without the weighted chars, and compressed_pattern_matcher
+  * finds patterns without decompressing the weighted string. Dead positions, whose probabilities sum to 0, are
+  * uncertain and their letter is the first one of the alphabet: no pattern occurs over them.
+  *
+  * \sa wstr::compressed_pattern_matcher
+  * \sa wstr::rank_select_bitvector
+ */
+template <class Container>
+class compressed_ws
+{
+    public:
+
+        typedef weighted_char<Container> w_char;
+
+    private:
+
+        size_t _size = 0;
+        char _gap = NO_GAP;
+        double _epsilon = 0.;
+
+        // Heaviest letter of each position, as its indice in _alph on 1 << _log_bits bits
+        std::string _alph;
+        unsigned _log_bits = 1;
+        std::vector<std::uint64_t> _letters;
+
+        rank_select_bitvector _uncertain;
+        std::vector<w_char> _chars;
+
+    public:
+
+        compressed_ws()
+        {
+
+        }
+
+        //! Compress a weighted string (or a view)
+        /*!
+          * \param ws       The weighted string
+          * \param epsilon  Positions whose heaviest letter has a probability of at least 1 - epsilon are certain
+          *
+          * \throw std::invalid_argument if epsilon is not in [0, 1)
+         */
+        template <class WString>
+        explicit compressed_ws(const WString& ws, double epsilon = 0.)
+            : _size(ws.size()), _gap(ws.gap()), _epsilon(epsilon), _uncertain(ws.size())
+        {
+            if (!(epsilon >= 0. && epsilon < 1.)) {
+                throw std::invalid_argument("epsilon must be in [0, 1)");
+            }
+
+            // Dead positions (allowed with ws_not_strict) have no heaviest letter, empty maps would throw
+            std::string heaviest(_size, '\0');
+            std::vector<bool> dead(_size);
+            std::array<bool, 256> letters{};
+
+            for (size_t i = 0; i < _size; ++i) {
+                dead[i] = 0. == ws[i].probabilities().sum();
+
+                if (!dead[i]) {
+                    heaviest[i] = ws[i].heaviest_value();
+                    letters[static_cast<unsigned char>(heaviest[i])] = true;
+                }
+
+                if (dead[i] || !(ws[i].p(heaviest[i]) >= 1. - epsilon)) {
+                    _uncertain.set(i);
+                    _chars.push_back(ws[i]);
+                }
+            }
+
+            for (size_t c = 0; c < letters.size(); ++c) {
+                if (letters[c]) {
+                    _alph.push_back(static_cast<char>(c));
+                }
+            }
+
+            // Without any heaviest letter, dead positions take the gap (or 'A')
+            if (_alph.empty() && _size > 0) {
+                _alph.push_back(NO_GAP != _gap ? _gap : 'A');
+            }
+
+            _log_bits = _alph.size() <= 4 ? 1 : (_alph.size() <= 16 ? 2 : 3);
+
+            unsigned char codes[256] = {};
+
+            for (size_t k = 0; k < _alph.size(); ++k) {
+                codes[static_cast<unsigned char>(_alph[k])] = static_cast<unsigned char>(k);
+            }
+
+            _letters.assign((_size + _per_word() - 1) / _per_word(), 0);
+
+            for (size_t i = 0; i < _size; ++i) {
+                std::uint64_t code = dead[i] ? 0 : codes[static_cast<unsigned char>(heaviest[i])];
+                _letters[i >> _word_shift()] |= code << ((i & (_per_word() - 1)) << _log_bits);
+            }
+
+            _uncertain.build();
+        }
+
+        //! Number of positions
+        size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return 0 == _size;
+        }
+
+        bool has_gap() const
+        {
+            return NO_GAP != _gap;
+        }
+
+        char gap() const
+        {
+            return _gap;
+        }
+
+        double epsilon() const
+        {
+            return _epsilon;
+        }
+
+        //! Number of bits of each letter
+        size_t letter_bits() const
+        {
+            return size_t(1) << _log_bits;
+        }
+
+        //! Number of uncertain positions, whose weighted char is stored
+        size_t uncertain() const
+        {
+            return _chars.size();
+        }
+
+        bool certain(size_t i) const
+        {
+            return !_uncertain[i];
+        }
+
+        //! Heaviest letter of a position (the letter of a certain position)
+        char letter(size_t i) const
+        {
+            std::uint64_t word = _letters[i >> _word_shift()];
+            return _alph[(word >> ((i & (_per_word() - 1)) << _log_bits)) & ((std::uint64_t(1) << letter_bits()) - 1)];
+        }
+
+        //! Number of uncertain positions before a position, the indice of its weighted char if it is uncertain
+        size_t uncertain_before(size_t i) const
+        {
+            return _uncertain.rank(i);
+        }
+
+        //! Weighted chars of the uncertain positions, in order
+        const std::vector<w_char>& uncertain_chars() const
+        {
+            return _chars;
+        }
+
+        //! Weighted char of an uncertain position, null for a certain position
+        const w_char* uncertain_char(size_t i) const
+        {
+            return _uncertain[i] ? &_chars[_uncertain.rank(i)] : nullptr;
+        }
+
+        //! Weighted char of a position, made from the letter for a certain position
+        w_char operator[](size_t i) const
+        {
+            const w_char* wc = uncertain_char(i);
+            return wc ? *wc : _certain_char(letter(i));
+        }
+
+        //! Access with bound checking
+        /*!
+          * \throw std::out_of_range if i >= size()
+         */
+        w_char at(size_t i) const
+        {
+            if (i >= _size) {
+                throw std::out_of_range("The position is out of the compressed weighted string");
+            }
+
+            return (*this)[i];
+        }
+
+        //! Probability of a letter at a position
+        double p(size_t i, char c) const
+        {
+            const w_char* wc = uncertain_char(i);
+            return wc ? wc->p(c) : certain_p(letter(i), c);
+        }
+
+        //! Natural logarithm of the probability of a letter at a position
+        double log_p(size_t i, char c) const
+        {
+            const w_char* wc = uncertain_char(i);
+            return wc ? wc->log_p(c) : std::log(certain_p(letter(i), c));
+        }
+
+        //! Same as weighted_string::log_p for a solid string occurring at a given position
+        /*!
+          * \throw std::out_of_range if the string goes beyond the end of the weighted string
+         */
+        double log_p(size_t pos, const std::string& s) const
+        {
+            if (pos + s.size() > _size) {
+                throw std::out_of_range("The string goes beyond the end of the weighted string");
+            }
+
+            double log = 0.;
+
+            for (size_t j = 0; j < s.size(); ++j) {
+                log += log_p(pos + j, s[j]);
+            }
+
+            return log;
+        }
+
+        //! Probability of a letter at a certain position of a given letter (0 or 1)
+        static double certain_p(char letter, char c)
+        {
+            if constexpr (has_extended_letters<Container>::value) {
+                if (Container::is_extended(c)) {
+                    return _certain_char(letter).p(c);
+                }
+            }
+
+            return letter == c ? 1. : 0.;
+        }
+
+        std::string heaviest() const
+        {
+            return _heaviest(true);
+        }
+
+        std::string heaviest_ungap() const
+        {
+            return _heaviest(false);
+        }
+
+        //! Same as weighted_string::heaviest(char*), from the letters only
+        size_t heaviest(char* out) const
+        {
+            return _heaviest_into(out, true);
+        }
+
+        //! Same as weighted_string::heaviest_ungap(char*), from the letters only
+        size_t heaviest_ungap(char* out) const
+        {
+            return _heaviest_into(out, false);
+        }
+
+        //! The weighted string with all its weighted chars
+        weighted_string<Container> decompress() const
+        {
+            weighted_string<Container> ws;
+            ws.reserve(_size);
+
+            for (size_t i = 0; i < _size; ++i) {
+                ws.push_back((*this)[i]);
+            }
+
+            ws.set_gap(_gap);
+
+            return ws;
+        }
+
+        //! Approximate memory used, in bytes
+        size_t memory() const
+        {
+            return sizeof(*this) + _letters.size() * 8 + _uncertain.memory() + _chars.size() * sizeof(w_char);
+        }
+
+    private:
+
+        unsigned _word_shift() const
+        {
+            return 6 - _log_bits;
+        }
+
+        size_t _per_word() const
+        {
+            return size_t(1) << _word_shift();
+        }
+
+        static w_char _certain_char(char letter)
+        {
+            Container wc;
+            wc[letter] = 1.;
+
+            return w_char(std::move(wc), false);
+        }
+
+        size_t _heaviest_into(char* out, bool with_gap) const
+        {
+            size_t mask = (size_t(1) << letter_bits()) - 1;
+            size_t w = 0;
+
+            for (size_t i = 0; i < _size; i += _per_word()) {
+                std::uint64_t word = _letters[i >> _word_shift()];
+
+                for (size_t k = i; k < std::min(_size, i + _per_word()); ++k) {
+                    char c = _alph[word & mask];
+                    word >>= letter_bits();
+
+                    out[w] = c;
+                    w += with_gap || c != _gap;
+                }
+            }
+
+            return w;
+        }
+
+        std::string _heaviest(bool with_gap) const
+        {
+            std::string h(_size, '\0');
+            h.resize(_heaviest_into(&h[0], with_gap));
+
+            return h;
+        }
+};
+
+
+//! Find occurrences of solid patterns in a compressed weighted string with a probability threshold
+/*!
+  * Same as weighted_pattern_matcher on a compressed_ws: certain positions have a log-probability 0 for their letter,
+  * so the upper bound of a window is the sum of the log-probabilities of the heaviest letters of its uncertain
+  * positions only. These sums are stored for the uncertain positions, so the matcher takes O(uncertain()) memory.
+  * Certain positions are verified by comparing letters.
+  *
+  * The matcher keeps a reference on the compressed weighted string, which should live as long as the matcher.
+  *
+  * \sa wstr::weighted_pattern_matcher
+ */
+template <class Container>
+class compressed_pattern_matcher
+{
+    private:
+
+        const compressed_ws<Container>& _ws;
+        double _z;
+        double _log_threshold;
+
+        // For the k-th uncertain position: sums over the uncertain positions before it
+        std::vector<double> _prefix;
+        std::vector<size_t> _dead;
+        std::vector<double> _log_heaviest;
+
+    public:
+
+        //! Preprocess a compressed weighted string for a given threshold
+        /*!
+          * \throw std::invalid_argument if z is lower than 1
+         */
+        compressed_pattern_matcher(const compressed_ws<Container>& ws, double z) : _ws(ws), _z(z), _log_threshold(-std::log(z))
+        {
+            if (!(z >= 1.)) {
+                throw std::invalid_argument("The threshold z must be greater or equal to 1");
+            }
+
+            size_t u = ws.uncertain();
+
+            _prefix.assign(u + 1, 0.);
+            _dead.assign(u + 1, 0);
+            _log_heaviest.resize(u);
+
+            size_t k = 0;
+
+            for (size_t i = 0; i < ws.size(); ++i) {
+                const auto* wc = ws.uncertain_char(i);
+
+                if (nullptr == wc) {
+                    continue;
+                }
+
+                double h = 0. == wc->probabilities().sum() ? 0. : wc->heaviest_proba();
+                bool dead = !(h > 0.);
+
+                _log_heaviest[k] = dead ? 0. : std::log(h);
+                _prefix[k + 1] = _prefix[k] + _log_heaviest[k];
+                _dead[k + 1] = _dead[k] + dead;
+                ++k;
+            }
+        }
+
+        double z() const
+        {
+            return _z;
+        }
+
+        //! Return all positions (in increasing order) where the pattern occurs with probability >= 1/z
+        /*!
+          * An empty pattern has no occurrence.
+         */
+        std::vector<size_t> find(const std::string& pattern) const
+        {
+            std::vector<size_t> occ;
+            size_t m = pattern.size();
+            size_t n = _ws.size();
+
+            if (0 == m || m > n) {
+                return occ;
+            }
+
+            std::vector<size_t> extended = _extended_positions(pattern);
+
+            // Number of uncertain positions before i and before i + m
+            size_t first = 0;
+            size_t last = 0;
+
+            for (size_t j = 0; j < m; ++j) {
+                last += !_ws.certain(j);
+            }
+
+            for (size_t i = 0; i + m <= n; ++i) {
+                if (i > 0) {
+                    first += !_ws.certain(i - 1);
+                    last += !_ws.certain(i + m - 1);
+                }
+
+                if (_check(pattern, extended, i, first, last)) {
+                    occ.push_back(i);
+                }
+            }
+
+            return occ;
+        }
+
+        //! Batch version of find, the i-th result is the list of occurrences of the i-th pattern
+        std::vector<std::vector<size_t>> find_all(const std::vector<std::string>& patterns) const
+        {
+            std::vector<std::vector<size_t>> occ;
+            occ.reserve(patterns.size());
+
+            for (const std::string& pattern : patterns) {
+                occ.push_back(find(pattern));
+            }
+
+            return occ;
+        }
+
+        //! Check if the pattern occurs at a given position with probability >= 1/z
+        bool occurs_at(const std::string& pattern, size_t i) const
+        {
+            size_t m = pattern.size();
+
+            if (0 == m || i + m > _ws.size()) {
+                return false;
+            }
+
+            return _check(pattern, _extended_positions(pattern), i, _ws.uncertain_before(i), _ws.uncertain_before(i + m));
+        }
+
+    private:
+
+        //! Positions of the pattern which contain a letter of the extended alphabet
+        static std::vector<size_t> _extended_positions(const std::string& pattern)
+        {
+            std::vector<size_t> extended;
+
+            if constexpr (has_extended_letters<Container>::value) {
+                for (size_t j = 0; j < pattern.size(); ++j) {
+                    if (Container::is_extended(pattern[j])) {
+                        extended.push_back(j);
+                    }
+                }
+            }
+
+            return extended;
+        }
+
+        //! Bound of the window from its uncertain positions in [first, last), then letter by letter verification
+        /*!
+          * As in weighted_pattern_matcher, extended letters can be more probable than the heaviest letter,
+          * so they do not take part in the bound.
+         */
+        bool _check(const std::string& pattern, const std::vector<size_t>& extended, size_t i, size_t first, size_t last) const
+        {
+            if (_dead[last] != _dead[first]) {
+                return false;
+            }
+
+            double bound = _prefix[last] - _prefix[first];
+
+            for (size_t j : extended) {
+                if (!_ws.certain(i + j)) {
+                    bound -= _log_heaviest[_ws.uncertain_before(i + j)];
+                }
+            }
+
+            if (bound < _log_threshold - log_epsilon) {
+                return false;
+            }
+
+            auto ext = extended.begin();
+            size_t k = first;
+
+            for (size_t j = 0; j < pattern.size(); ++j) {
+                bool is_extended = ext != extended.end() && *ext == j;
+                ext += is_extended;
+
+                if (_ws.certain(i + j)) {
+                    if (0. == compressed_ws<Container>::certain_p(_ws.letter(i + j), pattern[j])) {
+                        return false;
+                    }
+
+                    continue;
+                }
+
+                double letter_bound = is_extended ? 0. : _log_heaviest[k];
+                bound += _ws.uncertain_chars()[k].log_p(pattern[j]) - letter_bound;
+                ++k;
+
+                if (bound < _log_threshold - log_epsilon) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+};
+
+//! Return all positions where a solid pattern occurs in a compressed weighted string with probability >= 1/z
+/*!
+  * \sa wstr::compressed_pattern_matcher
+ */
+template <class Container>
+std::vector<size_t> find_occurrences(const compressed_ws<Container>& ws, const std::string& pattern, double z)
+{
+    return compressed_pattern_matcher<Container>(ws, z).find(pattern);
+}
+
+}
\ No newline at end of file
@@ -2,14 +2,77 @@
 
 #include <unordered_map>
 #include <array>
+#include <vector>
+#include <functional>
+#include <memory>
 #include <stdexcept>
 #include <limits>
+#include <utility>
 #include <cmath>
+#include <cstdint>
 #include <algorithm>
+#include <type_traits>
+#include <initializer_list>
 
 namespace wstr
 {
 
+//! Check if a Container has a `log_at` method for the key type T
+template <class Container, class T, class = void>
+struct has_log_at : std::false_type {};
+
+template <class Container, class T>
+struct has_log_at<Container, T, std::void_t<decltype(std::declval<const Container&>().log_at(std::declval<const T&>()))>> : std::true_type {};
+
+
+//! Rounding error allowed on the sum of probabilities of a Container
+template <class Container, class = void>
+struct sum_tolerance_of
+{
+    static constexpr double value() { return std::numeric_limits<double>::epsilon(); }
+};
+
+template <class Container>
+struct sum_tolerance_of<Container, std::void_t<decltype(Container::sum_tolerance())>>
+{
+    static constexpr double value() { return Container::sum_tolerance(); }
+};
+
+template <class Container>
+constexpr double sum_tolerance()
+{
+    return sum_tolerance_of<Container>::value();
+}
+
+
+//! Give the allocator_type of a Container, if it has one, to the weighted elements which store it
+/*!
+  * A weighted element whose Container uses an allocator is itself allocator-aware, so a vector of weighted
+  * elements with a scoped allocator (such as std::pmr::polymorphic_allocator) passes its allocator to the
+  * Container of each element.
+ */
+template <class Container, class = void>
+struct container_allocator_type {};
+
+template <class Container>
+struct container_allocator_type<Container, std::void_t<typename Container::allocator_type>>
+{
+    typedef typename Container::allocator_type allocator_type;
+};
+
+//! Create an empty object of type T which allocates with alloc, or a default one if T does not use such allocator
+template <class T, class Alloc>
+T make_container(const Alloc& alloc)
+{
+    if constexpr (std::uses_allocator<T, Alloc>::value) {
+        return T(alloc);
+    }
+    else {
+        return T();
+    }
+}
+
+
 //! A class for weighted element of any type (not just weighted character)
 /*!
   * \tparam T           The type of element which are weighted
@@ -19,18 +82,32 @@ namespace wstr
   * - Container(const Container&)               : A copy constructor
   * - bool operator==(const Container&) const   : Check if two containers are equals
   * - double& operator[](const T&)              : Create a new element with default probability and return it
+  *                                               (it can also return a proxy object which is assignable from and convertible to double)
   * - double at(const T&) const                 : Return the probability of an element (should be 0 if the element is not in the container!)
   * - const T& heaviest() const                 : Return the value with the heaviest probability
   * - double sum() const                        : Return the sum of all probabilities
+  * - void for_each(F f) const                  : Call f(key, probability) for each element of the container
+  *
+  * The Container can also have the following methods:
+  * - double log_at(const T&) const             : Return the natural logarithm of the probability of an element,
+  *                                               used by `log_p` instead of computing the logarithm of `at`
+  * - static double sum_tolerance()             : Rounding error allowed on the sum by `is_good` (double epsilon by default),
+  *                                               for containers which do not store probabilities exactly
+  * - allocator_type, Container(const allocator_type&) and the allocator-extended copy and move constructors
+  *                                             : Then the weighted element can be built with an allocator (see the
+  *                                               constructors taking std::allocator_arg)
   *
   * \sa wstr::w_map
+  * \sa wstr::w_sparse
   * \sa wstr::w_array
+  * \sa wstr::w_log_array
+  * \sa wstr::w_quantized_array
  */
 template <
     class T,
     class Container
 >
-class weighted_element
+class weighted_element : public container_allocator_type<Container>
 {
     private:
 
@@ -46,7 +123,7 @@ class weighted_element
           *
           * \throw std::invalid_argument if strict equal to true and the sum is not equals to 1.
          */
-        weighted_element(Container probabilities, bool strict = true, double precision = 0.) : _probabilities(probabilities)
+        weighted_element(Container probabilities, bool strict = true, double precision = 0.) : _probabilities(std::move(probabilities))
         {
             if (strict && !is_good(precision)) { 
                 throw std::invalid_argument("The sum of probabilities is not equal to one");
@@ -54,7 +131,7 @@ class weighted_element
         }
 
         //! Constructor alias to give different precision
-        weighted_element(Container probabilities, double precision) : weighted_element(probabilities, true, precision)
+        weighted_element(Container probabilities, double precision) : weighted_element(std::move(probabilities), true, precision)
         {
             
         }
@@ -65,6 +142,47 @@ class weighted_element
 
         }
 
+        //! Empty constructor, the Container allocates with alloc
+        template <class Alloc, class = std::enable_if_t<std::uses_allocator<Container, Alloc>::value>>
+        weighted_element(std::allocator_arg_t, const Alloc& alloc) : _probabilities(alloc)
+        {
+
+        }
+
+        //! Same as the constructor with all probabilities, the Container allocates with alloc
+        /*!
+          * \throw std::invalid_argument if strict equal to true and the sum is not equals to 1.
+         */
+        template <class Alloc, class = std::enable_if_t<std::uses_allocator<Container, Alloc>::value>>
+        weighted_element(std::allocator_arg_t, const Alloc& alloc, Container probabilities, bool strict = true, double precision = 0.)
+            : _probabilities(std::move(probabilities), alloc)
+        {
+            if (strict && !is_good(precision)) {
+                throw std::invalid_argument("The sum of probabilities is not equal to one");
+            }
+        }
+
+        template <class Alloc, class = std::enable_if_t<std::uses_allocator<Container, Alloc>::value>>
+        weighted_element(std::allocator_arg_t, const Alloc& alloc, Container probabilities, double precision)
+            : weighted_element(std::allocator_arg, alloc, std::move(probabilities), true, precision)
+        {
+
+        }
+
+        //! Copy with another allocator
+        template <class Alloc, class = std::enable_if_t<std::uses_allocator<Container, Alloc>::value>>
+        weighted_element(std::allocator_arg_t, const Alloc& alloc, const weighted_element& oth) : _probabilities(oth._probabilities, alloc)
+        {
+
+        }
+
+        //! Move with another allocator (probabilities are copied if the allocators are not equal)
+        template <class Alloc, class = std::enable_if_t<std::uses_allocator<Container, Alloc>::value>>
+        weighted_element(std::allocator_arg_t, const Alloc& alloc, weighted_element&& oth) : _probabilities(std::move(oth._probabilities), alloc)
+        {
+
+        }
+
         //! == operator
         bool operator==(const weighted_element<T, Container>& oth) const
         {
@@ -78,7 +196,7 @@ class weighted_element
         }
         
         //! []-operator access to the element with given key, if there is not such element, create it
-        double& operator[](const T& key)
+        decltype(auto) operator[](const T& key)
         {
             return _probabilities[key];
         }
@@ -89,6 +207,17 @@ class weighted_element
             return _probabilities.at(key);
         }
 
+        //! Return the natural logarithm of the probability for a certain key (-infinity if the key don't exists)
+        double log_p(const T& key) const
+        {
+            if constexpr (has_log_at<Container, T>::value) {
+                return _probabilities.log_at(key);
+            }
+            else {
+                return std::log(_probabilities.at(key));
+            }
+        }
+
         //! Return the value which has the heighest probability
         const T& heaviest_value() const
         {
@@ -106,7 +235,14 @@ class weighted_element
         {
             double sum = _probabilities.sum();
 
-            return fabs(1.0 - sum) < precision + std::numeric_limits<double>::epsilon();
+            return fabs(1.0 - sum) < precision + sum_tolerance<Container>();
+        }
+
+        //! Call f(value, probability) for each value stored in the container (probabilities can be 0)
+        template <class F>
+        void for_each(F f) const
+        {
+            _probabilities.for_each(f);
         }
 
         //! Get container and all probabilities
@@ -169,9 +305,226 @@ class w_map : public std::unordered_map<T, double, Hash, KeyEqual, Allocator>
 
             return sum;
         }
+
+        template <class F>
+        void for_each(F f) const
+        {
+            for (const auto& proba : *this) {
+                f(proba.first, proba.second);
+            }
+        }
 };
 
 
+//! Container for weighted element which stores only non-zero probabilities in a small sorted buffer
+/*!
+  * \tparam T           The type of element which is weighted
+  * \tparam Capacity    Number of elements stored without allocation
+  * \tparam Compare     Order of the elements in the buffer
+  * \tparam Allocator   Allocator of the buffer used above Capacity elements
+  *
+  * Pairs (element, probability) are kept sorted by element. Up to Capacity pairs are stored inline in the
+  * container, above that all pairs move to a std::vector. Elements which are not stored have probability 0.
+  * It is meant for large alphabets where each position has a few non-zero probabilities, where it avoids
+  * the allocations of w_map.
+  *
+  * As for std::vector, `operator[]` returns a reference which is invalidated by the insertion of another element.
+  *
+  * \sa wstr::w_map
+ */
+template<
+    class T,
+    std::size_t Capacity = 4,
+    class Compare = std::less<T>,
+    class Allocator = std::allocator<std::pair<T, double>>
+>
+class w_sparse
+{
+    public:
+
+        typedef std::pair<T, double> value_type;
+        typedef const value_type* const_iterator;
+        typedef Allocator allocator_type;
+
+    private:
+
+        std::array<value_type, Capacity> _inline;
+        std::vector<value_type, Allocator> _heap;
+        size_t _size = 0;
+
+    public:
+
+        w_sparse()
+        {
+
+        }
+
+        explicit w_sparse(const Allocator& alloc) : _heap(alloc)
+        {
+
+        }
+
+        w_sparse(const w_sparse& oth, const Allocator& alloc) : _inline(oth._inline), _heap(oth._heap, alloc), _size(oth._size)
+        {
+
+        }
+
+        w_sparse(w_sparse&& oth, const Allocator& alloc) : _inline(oth._inline), _heap(std::move(oth._heap), alloc), _size(oth._size)
+        {
+
+        }
+
+        allocator_type get_allocator() const
+        {
+            return _heap.get_allocator();
+        }
+
+        //! Initialization with pairs such as {{'a', .2}, {'b', .8}}
+        w_sparse(std::initializer_list<value_type> probabilities)
+        {
+            for (const value_type& p : probabilities) {
+                operator[](p.first) = p.second;
+            }
+        }
+
+        bool operator==(const w_sparse& oth) const
+        {
+            return std::equal(begin(), end(), oth.begin(), oth.end());
+        }
+
+        bool operator!=(const w_sparse& oth) const
+        {
+            return !operator==(oth);
+        }
+
+        //! Number of stored elements
+        size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return 0 == _size;
+        }
+
+        //! True if the elements are stored in the heap
+        bool spilled() const
+        {
+            return !_heap.empty();
+        }
+
+        const_iterator begin() const
+        {
+            return spilled() ? _heap.data() : _inline.data();
+        }
+
+        const_iterator end() const
+        {
+            return begin() + _size;
+        }
+
+        //! Access to the probability of an element, insert it with probability 0 if it is not stored
+        double& operator[](const T& key)
+        {
+            value_type* first = spilled() ? _heap.data() : _inline.data();
+            value_type* it = _lower_bound(first, key);
+
+            if (it != first + _size && !Compare()(key, it->first)) {
+                return it->second;
+            }
+
+            size_t pos = it - first;
+
+            if (spilled()) {
+                _heap.insert(_heap.begin() + pos, value_type(key, 0.));
+                ++_size;
+                return _heap[pos].second;
+            }
+
+            if (_size == Capacity) {
+                _heap.reserve(2 * Capacity + 1);
+                _heap.assign(_inline.begin(), _inline.end());
+                _heap.insert(_heap.begin() + pos, value_type(key, 0.));
+                ++_size;
+                return _heap[pos].second;
+            }
+
+            std::move_backward(first + pos, first + _size, first + _size + 1);
+            first[pos] = value_type(key, 0.);
+            ++_size;
+
+            return first[pos].second;
+        }
+
+        double at(const T& key) const
+        {
+            // A linear scan is faster than a binary search on the inline buffer
+            if (!spilled()) {
+                double p = 0.;
+
+                for (size_t i = 0; i < _size; ++i) {
+                    bool equivalent = !Compare()(_inline[i].first, key) && !Compare()(key, _inline[i].first);
+                    p = equivalent ? _inline[i].second : p;
+                }
+
+                return p;
+            }
+
+            const_iterator it = _lower_bound(begin(), key);
+            return (it != end() && !Compare()(key, it->first)) ? it->second : 0.;
+        }
+
+        const T& heaviest() const
+        {
+            if (empty()) {
+                throw std::runtime_error("There is no value with probability greater than 0.");
+            }
+
+            return std::max_element(begin(), end(), [](const value_type& p1, const value_type& p2) {
+                return p1.second < p2.second;
+            })->first;
+        }
+
+        double sum() const
+        {
+            double sum = 0.;
+
+            for (const value_type& p : *this) {
+                sum += p.second;
+            }
+
+            return sum;
+        }
+
+        template <class F>
+        void for_each(F f) const
+        {
+            for (const value_type& p : *this) {
+                f(p.first, p.second);
+            }
+        }
+
+    private:
+
+        template <class Pointer>
+        Pointer _lower_bound(Pointer first, const T& key) const
+        {
+            return std::lower_bound(first, first + _size, key, [](const value_type& p, const T& k) {
+                return Compare()(p.first, k);
+            });
+        }
+};
+
+
+//! Check if a Translator has a noexcept `find_indice` method for the key type T
+template <class Translator, class T, class = void>
+struct has_find_indice : std::false_type {};
+
+template <class Translator, class T>
+struct has_find_indice<Translator, T, std::void_t<decltype(Translator::find_indice(std::declval<const T&>()))>> : std::true_type {};
+
+
 //! Container for weighted element based on array
 /*!
   * \tparam T           The type of element which is weighted
@@ -183,6 +536,11 @@ class w_map : public std::unordered_map<T, double, Hash, KeyEqual, Allocator>
   * - size_t get_indice(const T&)   : Return the indice of a given element (should be between 0 and N - 1).
   *                                   If the element do not belong to the array, should throw a std::runtime_error exception.
   *
+  * The Translator can also have a static `npos` member and a static method:
+  * - size_t find_indice(const T&) noexcept : Same as get_indice but return npos if the element do not belong to the array.
+  *
+  * When it exists, `at` uses find_indice instead of catching the exception of get_indice.
+  *
   * \sa std::array
  */ 
 template<
@@ -216,11 +574,17 @@ class w_array : public std::array<double, N>
 
         double at(const T& key) const
         {
-            try {
-                return std::array<double, N>::at(Translator::get_indice(key));
+            if constexpr (has_find_indice<Translator, T>::value) {
+                size_t i = Translator::find_indice(key);
+                return Translator::npos == i ? 0. : std::array<double, N>::operator[](i);
             }
-            catch (const std::runtime_error& e) {
-                return 0.;
+            else {
+                try {
+                    return std::array<double, N>::at(Translator::get_indice(key));
+                }
+                catch (const std::runtime_error& e) {
+                    return 0.;
+                }
             }
         }
         
@@ -239,6 +603,365 @@ class w_array : public std::array<double, N>
 
             return sum;
         }
+
+        template <class F>
+        void for_each(F f) const
+        {
+            for (size_t i = 0; i < N; ++i) {
+                f(Translator::get_element(i), std::array<double, N>::operator[](i));
+            }
+        }
+};
+
+
+
+//! Reference to a probability which is stored as its natural logarithm
+/*!
+  * Returned by w_log_array::operator[] so that probabilities can be read and written as usual.
+ */
+class log_reference
+{
+    private:
+
+        double& _log;
+
+    public:
+
+        explicit log_reference(double& log) : _log(log)
+        {
+
+        }
+
+        log_reference& operator=(double p)
+        {
+            _log = std::log(p);
+            return *this;
+        }
+
+        log_reference& operator=(const log_reference& oth)
+        {
+            _log = oth._log;
+            return *this;
+        }
+
+        operator double() const
+        {
+            return std::exp(_log);
+        }
+};
+
+
+//! Container for weighted element based on an array of log-probabilities
+/*!
+  * \tparam T           The type of element which is weighted
+  * \tparam N           The size of the array
+  * \tparam Translator  Same as Translator param for w_array
+  *
+  * The array stores the natural logarithm of each probability (-infinity for a probability 0), so products of
+  * probabilities along a weighted string are sums of `log_at` values which cannot underflow.
+  * Probabilities are still given and returned in linear space by `operator[]` and `at`.
+  * The sum is computed with the log-sum-exp trick.
+  *
+  * \sa wstr::w_array
+  * \sa wstr::log_reference
+ */
+template<
+    class T,
+    std::size_t N,
+    class Translator
+>
+class w_log_array : public std::array<double, N>
+{
+    public:
+
+        //! Initialization with probabilities (not logarithms) such as {.2, .8}
+        w_log_array(std::initializer_list<double> probabilities) : w_log_array()
+        {
+            std::transform(probabilities.begin(), probabilities.begin() + std::min(N, probabilities.size()), this->begin(), [](double p) {
+                return std::log(p);
+            });
+        }
+
+        w_log_array() : std::array<double, N>()
+        {
+            // Values initialized to probability 0
+            this->fill(-std::numeric_limits<double>::infinity());
+        }
+
+        log_reference operator[](const T& key)
+        {
+            return log_reference(std::array<double, N>::operator[](Translator::get_indice(key)));
+        }
+
+        double at(const T& key) const
+        {
+            return std::exp(log_at(key));
+        }
+
+        double log_at(const T& key) const
+        {
+            if constexpr (has_find_indice<Translator, T>::value) {
+                size_t i = Translator::find_indice(key);
+                return Translator::npos == i ? -std::numeric_limits<double>::infinity() : std::array<double, N>::operator[](i);
+            }
+            else {
+                try {
+                    return std::array<double, N>::at(Translator::get_indice(key));
+                }
+                catch (const std::runtime_error& e) {
+                    return -std::numeric_limits<double>::infinity();
+                }
+            }
+        }
+
+        const T& heaviest() const
+        {
+            return Translator::get_element(std::distance(this->begin(), std::max_element(this->begin(), this->end())));
+        }
+
+        double sum() const
+        {
+            return std::exp(log_sum());
+        }
+
+        template <class F>
+        void for_each(F f) const
+        {
+            for (size_t i = 0; i < N; ++i) {
+                f(Translator::get_element(i), std::exp(std::array<double, N>::operator[](i)));
+            }
+        }
+
+        //! Each probability goes through a log and an exp, which adds a few rounding errors to the sum
+        static constexpr double sum_tolerance()
+        {
+            return 4 * N * std::numeric_limits<double>::epsilon();
+        }
+
+        //! Return the natural logarithm of the sum of all probabilities
+        double log_sum() const
+        {
+            double max = *std::max_element(this->begin(), this->end());
+
+            if (std::isinf(max)) {
+                return max;
+            }
+
+            double sum = 0.;
+
+            for (double log : *this) {
+                sum += std::exp(log - max);
+            }
+
+            return max + std::log(sum);
+        }
+};
+
+
+//! Default scale of quantized probabilities: the largest integer represents the probability 1
+/*!
+  * Floating point storages are not scaled, so their scale is 1.
+ */
+template <class Storage>
+constexpr std::uint64_t default_quantization_scale()
+{
+    if constexpr (std::is_integral<Storage>::value) {
+        return std::numeric_limits<Storage>::max();
+    }
+    else {
+        return 1;
+    }
+}
+
+//! Conversion between probabilities and their quantized storage
+/*!
+  * \tparam Storage     float, or an unsigned integer type for fixed-point probabilities
+  * \tparam Scale       For integer storages, the value which represents the probability 1
+  *
+  * Integer values are rounded to the nearest multiple of 1 / Scale and saturate at the bounds of the storage type.
+ */
+template <class Storage, std::uint64_t Scale>
+struct quantization
+{
+    static_assert(std::is_floating_point<Storage>::value || std::is_unsigned<Storage>::value, "Quantized probabilities are stored as floating point or unsigned integers");
+    static_assert(std::is_floating_point<Storage>::value || (Scale > 0 && Scale <= std::numeric_limits<Storage>::max()), "The scale must fit in the storage type");
+
+    static Storage encode(double p)
+    {
+        if constexpr (std::is_floating_point<Storage>::value) {
+            return static_cast<Storage>(p);
+        }
+        else {
+            double v = std::round(p * Scale);
+
+            if (!(v > 0.)) {
+                return 0;
+            }
+
+            return v >= std::numeric_limits<Storage>::max() ? std::numeric_limits<Storage>::max() : static_cast<Storage>(v);
+        }
+    }
+
+    static double decode(Storage v)
+    {
+        if constexpr (std::is_floating_point<Storage>::value) {
+            return v;
+        }
+        else {
+            return v / static_cast<double>(Scale);
+        }
+    }
+
+    //! Largest difference between a probability and its decoded value
+    static constexpr double error()
+    {
+        if constexpr (std::is_floating_point<Storage>::value) {
+            return std::numeric_limits<Storage>::epsilon();
+        }
+        else {
+            return .5 / Scale;
+        }
+    }
+};
+
+//! Reference to a probability which is stored quantized
+/*!
+  * Returned by w_quantized_array::operator[] so that probabilities can be read and written as usual.
+ */
+template <class Storage, std::uint64_t Scale>
+class quantized_reference
+{
+    private:
+
+        Storage& _value;
+
+    public:
+
+        explicit quantized_reference(Storage& value) : _value(value)
+        {
+
+        }
+
+        quantized_reference& operator=(double p)
+        {
+            _value = quantization<Storage, Scale>::encode(p);
+            return *this;
+        }
+
+        quantized_reference& operator=(const quantized_reference& oth)
+        {
+            _value = oth._value;
+            return *this;
+        }
+
+        operator double() const
+        {
+            return quantization<Storage, Scale>::decode(_value);
+        }
+};
+
+
+//! Container for weighted element based on an array of quantized probabilities
+/*!
+  * \tparam T           The type of element which is weighted
+  * \tparam N           The size of the array
+  * \tparam Translator  Same as Translator param for w_array
+  * \tparam Storage     float, uint16_t or uint8_t (any unsigned integer type) to store each probability
+  * \tparam Scale       For integer storages, the value which represents the probability 1
+  *
+  * Probabilities take sizeof(Storage) bytes instead of 8, at the cost of a rounding error (see quantization::error).
+  * The tolerance of `is_good` accounts for this error on the sum.
+  *
+  * \sa wstr::w_array
+  * \sa wstr::quantized_reference
+ */
+template<
+    class T,
+    std::size_t N,
+    class Translator,
+    class Storage,
+    std::uint64_t Scale = default_quantization_scale<Storage>()
+>
+class w_quantized_array : public std::array<Storage, N>
+{
+    public:
+
+        typedef quantization<Storage, Scale> quantizer;
+
+        //! Initialization with probabilities such as {.2, .8}
+        w_quantized_array(std::initializer_list<double> probabilities) : w_quantized_array()
+        {
+            std::transform(probabilities.begin(), probabilities.begin() + std::min(N, probabilities.size()), this->begin(), quantizer::encode);
+        }
+
+        w_quantized_array() : std::array<Storage, N>()
+        {
+            // Values initialized to probability 0
+            this->fill(0);
+        }
+
+        quantized_reference<Storage, Scale> operator[](const T& key)
+        {
+            return quantized_reference<Storage, Scale>(std::array<Storage, N>::operator[](Translator::get_indice(key)));
+        }
+
+        double at(const T& key) const
+        {
+            if constexpr (has_find_indice<Translator, T>::value) {
+                size_t i = Translator::find_indice(key);
+                return Translator::npos == i ? 0. : quantizer::decode(std::array<Storage, N>::operator[](i));
+            }
+            else {
+                try {
+                    return quantizer::decode(std::array<Storage, N>::at(Translator::get_indice(key)));
+                }
+                catch (const std::runtime_error& e) {
+                    return 0.;
+                }
+            }
+        }
+
+        //! Quantization keeps the order of probabilities, so the heaviest value is found on stored values
+        const T& heaviest() const
+        {
+            return Translator::get_element(std::distance(this->begin(), std::max_element(this->begin(), this->end())));
+        }
+
+        double sum() const
+        {
+            if constexpr (std::is_integral<Storage>::value) {
+                std::uint64_t sum = 0;
+
+                for (Storage v : *this) {
+                    sum += v;
+                }
+
+                return sum / static_cast<double>(Scale);
+            }
+            else {
+                double sum = 0.;
+
+                for (Storage v : *this) {
+                    sum += v;
+                }
+
+                return sum;
+            }
+        }
+
+        template <class F>
+        void for_each(F f) const
+        {
+            for (size_t i = 0; i < N; ++i) {
+                f(Translator::get_element(i), quantizer::decode(std::array<Storage, N>::operator[](i)));
+            }
+        }
+
+        //! Each probability can be rounded by quantizer::error()
+        static constexpr double sum_tolerance()
+        {
+            return N * quantizer::error() + N * std::numeric_limits<double>::epsilon();
+        }
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,495 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cctype>
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+#include <type_traits>
+
+#include "weighted_flat.hpp"
+#include "weighted_reader.hpp"
+#include "weighted_parallel.hpp"
+
+namespace wstr
+{
+
+//! Weighted chars of all pairs (base, Phred quality) of FASTQ reads
+/*!
+  * \tparam Container   Container of the weighted chars, such as dna_container<dna_alph>
+  *
+  * A base with the quality Q has the probability 1 - 10^(-Q/10), the remainder is spread equally over the other
+  * bases. Bases are not case sensitive. Other letters (such as N or IUPAC codes) and '.' are unknown bases: all
+  * bases have the same probability whatever the quality.
+  *
+  * All weighted chars are computed by the constructor, so decoding a read is a lookup per base.
+ */
+template <class Container>
+class phred_table
+{
+    public:
+
+        //! Highest quality of the Phred format ('~' with the offset 33)
+        static constexpr int max_quality = 93;
+
+        //! Value of invalid bases and qualities in the lookup tables
+        static constexpr unsigned char invalid = 0xFF;
+
+    private:
+
+        std::vector<weighted_char<Container>> _entries;
+        std::array<unsigned char, 256> _bases;
+        std::array<unsigned char, 256> _qualities;
+        size_t _width;
+
+    public:
+
+        //! Compute the weighted chars of all pairs (base, quality)
+        /*!
+          * \param offset   Character of the quality 0 (33 for Sanger and Illumina 1.8+, 64 for older Illumina)
+          * \param bases    The bases, all other letters of the Container have a probability 0
+          *
+          * \throw std::invalid_argument if there are less than two bases or if a base is not a letter
+         */
+        explicit phred_table(char offset = 33, const std::string& bases = "ACGT") : _width(bases.size() + 1)
+        {
+            if (bases.size() < 2) {
+                throw std::invalid_argument("A Phred table needs at least two bases");
+            }
+
+            _bases.fill(invalid);
+            _qualities.fill(invalid);
+
+            for (int c = 0; c < 256; ++c) {
+                if (std::isalpha(c) || '.' == c) {
+                    _bases[c] = static_cast<unsigned char>(bases.size());
+                }
+            }
+
+            for (size_t k = 0; k < bases.size(); ++k) {
+                if (!std::isalpha(static_cast<unsigned char>(bases[k]))) {
+                    throw std::invalid_argument(std::string("The base '") + bases[k] + "' is not a letter");
+                }
+
+                _bases[static_cast<unsigned char>(std::toupper(bases[k]))] = static_cast<unsigned char>(k);
+                _bases[static_cast<unsigned char>(std::tolower(bases[k]))] = static_cast<unsigned char>(k);
+            }
+
+            for (int q = 0; q <= max_quality && offset + q <= '~'; ++q) {
+                _qualities[static_cast<unsigned char>(offset + q)] = static_cast<unsigned char>(q);
+
+                double p = probability(q);
+
+                for (size_t k = 0; k < _width; ++k) {
+                    Container wc;
+
+                    for (size_t b = 0; b < bases.size(); ++b) {
+                        if (k == bases.size()) {
+                            wc[bases[b]] = 1. / bases.size();
+                        }
+                        else {
+                            wc[bases[b]] = (b == k) ? p : (1. - p) / (bases.size() - 1);
+                        }
+                    }
+
+                    _entries.emplace_back(std::move(wc), false);
+                }
+            }
+        }
+
+        //! Probability of a base with the quality q
+        static double probability(int q)
+        {
+            return 1. - std::pow(10., -q / 10.);
+        }
+
+        bool valid_base(char c) const
+        {
+            return invalid != _bases[static_cast<unsigned char>(c)];
+        }
+
+        bool valid_quality(char c) const
+        {
+            return invalid != _qualities[static_cast<unsigned char>(c)];
+        }
+
+        //! Weighted char of a base with a quality, both should be valid
+        const weighted_char<Container>& operator()(char base, char quality) const
+        {
+            return _entries[_qualities[static_cast<unsigned char>(quality)] * _width + _bases[static_cast<unsigned char>(base)]];
+        }
+
+        //! Append the weighted chars of n bases with their qualities to a weighted string, all should be valid
+        /*!
+          * Memory is not reserved, so that appending many reads to the same weighted string stays linear.
+         */
+        template <class WString>
+        void append(WString& ws, const char* bases, const char* qualities, size_t n) const
+        {
+            for (size_t i = 0; i < n; ++i) {
+                ws.push_back((*this)(bases[i], qualities[i]));
+            }
+        }
+};
+
+
+//! Streaming reader of FASTQ files, which gives each read as a weighted string
+/*!
+  * \tparam Container   Container of the weighted chars, such as dna_container<dna_alph>
+  *
+  * Each record has four lines: '@' and the name of the read, the bases, '+' (optionally followed by the name) and
+  * the qualities. Sequences and qualities must fit on one line (as written by all current sequencers), line ends
+  * can be "\n" or "\r\n". Bases are decoded with a phred_table.
+  *
+  * The input is read by chunks into a buffer which only holds the records of the current batch, so a file of any
+  * size is read with a bounded memory:
+  *
+  *     fastq_reader<dna_container<dna_alph>> reader("reads.fastq");
+  *     std::vector<w_string_dna> batch;
+  *
+  *     while (reader.read(batch, 1 << 16, nullptr, 4)) {
+  *         // ...
+  *         batch.clear();
+  *     }
+  *
+  * Errors are reported with a ws_parse_error which gives the line of the error, the reader should not be used
+  * after an error.
+  *
+  * \sa wstr::phred_table
+  * \sa wstr::load_fastq
+ */
+template <class Container>
+class fastq_reader
+{
+    public:
+
+        //! Size in bytes of each read of the input
+        static constexpr size_t chunk_size = 1 << 20;
+
+    private:
+
+        //! A record, as offsets in the buffer
+        struct record
+        {
+            size_t name;
+            size_t name_size;
+            size_t bases;
+            size_t qualities;
+            size_t size;
+            size_t line;
+        };
+
+        std::unique_ptr<std::ifstream> _file;
+        std::istream& _in;
+        phred_table<Container> _table;
+
+        // Text read from the input since the start of the current batch, the next record starts at _text_begin
+        std::vector<char> _text;
+        size_t _text_begin = 0;
+        size_t _line = 1;
+        bool _eof = false;
+
+        std::vector<record> _records;
+
+    public:
+
+        //! Read FASTQ records from a stream
+        /*!
+          * \param in       The input, which should live as long as the reader
+          * \param table    The weighted chars of bases and qualities
+         */
+        explicit fastq_reader(std::istream& in, phred_table<Container> table = phred_table<Container>())
+            : _in(in), _table(std::move(table))
+        {
+
+        }
+
+        //! Same on a file
+        /*!
+          * \throw std::runtime_error if the file cannot be opened
+         */
+        explicit fastq_reader(const std::string& path, phred_table<Container> table = phred_table<Container>())
+            : _file(open_file(path)), _in(*_file), _table(std::move(table))
+        {
+
+        }
+
+        fastq_reader(const fastq_reader&) = delete;
+        fastq_reader& operator=(const fastq_reader&) = delete;
+
+        const phred_table<Container>& table() const
+        {
+            return _table;
+        }
+
+        //! Line of the next record (starting at 1)
+        size_t line() const
+        {
+            return _line;
+        }
+
+        //! Append the next reads to a collection of weighted strings
+        /*!
+          * \tparam WStringCollection   A collection of weighted_string<Container> or a flat_ws_collection<Container>
+          * \param max_reads            Maximum number of reads
+          * \param names                If not null, the names of the reads are appended to it
+          * \param threads              Number of threads decoding the reads (0 to use one thread per core)
+          *
+          * Records are first found in the buffer, then decoded concurrently. Reads of a flat_ws_collection are
+          * decoded by a single thread, directly into its arena.
+          *
+          * \return the number of reads, 0 at the end of the input
+          *
+          * \throw ws_parse_error if a record is not valid, nothing is appended to the collection
+         */
+        template <class WStringCollection>
+        size_t read(WStringCollection& wsc, size_t max_reads = static_cast<size_t>(-1), std::vector<std::string>* names = nullptr,
+                    size_t threads = 1)
+        {
+            _compact();
+            _records.clear();
+
+            record r;
+
+            while (_records.size() < max_reads && _scan(r)) {
+                _records.push_back(r);
+            }
+
+            _check();
+            _decode(wsc, threads);
+
+            if (nullptr != names) {
+                for (const record& r : _records) {
+                    names->emplace_back(_text.data() + r.name, r.name_size);
+                }
+            }
+
+            return _records.size();
+        }
+
+    private:
+
+        //! Remove the text of the records of the previous batch
+        void _compact()
+        {
+            _text.erase(_text.begin(), _text.begin() + _text_begin);
+            _text_begin = 0;
+        }
+
+        //! Read a chunk of the input at the end of the buffer
+        /*!
+          * \return false at the end of the input
+         */
+        bool _fill()
+        {
+            if (_eof) {
+                return false;
+            }
+
+            size_t size = _text.size();
+            _text.resize(size + chunk_size);
+
+            _in.read(_text.data() + size, chunk_size);
+            size_t count = static_cast<size_t>(_in.gcount());
+
+            _text.resize(size + count);
+            _eof = count < chunk_size;
+
+            return count > 0;
+        }
+
+        //! Find the end of the line starting at p, read the input if needed
+        /*!
+          * \return the end of the line (without "\r"), and the start of the next line in p
+         */
+        bool _line_end(size_t& p, size_t& end)
+        {
+            size_t searched = p;
+
+            for (;;) {
+                // The buffer is empty (and its data may be null) before the first chunk
+                const char* found = searched == _text.size() ? nullptr
+                    : static_cast<const char*>(std::memchr(_text.data() + searched, '\n', _text.size() - searched));
+
+                if (nullptr != found) {
+                    end = found - _text.data();
+                    p = end + 1;
+                    break;
+                }
+
+                searched = _text.size();
+
+                if (!_fill()) {
+                    if (p == _text.size()) {
+                        return false;
+                    }
+
+                    end = p = _text.size();
+                    break;
+                }
+            }
+
+            if (end > 0 && '\r' == _text[end - 1]) {
+                --end;
+            }
+
+            return true;
+        }
+
+        //! Find the next record in the buffer
+        /*!
+          * \return false at the end of the input
+         */
+        bool _scan(record& r)
+        {
+            size_t p = _text_begin;
+            size_t start, end;
+
+            // Empty lines between records
+            do {
+                start = p;
+
+                if (!_line_end(p, end)) {
+                    return false;
+                }
+
+                ++_line;
+            }
+            while (start == end);
+
+            r.line = _line - 1;
+
+            if ('@' != _text[start]) {
+                throw ws_parse_error(r.line, "a FASTQ record should start with '@'");
+            }
+
+            r.name = start + 1;
+            r.name_size = end - start - 1;
+
+            size_t lines[3];
+
+            for (size_t k = 0; k < 3; ++k) {
+                lines[k] = p;
+
+                if (!_line_end(p, end)) {
+                    throw ws_parse_error(_line, "the FASTQ record is truncated");
+                }
+
+                if (0 == k) {
+                    r.bases = start = lines[0];
+                    r.size = end - start;
+                }
+                else if (1 == k && (end == lines[1] || '+' != _text[lines[1]])) {
+                    throw ws_parse_error(_line, "the bases of a FASTQ record should be followed by a line starting with '+'");
+                }
+                else if (2 == k && end - lines[2] != r.size) {
+                    throw ws_parse_error(_line, "the qualities should have the same length as the bases");
+                }
+
+                ++_line;
+            }
+
+            r.qualities = lines[2];
+            _text_begin = p;
+
+            return true;
+        }
+
+        //! Check the bases and the qualities of the records of the batch
+        void _check() const
+        {
+            for (const record& r : _records) {
+                const char* bases = _text.data() + r.bases;
+                const char* qualities = _text.data() + r.qualities;
+
+                for (size_t i = 0; i < r.size; ++i) {
+                    if (!_table.valid_base(bases[i])) {
+                        throw ws_parse_error(r.line + 1, std::string("invalid base '") + bases[i] + "'");
+                    }
+                }
+
+                for (size_t i = 0; i < r.size; ++i) {
+                    if (!_table.valid_quality(qualities[i])) {
+                        throw ws_parse_error(r.line + 3, std::string("invalid quality '") + qualities[i] + "'");
+                    }
+                }
+            }
+        }
+
+        template <
+            class WAllocator,
+            template <class, class> class Collection,
+            class Allocator
+        >
+        void _decode(Collection<weighted_string<Container, WAllocator>, Allocator>& wsc, size_t threads) const
+        {
+            std::vector<weighted_string<Container, WAllocator>> result;
+            result.reserve(_records.size());
+
+            for (size_t i = 0; i < _records.size(); ++i) {
+                result.push_back(make_container<weighted_string<Container, WAllocator>>(wsc.get_allocator()));
+            }
+
+            parallel_for(_records.size(), 64, threads, [&](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; ++i) {
+                    const record& r = _records[i];
+
+                    result[i].reserve(r.size);
+                    _table.append(result[i], _text.data() + r.bases, _text.data() + r.qualities, r.size);
+                }
+            });
+
+            for (weighted_string<Container, WAllocator>& ws : result) {
+                wsc.push_back(std::move(ws));
+            }
+        }
+
+        void _decode(flat_ws_collection<Container>& wsc, size_t) const
+        {
+            for (const record& r : _records) {
+                wsc.emplace_back_with(NO_GAP, [&](weighted_string<Container>& positions) {
+                    _table.append(positions, _text.data() + r.bases, _text.data() + r.qualities, r.size);
+                });
+            }
+        }
+};
+
+//! Read all reads of a FASTQ file into a collection of weighted strings
+/*!
+  * \tparam WStringCollection   A collection of weighted_string<Container> or a flat_ws_collection<Container>
+  * \param names                If not null, the names of the reads are written in it
+  * \param threads              Number of threads decoding the reads (0 to use one thread per core)
+  * \param table                The weighted chars of bases and qualities
+  *
+  * \throw std::runtime_error if the file cannot be opened
+  * \throw ws_parse_error if a record is not valid
+  *
+  * \sa wstr::fastq_reader
+ */
+template <
+    class WStringCollection,
+    class Container = std::decay_t<decltype(std::declval<typename WStringCollection::value_type::w_char>().probabilities())>
+>
+void load_fastq(const std::string& path, WStringCollection& wsc, std::vector<std::string>* names = nullptr, size_t threads = 1,
+                phred_table<Container> table = phred_table<Container>())
+{
+    fastq_reader<Container> reader(path, std::move(table));
+
+    wsc.clear();
+
+    if (nullptr != names) {
+        names->clear();
+    }
+
+    while (reader.read(wsc, 1 << 16, names, threads)) {
+
+    }
+}
+
+}
\ No newline at end of file
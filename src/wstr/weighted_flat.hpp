@@ -0,0 +1,336 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include "weighted_reader.hpp"
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+//! Collection of weighted strings which stores all positions in one contiguous arena
+/*!
+  * \tparam Container   Container of the weighted chars
+  *
+  * The positions of all weighted strings are stored one after the other in a single weighted string, with
+  * the offset of each weighted string and its gap. Iterating over many short weighted strings then reads
+  * memory sequentially instead of following one pointer per weighted string, and reading a file does not
+  * allocate one vector per weighted string.
+  *
+  * Weighted strings are accessed as weighted_string_view, which are valid until the collection is modified.
+  * The collection can be moved but not copied.
+  *
+  * It is read with the same >> operator, parse_ws and load_ws as other collections.
+  *
+  * \sa wstr::weighted_string_view
+  * \sa wstr::mapped_ws_collection
+ */
+template <class Container>
+class flat_ws_collection
+{
+    public:
+
+        typedef weighted_char<Container> w_char;
+        typedef weighted_string_view<Container> value_type;
+
+        //! Iterator on the weighted strings, which are given as views
+        class const_iterator
+        {
+            private:
+
+                const flat_ws_collection* _wsc = nullptr;
+                size_t _i = 0;
+
+            public:
+
+                typedef std::input_iterator_tag iterator_category;
+                typedef weighted_string_view<Container> value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const value_type* pointer;
+                typedef value_type reference;
+
+                const_iterator()
+                {
+
+                }
+
+                const_iterator(const flat_ws_collection* wsc, size_t i) : _wsc(wsc), _i(i)
+                {
+
+                }
+
+                value_type operator*() const
+                {
+                    return (*_wsc)[_i];
+                }
+
+                const_iterator& operator++()
+                {
+                    ++_i;
+                    return *this;
+                }
+
+                const_iterator operator++(int)
+                {
+                    const_iterator it = *this;
+                    ++_i;
+                    return it;
+                }
+
+                difference_type operator-(const const_iterator& oth) const
+                {
+                    return static_cast<difference_type>(_i) - static_cast<difference_type>(oth._i);
+                }
+
+                bool operator==(const const_iterator& oth) const
+                {
+                    return _i == oth._i;
+                }
+
+                bool operator!=(const const_iterator& oth) const
+                {
+                    return _i != oth._i;
+                }
+        };
+
+        typedef const_iterator iterator;
+
+    private:
+
+        weighted_string<Container> _positions;
+        std::vector<size_t> _offsets = {0};
+        std::string _gaps;
+
+    public:
+
+        flat_ws_collection()
+        {
+
+        }
+
+        flat_ws_collection(const flat_ws_collection&) = delete;
+        flat_ws_collection& operator=(const flat_ws_collection&) = delete;
+
+        //! Move the weighted strings, the moved-from collection is empty and can be used again
+        flat_ws_collection(flat_ws_collection&& oth)
+            : _positions(std::move(oth._positions)), _offsets(std::move(oth._offsets)), _gaps(std::move(oth._gaps))
+        {
+            oth.clear();
+        }
+
+        flat_ws_collection& operator=(flat_ws_collection&& oth)
+        {
+            if (this != &oth) {
+                _positions = std::move(oth._positions);
+                _offsets = std::move(oth._offsets);
+                _gaps = std::move(oth._gaps);
+                oth.clear();
+            }
+
+            return *this;
+        }
+
+        //! Number of weighted strings
+        size_t size() const
+        {
+            return _gaps.size();
+        }
+
+        bool empty() const
+        {
+            return _gaps.empty();
+        }
+
+        //! Total number of positions of all weighted strings
+        size_t positions() const
+        {
+            return _positions.size();
+        }
+
+        //! All positions of all weighted strings
+        const w_char* data() const
+        {
+            return _positions.data();
+        }
+
+        //! Position in data() of the first position of the i-th weighted string (i can be size())
+        size_t offset(size_t i) const
+        {
+            return _offsets[i];
+        }
+
+        value_type operator[](size_t i) const
+        {
+            return value_type(_positions.data() + _offsets[i], _offsets[i + 1] - _offsets[i], _gaps[i]);
+        }
+
+        //! Access with bound checking
+        /*!
+          * \throw std::out_of_range if i is not lower than size()
+         */
+        value_type at(size_t i) const
+        {
+            if (i >= size()) {
+                throw std::out_of_range("There is no such weighted string in the collection");
+            }
+
+            return operator[](i);
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(this, 0);
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, size());
+        }
+
+        //! Reserve memory for a number of weighted strings and a total number of positions
+        void reserve(size_t strings, size_t positions)
+        {
+            _offsets.reserve(strings + 1);
+            _gaps.reserve(strings);
+            _positions.reserve(positions);
+        }
+
+        void clear()
+        {
+            _positions.clear();
+            _offsets.assign(1, 0);
+            _gaps.clear();
+        }
+
+        //! Append a weighted string made of n weighted chars (which should not belong to this collection)
+        void append(const w_char* first, size_t n, char gap = NO_GAP)
+        {
+            _positions.insert(_positions.end(), first, first + n);
+            _close(gap);
+        }
+
+        //! Append a weighted string (or a view, which should not be on this collection)
+        template <class WString>
+        void push_back(const WString& ws)
+        {
+            _positions.insert(_positions.end(), ws.begin(), ws.end());
+            _close(ws.gap());
+        }
+
+        //! Append all weighted strings of a collection, with a single allocation
+        template <class WStringCollection>
+        void append(const WStringCollection& wsc)
+        {
+            size_t positions = 0;
+
+            for (const auto& ws : wsc) {
+                positions += ws.size();
+            }
+
+            reserve(size() + std::distance(std::begin(wsc), std::end(wsc)), _positions.size() + positions);
+
+            for (const auto& ws : wsc) {
+                push_back(ws);
+            }
+        }
+
+        //! Append a weighted string whose positions are appended by `read(weighted_string<Container>&)`
+        /*!
+          * Used by readers to fill the arena directly. If read throws, the positions it appended are removed.
+         */
+        template <class F>
+        void emplace_back_with(char gap, F read)
+        {
+            try {
+                read(_positions);
+            }
+            catch (...) {
+                _positions.erase(_positions.begin() + _offsets.back(), _positions.end());
+                throw;
+            }
+
+            _close(gap);
+        }
+
+        //! >> operator to read a collection of weighted strings from a file, with the options of the stream
+        /*!
+          * If the input is truncated, the stream fails and the collection keeps the weighted strings read entirely.
+         */
+        friend std::istream& operator>>(std::istream& in, flat_ws_collection& wsc)
+        {
+            size_t l, n;
+            std::string alph;
+
+            wsc.clear();
+
+            if (!(in >> l >> alph)) {
+                return in;
+            }
+
+            ws_options options = ws_get_options(in);
+            char gap = options.gap ? alph.back() : NO_GAP;
+
+            for (size_t _ = 0; _ < l && in >> n; ++_) {
+                wsc.emplace_back_with(gap, [&](weighted_string<Container>& positions) {
+                    construct_ws_from_file<Container>(in, positions, n, alph, options);
+                });
+
+                if (!in) {
+                    wsc._pop_back();
+                }
+            }
+
+            return in;
+        }
+
+        //! Same as parse_ws for collections, with the buffer reader
+        /*!
+          * \throw ws_parse_error on error, with the line of the error
+         */
+        friend void parse_ws(const char* first, const char* last, flat_ws_collection& wsc, const ws_options& options = ws_options())
+        {
+            ws_buffer_reader reader(first, last);
+
+            size_t l = reader.read_size();
+            std::string alph = reader.read_word();
+            char gap = options.gap ? alph.back() : NO_GAP;
+
+            wsc.clear();
+
+            // Each position is on its own line, so the number of lines bounds the number of positions,
+            // and each weighted string takes at least one character, which bounds a corrupt count of strings
+            wsc.reserve(std::min<size_t>(l, last - first), std::count(first, last, '\n'));
+
+            for (size_t _ = 0; _ < l; ++_) {
+                size_t n = reader.read_size();
+
+                wsc.emplace_back_with(gap, [&](weighted_string<Container>& positions) {
+                    reader.read_positions(positions, n, alph, options.strict, options.precision);
+                });
+            }
+        }
+
+    private:
+
+        //! End the current weighted string
+        void _close(char gap)
+        {
+            _offsets.push_back(_positions.size());
+            _gaps.push_back(gap);
+        }
+
+        //! Remove the last weighted string
+        void _pop_back()
+        {
+            _offsets.pop_back();
+            _gaps.pop_back();
+            _positions.erase(_positions.begin() + _offsets.back(), _positions.end());
+        }
+};
+
+}
\ No newline at end of file
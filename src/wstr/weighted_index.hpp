@@ -0,0 +1,960 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <istream>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm>
+
+#include "weighted_string.hpp"
+
+namespace wstr
+{
+
+//! Index of a weighted string answering threshold pattern queries, built from a z-estimation
+/*!
+  * A solid pattern P occurs at position i of a weighted string X of length n with probability
+  * p(P, i) = X[i].p(P[0]) * ... * X[i + |P| - 1].p(P[|P| - 1]).
+  * The index reports all positions i such that p(P, i) >= 1/z.
+  *
+  * Construction: the index computes k = ⌊z⌋ strings S_1, ..., S_k of length n (a z-estimation of X) such that
+  * every pattern occurring at position i of X with probability >= 1/z occurs at position i of at least one S_j.
+  * The strings are built from left to right. At position i, the suffixes of S_1[0..i-1], ..., S_k[0..i-1] which
+  * occur with probability >= 1/z form a trie. For each node v of this trie (of probability p(v)) and each letter c
+  * of X[i], at least ⌊z * p(v) * X[i].p(c)⌋ strings going through v get the letter c. Since the probabilities of
+  * the children of a node sum to at most the probability of the node, these requirements are always satisfiable
+  * with ⌊z * p(v)⌋ strings, and every node with probability >= 1/z keeps at least one string.
+  * The construction takes O(n * k * σ) time where σ is the number of letters of a position.
+  *
+  * Queries: the strings are concatenated (separated by a null character) in a text of size N = k * (n + 1),
+  * indexed with a suffix array and the LCP-LR arrays of the binary search. A pattern is located in the suffix
+  * array in O(|P| + log N). Each suffix stores its heavy length: the length of its longest prefix of probability
+  * >= 1/z. The suffixes of the interval whose heavy length is at least |P| are the occurrences, and they are
+  * found with range maximum queries on the heavy lengths without visiting the other suffixes of the interval.
+  * A position found in several strings has the same letters, and so the same probability, in all of them.
+  * Only the first of these suffixes in the suffix array is reported: the LCP with the previous suffix starting
+  * at the same position is stored for each rank, and a suffix whose heavy length is not longer than this LCP is
+  * never reported, so its heavy length is stored as 0. The other suffixes of a position are visited only if they
+  * have a heavy extension which the previous ones do not have, so a query takes O(|P| + log N + ⌊z⌋ * occ).
+  * Positions are reported in no particular order.
+  *
+  * Memory: the index stores the text (1 byte), the suffix array (8 bytes), the LCP-LR arrays (2 * 4 bytes), the
+  * LCP with the previous suffix of the same position (4 bytes) and the heavy length (4 bytes) for each of the
+  * N characters, plus a table of range maxima on blocks of 64 characters, so about 25 * ⌊z⌋ * (n + 1) bytes.
+  * The construction needs the prefix sums of the log-probabilities and 3 more arrays of 8 bytes per character
+  * for the suffix array and the LCP.
+  *
+  * The index can be saved to and loaded from a binary stream so it is built only once.
+  *
+  * \sa wstr::weighted_pattern_matcher
+ */
+class weighted_index
+{
+    public:
+
+        //! Version of the binary format written by save
+        static constexpr uint32_t format_version = 3;
+
+    private:
+
+        static constexpr char _separator = '\0';
+
+        //! Number of ranks of a block of the range maximum queries
+        static constexpr size_t _block = 64;
+
+        double _z = 1.;
+        size_t _n = 0;
+        size_t _k = 0;
+
+        std::string _text;
+        std::vector<size_t> _sa;
+        std::vector<uint32_t> _llcp;
+        std::vector<uint32_t> _rlcp;
+
+        //! _column_lcp[r] is the LCP of _sa[r] with the previous suffix in _sa starting at the same position of a string
+        std::vector<uint32_t> _column_lcp;
+
+        //! _heavy[r] is the length of the longest prefix of _sa[r] with probability >= 1/z, 0 if it is not above _column_lcp[r]
+        std::vector<uint32_t> _heavy;
+
+        //! Offset of the maximum of _heavy in each block, and block of the maximum of 2^l blocks at level l
+        std::vector<uint8_t> _block_max;
+        std::vector<std::vector<uint32_t>> _blocks_max;
+
+        //! Prefix sums of the log-probabilities of the strings, only during the construction
+        std::vector<double> _log_prefix;
+
+    public:
+
+        //! Empty index, to be filled by load
+        weighted_index()
+        {
+
+        }
+
+        //! Build the index of a weighted string for a given threshold
+        /*!
+          * \tparam WString     The weighted string type, its Container must have a `for_each` method
+          * \param ws           The weighted string to index
+          * \param z            Occurrences must have a probability greater or equal to 1/z
+          *
+          * \throw std::invalid_argument if z is lower than 1
+         */
+        template <class WString>
+        weighted_index(const WString& ws, double z) : _z(z), _n(ws.size())
+        {
+            if (!(z >= 1.)) {
+                throw std::invalid_argument("The threshold z must be greater or equal to 1");
+            }
+
+            _k = static_cast<size_t>(std::floor(z));
+
+            _build_estimation(ws);
+            _build_suffix_array();
+            _build_heavy();
+            _build_range_max();
+        }
+
+        double z() const
+        {
+            return _z;
+        }
+
+        //! Length of the indexed weighted string
+        size_t size() const
+        {
+            return _n;
+        }
+
+        //! Number of strings of the z-estimation
+        size_t strings() const
+        {
+            return _k;
+        }
+
+        //! Return the j-th string of the z-estimation (null characters are positions where all probabilities are 0)
+        std::string estimation(size_t j) const
+        {
+            return _text.substr(j * (_n + 1), _n);
+        }
+
+        //! Number of bytes used by the index
+        size_t memory() const
+        {
+            size_t table = 0;
+
+            for (const auto& level : _blocks_max) {
+                table += level.size() * sizeof(uint32_t);
+            }
+
+            return _text.size() + _sa.size() * sizeof(size_t) + _block_max.size() + table
+                + (_llcp.size() + _rlcp.size() + _column_lcp.size() + _heavy.size()) * sizeof(uint32_t);
+        }
+
+        //! Return all positions where the pattern occurs with probability >= 1/z, in no particular order
+        /*!
+          * An empty pattern has no occurrence. Each position is reported once, sort the result to get increasing
+          * positions.
+         */
+        std::vector<size_t> find(const std::string& pattern) const
+        {
+            std::vector<size_t> occ;
+            size_t m = pattern.size();
+
+            if (0 == m || m > _n || std::string::npos != pattern.find(_separator)) {
+                return occ;
+            }
+
+            size_t first = _bound(pattern, false);
+            size_t last = _bound(pattern, true);
+
+            // Ranges of ranks which may contain suffixes of heavy length >= m
+            std::vector<std::pair<size_t, size_t>> ranges;
+
+            if (first < last) {
+                ranges.emplace_back(first, last);
+            }
+
+            while (!ranges.empty()) {
+                auto [a, b] = ranges.back();
+                ranges.pop_back();
+
+                size_t r = _max_heavy(a, b);
+
+                if (_heavy[r] < m) {
+                    continue;
+                }
+
+                // Otherwise the same window was already seen in another string
+                if (_column_lcp[r] < m) {
+                    occ.push_back(_sa[r] % (_n + 1));
+                }
+
+                if (a < r) {
+                    ranges.emplace_back(a, r);
+                }
+                if (r + 1 < b) {
+                    ranges.emplace_back(r + 1, b);
+                }
+            }
+
+            return occ;
+        }
+
+        //! Check if the pattern occurs somewhere with probability >= 1/z
+        bool contains(const std::string& pattern) const
+        {
+            return !find(pattern).empty();
+        }
+
+        //! Write the index in a binary stream
+        void save(std::ostream& out) const
+        {
+            out.write(_magic, sizeof(_magic));
+            _write(out, format_version);
+            _write(out, _z);
+            _write(out, static_cast<uint64_t>(_n));
+            _write(out, static_cast<uint64_t>(_k));
+
+            out.write(_text.data(), _text.size());
+            _write_vector(out, _sa);
+            _write_vector(out, _llcp);
+            _write_vector(out, _rlcp);
+            _write_vector(out, _column_lcp);
+            _write_vector(out, _heavy);
+        }
+
+        //! Read an index written by save
+        /*!
+          * Arrays are read by chunks, so a truncated or corrupted stream fails before allocating the size written in it.
+          *
+          * \throw std::runtime_error if the stream does not contain a valid index of the same version
+         */
+        static weighted_index load(std::istream& in)
+        {
+            char magic[sizeof(_magic)];
+            in.read(magic, sizeof(magic));
+
+            if (!in || !std::equal(magic, magic + sizeof(magic), _magic)) {
+                throw std::runtime_error("The stream does not contain a weighted index");
+            }
+
+            if (format_version != _read<uint32_t>(in)) {
+                throw std::runtime_error("Unsupported version of weighted index");
+            }
+
+            weighted_index index;
+            index._z = _read<double>(in);
+            _check_header(in);
+
+            uint64_t n = _read<uint64_t>(in);
+            _check_header(in);
+
+            uint64_t k = _read<uint64_t>(in);
+            _check_header(in);
+
+            if (!(index._z >= 1.) || !std::isfinite(index._z) || k != static_cast<uint64_t>(std::floor(index._z))) {
+                throw std::runtime_error("The weighted index is corrupted");
+            }
+
+            // Each character takes about 25 bytes, the sizes must fit in memory
+            constexpr uint64_t max_total = std::numeric_limits<size_t>::max() / 32;
+
+            if (n >= max_total || (k > 0 && n + 1 > max_total / k)) {
+                throw std::runtime_error("The weighted index is corrupted");
+            }
+
+            index._n = static_cast<size_t>(n);
+            index._k = static_cast<size_t>(k);
+
+            size_t total = index._k * (index._n + 1);
+
+            _read_vector(in, index._text, total);
+            _read_vector(in, index._sa, total);
+            _read_vector(in, index._llcp, total);
+            _read_vector(in, index._rlcp, total);
+            _read_vector(in, index._column_lcp, total);
+            _read_vector(in, index._heavy, total);
+
+            if (!in) {
+                throw std::runtime_error("The weighted index is truncated");
+            }
+
+            for (size_t t : index._sa) {
+                if (t >= total) {
+                    throw std::runtime_error("The weighted index is corrupted");
+                }
+            }
+
+            index._build_range_max();
+
+            return index;
+        }
+
+    private:
+
+        static constexpr char _magic[8] = {'W', 'S', 'T', 'R', 'I', 'D', 'X', '\0'};
+
+        //! An interval of strings sharing a heavy suffix, while the requirements of the trie are computed
+        struct _node
+        {
+            size_t lcp;         // depth of the deepest trie node of the interval
+            size_t rep;         // one string of the interval
+            size_t free_begin;  // first free string of the interval in the free stack
+        };
+
+        /*!
+          * Construction of the z-estimation
+         */
+
+        template <class WString>
+        void _build_estimation(const WString& ws)
+        {
+            size_t stride = _n + 1;
+            double threshold = -std::log(_z) - log_epsilon;
+
+            _text.assign(_k * stride, _separator);
+            _log_prefix.assign(_k * stride, 0.);
+
+            // Strings sorted by their reversed prefix, and longest common suffixes between neighbours
+            std::vector<size_t> order(_k);
+            std::vector<size_t> lcs(_k + 1, 0);
+            std::vector<size_t> start(_k, 0);
+
+            for (size_t j = 0; j < _k; ++j) {
+                order[j] = j;
+            }
+
+            std::vector<char> letters;
+            std::vector<double> probas;
+            std::vector<size_t> next(_k);
+            std::vector<size_t> letter_of(_k);
+            std::vector<_node> stack;
+            std::vector<size_t> assigned;
+            std::vector<size_t> free;
+
+            for (size_t i = 0; i < _n; ++i) {
+                letters.clear();
+                probas.clear();
+
+                ws[i].for_each([&letters, &probas](char c, double p) {
+                    if (p > 0.) {
+                        letters.push_back(c);
+                        probas.push_back(p);
+                    }
+                });
+
+                size_t sigma = letters.size();
+
+                // Letter given to the strings without requirement, sigma for positions where all probabilities are 0
+                size_t heaviest = sigma;
+                for (size_t c = 0; c < sigma; ++c) {
+                    if (heaviest == sigma || probas[c] > probas[heaviest]) {
+                        heaviest = c;
+                    }
+                }
+
+                std::fill(letter_of.begin(), letter_of.end(), heaviest);
+
+                _assign_letters(i, probas, order, lcs, start, letter_of, stack, assigned, free);
+
+                // Append letters and update prefix sums and heavy suffixes
+                for (size_t j = 0; j < _k; ++j) {
+                    double* w = _log_prefix.data() + j * stride;
+                    size_t c = letter_of[j];
+
+                    if (c == sigma) {
+                        w[i + 1] = w[i];
+                        start[j] = i + 1;
+                        continue;
+                    }
+
+                    _text[j * stride + i] = letters[c];
+                    w[i + 1] = w[i] + std::log(probas[c]);
+
+                    while (start[j] <= i && w[i + 1] - w[start[j]] < threshold) {
+                        ++start[j];
+                    }
+                }
+
+                _sort_by_letter(i, sigma, order, lcs, start, letter_of, next);
+            }
+        }
+
+        //! Depth of the heavy suffix of a string before position i
+        static size_t _depth(size_t i, const std::vector<size_t>& start, size_t j)
+        {
+            return i - start[j];
+        }
+
+        //! Probability of the suffix of length d of the j-th string before position i
+        double _suffix_proba(size_t i, size_t j, size_t d) const
+        {
+            const double* w = _log_prefix.data() + j * (_n + 1);
+            return std::exp(w[i] - w[i - d]);
+        }
+
+        //! Give letters of position i to strings so that each heavy trie node has enough strings for each letter
+        /*!
+          * The trie is traversed bottom-up as the lcp-intervals of the strings sorted by reversed prefix.
+          * Strings which are not needed by a node are kept in a free stack and given to the first ancestor which needs them.
+         */
+        void _assign_letters(
+            size_t i,
+            const std::vector<double>& probas,
+            const std::vector<size_t>& order,
+            const std::vector<size_t>& lcs,
+            const std::vector<size_t>& start,
+            std::vector<size_t>& letter_of,
+            std::vector<_node>& stack,
+            std::vector<size_t>& assigned,
+            std::vector<size_t>& free
+        ) {
+            size_t sigma = probas.size();
+
+            // Capped longest common suffix between order[r - 1] and order[r] (0 on both ends)
+            auto common = [&](size_t r) -> size_t {
+                if (0 == r || _k == r) {
+                    return 0;
+                }
+                return std::min({lcs[r], _depth(i, start, order[r - 1]), _depth(i, start, order[r])});
+            };
+
+            // Give letters to free strings of the interval until each letter has its requirement
+            auto close = [&](size_t* count, size_t free_begin, double proba) {
+                for (size_t c = 0; c < sigma; ++c) {
+                    double required = std::floor(_z * proba * probas[c] + log_epsilon);
+
+                    while (static_cast<double>(count[c]) < required && free.size() > free_begin) {
+                        letter_of[free.back()] = c;
+                        free.pop_back();
+                        ++count[c];
+                    }
+                }
+            };
+
+            // Counts of assigned letters: one block of sigma values per stack entry, and one for the current interval
+            assigned.assign((_k + 2) * sigma, 0);
+            size_t* current = assigned.data() + (_k + 1) * sigma;
+            auto counts = [&](size_t e) { return assigned.data() + e * sigma; };
+
+            stack.clear();
+            free.clear();
+
+            stack.push_back({0, order[0], 0});
+
+            for (size_t r = 0; r < _k; ++r) {
+                size_t j = order[r];
+                size_t parent_depth = std::max(common(r), common(r + 1));
+                _node node = {_depth(i, start, j), j, free.size()};
+
+                std::fill(current, current + sigma, 0);
+                free.push_back(j);
+
+                // The string has its own trie nodes below its parent
+                if (node.lcp > parent_depth) {
+                    close(current, node.free_begin, _suffix_proba(i, j, parent_depth + 1));
+                }
+
+                // Close the intervals which end with this string
+                size_t boundary = common(r + 1);
+
+                while (boundary < stack.back().lcp) {
+                    _node top = stack.back();
+                    size_t* top_counts = counts(stack.size() - 1);
+                    stack.pop_back();
+
+                    for (size_t c = 0; c < sigma; ++c) {
+                        top_counts[c] += current[c];
+                    }
+                    top.free_begin = std::min(top.free_begin, node.free_begin);
+
+                    size_t top_depth = std::max(boundary, stack.back().lcp) + 1;
+                    close(top_counts, top.free_begin, _suffix_proba(i, top.rep, top_depth));
+
+                    std::copy(top_counts, top_counts + sigma, current);
+                    node = top;
+                }
+
+                if (boundary > stack.back().lcp) {
+                    node.lcp = boundary;
+                    std::copy(current, current + sigma, counts(stack.size()));
+                    stack.push_back(node);
+                }
+                else {
+                    size_t* parent_counts = counts(stack.size() - 1);
+
+                    for (size_t c = 0; c < sigma; ++c) {
+                        parent_counts[c] += current[c];
+                    }
+                    stack.back().free_begin = std::min(stack.back().free_begin, node.free_begin);
+                }
+            }
+
+            // The root is the empty suffix of probability 1
+            close(counts(0), 0, 1.);
+        }
+
+        //! Stable sort of the strings by their new letter and update of the longest common suffixes
+        void _sort_by_letter(
+            size_t i,
+            size_t sigma,
+            std::vector<size_t>& order,
+            std::vector<size_t>& lcs,
+            const std::vector<size_t>& start,
+            const std::vector<size_t>& letter_of,
+            std::vector<size_t>& next
+        ) {
+            std::vector<size_t> count(sigma + 2, 0);
+            std::vector<size_t> run(sigma + 1, 0);
+            std::vector<bool> seen(sigma + 1, false);
+            std::vector<size_t> next_lcs(_k + 1, 0);
+
+            for (size_t j = 0; j < _k; ++j) {
+                ++count[letter_of[j] + 1];
+            }
+            for (size_t c = 1; c < count.size(); ++c) {
+                count[c] += count[c - 1];
+            }
+
+            for (size_t r = 0; r < _k; ++r) {
+                size_t j = order[r];
+                size_t c = letter_of[j];
+
+                if (r > 0) {
+                    for (size_t d = 0; d <= sigma; ++d) {
+                        run[d] = std::min(run[d], lcs[r]);
+                    }
+                }
+
+                size_t p = count[c]++;
+                next[p] = j;
+
+                // The common suffix with the previous string of the same letter
+                if (seen[c] && c != sigma) {
+                    next_lcs[p] = std::min(run[c] + 1, _depth(i + 1, start, j));
+                }
+
+                seen[c] = true;
+                run[c] = std::numeric_limits<size_t>::max();
+            }
+
+            order.swap(next);
+            lcs.swap(next_lcs);
+        }
+
+        /*!
+          * Suffix array, LCP and LCP-LR
+         */
+
+        void _build_suffix_array()
+        {
+            size_t total = _text.size();
+
+            _sa.resize(total);
+            _llcp.assign(total, 0);
+            _rlcp.assign(total, 0);
+            _column_lcp.assign(total, 0);
+
+            if (0 == total) {
+                return;
+            }
+
+            // Prefix doubling with radix sort on the ranks of the two halves
+            std::vector<size_t> rank(total);
+            std::vector<size_t> tmp(total);
+            std::vector<size_t> count(std::max<size_t>(total, 256) + 1);
+
+            for (size_t t = 0; t < total; ++t) {
+                _sa[t] = t;
+                rank[t] = static_cast<unsigned char>(_text[t]);
+            }
+
+            std::sort(_sa.begin(), _sa.end(), [this](size_t a, size_t b) {
+                return static_cast<unsigned char>(_text[a]) < static_cast<unsigned char>(_text[b]);
+            });
+
+            for (size_t h = 1; ; h <<= 1) {
+                // Second key: rank of t + h (suffixes shorter than h come first)
+                size_t p = 0;
+                for (size_t t = total - std::min(h, total); t < total; ++t) {
+                    tmp[p++] = t;
+                }
+                for (size_t r = 0; r < total; ++r) {
+                    if (_sa[r] >= h) {
+                        tmp[p++] = _sa[r] - h;
+                    }
+                }
+
+                // First key: rank of t (counting sort, stable)
+                size_t max_rank = *std::max_element(rank.begin(), rank.end());
+                std::fill(count.begin(), count.begin() + max_rank + 2, 0);
+
+                for (size_t t = 0; t < total; ++t) {
+                    ++count[rank[t] + 1];
+                }
+                for (size_t c = 1; c <= max_rank + 1; ++c) {
+                    count[c] += count[c - 1];
+                }
+                for (size_t r = 0; r < total; ++r) {
+                    _sa[count[rank[tmp[r]]]++] = tmp[r];
+                }
+
+                // New ranks
+                auto second = [&](size_t t) -> size_t {
+                    return t + h < total ? rank[t + h] + 1 : 0;
+                };
+
+                tmp[_sa[0]] = 0;
+                for (size_t r = 1; r < total; ++r) {
+                    size_t a = _sa[r - 1], b = _sa[r];
+                    tmp[b] = tmp[a] + (rank[a] != rank[b] || second(a) != second(b));
+                }
+
+                rank.swap(tmp);
+
+                if (rank[_sa[total - 1]] == total - 1 || h >= total) {
+                    break;
+                }
+            }
+
+            // LCP with Kasai's algorithm (lcp[r] between _sa[r - 1] and _sa[r])
+            std::vector<size_t>& lcp = tmp;
+            lcp[0] = 0;
+
+            for (size_t t = 0, l = 0; t < total; ++t) {
+                if (0 == rank[t]) {
+                    l = 0;
+                    continue;
+                }
+
+                size_t u = _sa[rank[t] - 1];
+
+                while (t + l < total && u + l < total && _text[t + l] == _text[u + l]) {
+                    ++l;
+                }
+
+                lcp[rank[t]] = l;
+
+                if (l > 0) {
+                    --l;
+                }
+            }
+
+            if (total > 1) {
+                _build_lcp_lr(lcp, 0, total - 1);
+            }
+
+            _build_column_lcp(lcp);
+        }
+
+        //! Fill _column_lcp with range minima of the LCP array, using a stack of increasing LCP values
+        void _build_column_lcp(const std::vector<size_t>& lcp)
+        {
+            size_t stride = _n + 1;
+            std::vector<size_t> previous(stride, _sa.size());
+            std::vector<std::pair<size_t, size_t>> minima;  // (rank, lcp) with increasing ranks and LCP values
+
+            for (size_t r = 0; r < _sa.size(); ++r) {
+                while (!minima.empty() && minima.back().second >= lcp[r]) {
+                    minima.pop_back();
+                }
+                minima.emplace_back(r, lcp[r]);
+
+                size_t i = _sa[r] % stride;
+
+                if (previous[i] < r) {
+                    // Minimum of lcp(previous[i], r]: first entry of the stack after previous[i]
+                    auto first = std::upper_bound(minima.begin(), minima.end(), previous[i], [](size_t p, const auto& e) {
+                        return p < e.first;
+                    });
+                    _column_lcp[r] = _cap(first->second);
+                }
+
+                previous[i] = r;
+            }
+        }
+
+        //! Fill _heavy from the prefix sums of the strings, which are released
+        /*!
+          * Probabilities are at most 1, so the prefixes of a window of probability >= 1/z have a probability
+          * >= 1/z, and the end of the longest heavy window only moves forward from one position to the next.
+         */
+        void _build_heavy()
+        {
+            size_t stride = _n + 1;
+            double threshold = -std::log(_z) - log_epsilon;
+            std::vector<uint32_t> length(_text.size(), 0);
+
+            for (size_t j = 0; j < _k; ++j) {
+                const double* w = _log_prefix.data() + j * stride;
+
+                for (size_t i = 0, end = 0; i < _n; ++i) {
+                    end = std::max(end, i);
+
+                    while (end < _n && w[end + 1] - w[i] >= threshold) {
+                        ++end;
+                    }
+
+                    length[j * stride + i] = _cap(end - i);
+                }
+            }
+
+            _heavy.resize(_sa.size());
+
+            for (size_t r = 0; r < _sa.size(); ++r) {
+                _heavy[r] = length[_sa[r]] > _column_lcp[r] ? length[_sa[r]] : 0;
+            }
+
+            std::vector<double>().swap(_log_prefix);
+        }
+
+        //! Fill the offset of the maximum of each block and the sparse table of the blocks
+        void _build_range_max()
+        {
+            size_t blocks = (_heavy.size() + _block - 1) / _block;
+
+            _block_max.assign(blocks, 0);
+            _blocks_max.clear();
+
+            if (0 == blocks) {
+                return;
+            }
+
+            _blocks_max.emplace_back(blocks);
+
+            for (size_t b = 0; b < blocks; ++b) {
+                size_t best = b * _block;
+
+                for (size_t r = best + 1; r < std::min(_heavy.size(), (b + 1) * _block); ++r) {
+                    if (_heavy[r] > _heavy[best]) {
+                        best = r;
+                    }
+                }
+
+                _block_max[b] = static_cast<uint8_t>(best - b * _block);
+                _blocks_max[0][b] = static_cast<uint32_t>(b);
+            }
+
+            for (size_t l = 1; (size_t(1) << l) <= blocks; ++l) {
+                const std::vector<uint32_t>& below = _blocks_max[l - 1];
+                std::vector<uint32_t> level(blocks - (size_t(1) << l) + 1);
+
+                for (size_t b = 0; b < level.size(); ++b) {
+                    uint32_t x = below[b], y = below[b + (size_t(1) << (l - 1))];
+                    level[b] = _heavy[_block_rank(x)] >= _heavy[_block_rank(y)] ? x : y;
+                }
+
+                _blocks_max.push_back(std::move(level));
+            }
+        }
+
+        //! Rank of the maximum of _heavy in a block
+        size_t _block_rank(size_t b) const
+        {
+            return b * _block + _block_max[b];
+        }
+
+        //! Rank of a maximum of _heavy in [a, b), which should not be empty
+        size_t _max_heavy(size_t a, size_t b) const
+        {
+            size_t best = a;
+
+            auto take = [this, &best](size_t r) {
+                if (_heavy[r] > _heavy[best]) {
+                    best = r;
+                }
+            };
+
+            // Whole blocks in [first_block, last_block), partial blocks on both sides
+            size_t first_block = (a + _block - 1) / _block;
+            size_t last_block = b / _block;
+
+            if (first_block >= last_block) {
+                for (size_t r = a; r < b; ++r) {
+                    take(r);
+                }
+
+                return best;
+            }
+
+            for (size_t r = a; r < first_block * _block; ++r) {
+                take(r);
+            }
+            for (size_t r = last_block * _block; r < b; ++r) {
+                take(r);
+            }
+
+            size_t l = 0;
+
+            while ((size_t(2) << l) <= last_block - first_block) {
+                ++l;
+            }
+
+            take(_block_rank(_blocks_max[l][first_block]));
+            take(_block_rank(_blocks_max[l][last_block - (size_t(1) << l)]));
+
+            return best;
+        }
+
+        //! Fill LCP-LR for the binary search interval (l, r) and return the lcp of _sa[l] and _sa[r]
+        size_t _build_lcp_lr(const std::vector<size_t>& lcp, size_t l, size_t r)
+        {
+            if (r - l <= 1) {
+                return lcp[r];
+            }
+
+            size_t m = l + (r - l) / 2;
+            size_t left = _build_lcp_lr(lcp, l, m);
+            size_t right = _build_lcp_lr(lcp, m, r);
+
+            _llcp[m] = _cap(left);
+            _rlcp[m] = _cap(right);
+
+            return std::min(left, right);
+        }
+
+        static uint32_t _cap(size_t v)
+        {
+            return static_cast<uint32_t>(std::min<size_t>(v, std::numeric_limits<uint32_t>::max()));
+        }
+
+        //! Length of the common prefix of the pattern (from offset l) and the suffix at t (from offset l)
+        size_t _extend(const std::string& pattern, size_t t, size_t l) const
+        {
+            while (l < pattern.size() && t + l < _text.size() && pattern[l] == _text[t + l]) {
+                ++l;
+            }
+            return l;
+        }
+
+        //! True if the suffix at t goes before the searched bound, knowing they share l characters
+        bool _before(const std::string& pattern, size_t t, size_t l, bool upper) const
+        {
+            if (l == pattern.size()) {
+                return upper;
+            }
+            if (t + l == _text.size()) {
+                return true;
+            }
+            return static_cast<unsigned char>(_text[t + l]) < static_cast<unsigned char>(pattern[l]);
+        }
+
+        //! First rank of the suffix array whose suffix is not before the pattern
+        /*!
+          * With upper = false, it is the first suffix >= pattern.
+          * With upper = true, it is the first suffix which is greater than pattern and does not start with it.
+         */
+        size_t _bound(const std::string& pattern, bool upper) const
+        {
+            size_t total = _sa.size();
+
+            size_t l = _extend(pattern, _sa[0], 0);
+            if (!_before(pattern, _sa[0], l, upper)) {
+                return 0;
+            }
+
+            size_t r = _extend(pattern, _sa[total - 1], 0);
+            if (_before(pattern, _sa[total - 1], r, upper)) {
+                return total;
+            }
+
+            // Invariant: suffix L is before and suffix R is not, l and r are their lcp with the pattern
+            size_t left = 0, right = total - 1;
+
+            while (right - left > 1) {
+                size_t m = left + (right - left) / 2;
+                size_t k;
+
+                if (l >= r) {
+                    if (_llcp[m] > l) {
+                        left = m;
+                        continue;
+                    }
+                    if (_llcp[m] < l) {
+                        right = m;
+                        r = _llcp[m];
+                        continue;
+                    }
+                    k = _extend(pattern, _sa[m], l);
+                }
+                else {
+                    if (_rlcp[m] > r) {
+                        right = m;
+                        continue;
+                    }
+                    if (_rlcp[m] < r) {
+                        left = m;
+                        l = _rlcp[m];
+                        continue;
+                    }
+                    k = _extend(pattern, _sa[m], r);
+                }
+
+                if (_before(pattern, _sa[m], k, upper)) {
+                    left = m;
+                    l = k;
+                }
+                else {
+                    right = m;
+                    r = k;
+                }
+            }
+
+            return right;
+        }
+
+        /*!
+          * Binary serialization
+         */
+
+        template <class T>
+        static void _write(std::ostream& out, const T& v)
+        {
+            out.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+
+        template <class T>
+        static void _write_vector(std::ostream& out, const std::vector<T>& v)
+        {
+            out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+        }
+
+        template <class T>
+        static T _read(std::istream& in)
+        {
+            T v{};
+            in.read(reinterpret_cast<char*>(&v), sizeof(T));
+            return v;
+        }
+
+        //! Read n values by chunks of 1 MiB, the vector grows only with the data actually read
+        template <class Vector>
+        static void _read_vector(std::istream& in, Vector& v, size_t n)
+        {
+            typedef typename Vector::value_type T;
+            constexpr size_t chunk = (size_t(1) << 20) / sizeof(T);
+
+            v.clear();
+
+            for (size_t done = 0; done < n && in; done += chunk) {
+                size_t len = std::min(chunk, n - done);
+                v.resize(done + len);
+                in.read(reinterpret_cast<char*>(&v[done]), len * sizeof(T));
+            }
+        }
+
+        static void _check_header(std::istream& in)
+        {
+            if (!in) {
+                throw std::runtime_error("The weighted index is truncated");
+            }
+        }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if !defined(WSTR_NO_SIMD) && defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define WSTR_AVX2_KERNELS
+#include <immintrin.h>
+#endif
+
+#include "weighted_char.hpp"
+
+namespace wstr
+{
+
+//! Letters of the heaviest probabilities of n positions of N contiguous probabilities (scalar version)
+/*!
+  * \param p        Probabilities, position i is p[i * N] to p[i * N + N - 1]
+  * \param n        Number of positions
+  * \param letters  Letter of each indice
+  * \param gap      Indice of the letter which is not written (N to write all letters)
+  * \param out      Output, should have n chars
+  *
+  * \return the number of letters written
+  *
+  * Ties are broken as std::max_element does, the first heaviest letter is chosen.
+ */
+template <size_t N>
+size_t heaviest_letters_scalar(const double* p, size_t n, const char* letters, size_t gap, char* out)
+{
+    size_t w = 0;
+
+    for (size_t i = 0; i < n; ++i, p += N) {
+        size_t best = 0;
+        double max = p[0];
+
+        for (size_t k = 1; k < N; ++k) {
+            best = p[k] > max ? k : best;
+            max = p[k] > max ? p[k] : max;
+        }
+
+        out[w] = letters[best];
+        w += best != gap;
+    }
+
+    return w;
+}
+
+#ifdef WSTR_AVX2_KERNELS
+
+//! Return true if the processor supports AVX2 instructions
+inline bool has_avx2()
+{
+    static const bool avx2 = __builtin_cpu_supports("avx2");
+    return avx2;
+}
+
+//! Shuffles which move the bytes of a 4-bit mask to the front, used to remove gaps
+inline constexpr std::array<std::uint32_t, 16> heaviest_compress = []() {
+    std::array<std::uint32_t, 16> compress{};
+
+    for (std::uint32_t keep = 0; keep < 16; ++keep) {
+        std::uint32_t shuffle = 0x80808080;
+        std::uint32_t w = 0;
+
+        for (std::uint32_t j = 0; j < 4; ++j) {
+            if (keep & (1 << j)) {
+                shuffle = (shuffle & ~(0xFFu << (8 * w))) | (j << (8 * w));
+                ++w;
+            }
+        }
+
+        compress[keep] = shuffle;
+    }
+
+    return compress;
+}();
+
+//! Same as heaviest_letters_scalar with AVX2 instructions, 4 positions at a time
+/*!
+  * Each probability of 4 positions is gathered in a register (loaded and transposed for 4 letters),
+  * so the heaviest letters are found with N - 1 comparisons for 4 positions. Letters are translated
+  * and gaps are removed with byte shuffles.
+ */
+template <size_t N>
+__attribute__((target("avx2"))) size_t heaviest_letters_avx2(const double* p, size_t n, const char* letters, size_t gap, char* out)
+{
+    static_assert(N <= 16, "Letters should fit in a register");
+
+    const __m128i pack = _mm_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    const __m128i gaps = _mm_set1_epi8(static_cast<char>(gap));
+
+    char padded[16] = {};
+    std::memcpy(padded, letters, N);
+    const __m128i table = _mm_loadu_si128(reinterpret_cast<const __m128i*>(padded));
+
+    size_t w = 0;
+    size_t i = 0;
+
+    for (; i + 4 <= n; i += 4, p += 4 * N) {
+        __m256d columns[N];
+
+        if constexpr (4 == N) {
+            // Transpose of the 4 positions, which are loaded as they are stored
+            __m256d r0 = _mm256_loadu_pd(p);
+            __m256d r1 = _mm256_loadu_pd(p + 4);
+            __m256d r2 = _mm256_loadu_pd(p + 8);
+            __m256d r3 = _mm256_loadu_pd(p + 12);
+
+            __m256d t0 = _mm256_unpacklo_pd(r0, r1);
+            __m256d t1 = _mm256_unpackhi_pd(r0, r1);
+            __m256d t2 = _mm256_unpacklo_pd(r2, r3);
+            __m256d t3 = _mm256_unpackhi_pd(r2, r3);
+
+            columns[0] = _mm256_permute2f128_pd(t0, t2, 0x20);
+            columns[1] = _mm256_permute2f128_pd(t1, t3, 0x20);
+            columns[2] = _mm256_permute2f128_pd(t0, t2, 0x31);
+            columns[3] = _mm256_permute2f128_pd(t1, t3, 0x31);
+        }
+        else {
+            for (size_t k = 0; k < N; ++k) {
+                columns[k] = _mm256_setr_pd(p[k], p[N + k], p[2 * N + k], p[3 * N + k]);
+            }
+        }
+
+        __m256d best = columns[0];
+        __m256d indices = _mm256_setzero_pd();
+
+        for (size_t k = 1; k < N; ++k) {
+            __m256d column = columns[k];
+            __m256d greater = _mm256_cmp_pd(column, best, _CMP_GT_OQ);
+
+            best = _mm256_blendv_pd(best, column, greater);
+            indices = _mm256_blendv_pd(indices, _mm256_set1_pd(static_cast<double>(k)), greater);
+        }
+
+        // Indices as the 4 first bytes, then translated into letters
+        __m128i heaviest = _mm_shuffle_epi8(_mm256_cvtpd_epi32(indices), pack);
+        __m128i h = _mm_shuffle_epi8(table, heaviest);
+
+        if (gap < N) {
+            unsigned keep = ~_mm_movemask_epi8(_mm_cmpeq_epi8(heaviest, gaps)) & 0xF;
+            h = _mm_shuffle_epi8(h, _mm_cvtsi32_si128(static_cast<int>(heaviest_compress[keep])));
+
+            // The 4 letters are always written, w + 4 <= i + 4 <= n
+            std::int32_t four = _mm_cvtsi128_si32(h);
+            std::memcpy(out + w, &four, 4);
+            w += __builtin_popcount(keep);
+        }
+        else {
+            std::int32_t four = _mm_cvtsi128_si32(h);
+            std::memcpy(out + w, &four, 4);
+            w += 4;
+        }
+    }
+
+    return w + heaviest_letters_scalar<N>(p, n - i, letters, gap, out + w);
+}
+
+#endif
+
+//! Letters of the heaviest probabilities of n positions, with AVX2 instructions when the processor has them
+/*!
+  * The AVX2 version is used for alphabets of at most 8 letters. It can be disabled by defining WSTR_NO_SIMD.
+  *
+  * \sa wstr::heaviest_letters_scalar
+ */
+template <size_t N>
+size_t heaviest_letters(const double* p, size_t n, const char* letters, size_t gap, char* out)
+{
+#ifdef WSTR_AVX2_KERNELS
+    if constexpr (N > 1 && N <= 8) {
+        if (has_avx2()) {
+            return heaviest_letters_avx2<N>(p, n, letters, gap, out);
+        }
+    }
+#endif
+
+    return heaviest_letters_scalar<N>(p, n, letters, gap, out);
+}
+
+template <size_t N, class Translator>
+std::integral_constant<size_t, N> w_array_size(const w_array<char, N, Translator>*);
+
+//! Check if a Container is an array of probabilities (a w_array of char), so heaviest kernels can be used
+template <class Container, class = void>
+struct has_heaviest_kernel : std::false_type {};
+
+template <class Container>
+struct has_heaviest_kernel<Container, std::void_t<decltype(w_array_size(std::declval<const Container*>()))>> : std::true_type {};
+
+//! Write the heaviest letter of n weighted chars
+/*!
+  * \param first    First weighted char
+  * \param n        Number of weighted chars
+  * \param out      Output, should have n chars
+  * \param gap      The gap character
+  * \param with_gap If false, gaps are not written
+  *
+  * \return the number of letters written
+  *
+  * With an array container, the heaviest letters are found by heaviest_letters.
+ */
+template <class Container>
+size_t heaviest_into(const weighted_char<Container>* first, size_t n, char* out, char gap, bool with_gap)
+{
+    if constexpr (has_heaviest_kernel<Container>::value && sizeof(weighted_char<Container>) == sizeof(Container)) {
+        constexpr size_t N = decltype(w_array_size(std::declval<const Container*>()))::value;
+
+        if (0 == n) {
+            return 0;
+        }
+
+        char letters[N];
+        size_t gap_indice = N;
+        size_t i = 0;
+
+        first->for_each([&](char c, double) {
+            gap_indice = (!with_gap && c == gap) ? i : gap_indice;
+            letters[i++] = c;
+        });
+
+        return heaviest_letters<N>(first->probabilities().data(), n, letters, gap_indice, out);
+    }
+    else {
+        size_t w = 0;
+
+        for (size_t i = 0; i < n; ++i) {
+            char c = first[i].heaviest_value();
+
+            out[w] = c;
+            w += with_gap || c != gap;
+        }
+
+        return w;
+    }
+}
+
+}
\ No newline at end of file
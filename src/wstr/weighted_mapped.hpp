@@ -0,0 +1,457 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <fstream>
+#include <stdexcept>
+#include <type_traits>
+
+// Memory mapping uses the POSIX interface (mmap), this header is not available on other platforms
+#if !defined(__unix__) && !defined(__APPLE__)
+#error "weighted_mapped.hpp needs POSIX memory mapping (mmap)"
+#endif
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+/*!
+  *
+  * Binary format of weighted strings, designed to be memory-mapped
+  *
+  * A file stores a collection of weighted strings (a single weighted string is a collection of size 1):
+  * - a header of 64 bytes (ws_binary_header),
+  * - the alphabet (σ letters, in the order of the Container),
+  * - the gap of each string,
+  * - the offset of each string (l + 1 positions, uint64),
+  * - the probabilities of all positions, starting on a 64 bytes boundary.
+  *
+  * Probabilities are stored exactly as the weighted_char of an array Container (σ doubles per position),
+  * so a mapped file is used in place without any copy nor parsing.
+  * Numbers are stored with the byte order of the machine which wrote the file.
+  * Files are mapped with mmap, so this header is only available on POSIX systems.
+  *
+ */
+
+//! Header of the binary format
+struct ws_binary_header
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t sigma;
+    uint64_t strings;       // number of weighted strings
+    uint64_t positions;     // total number of positions
+    uint64_t alphabet;      // offset in bytes of the alphabet
+    uint64_t gaps;          // offset in bytes of the gaps
+    uint64_t offsets;       // offset in bytes of the string offsets
+    uint64_t data;          // offset in bytes of the probabilities
+};
+
+static_assert(sizeof(ws_binary_header) == 64, "The header of the binary format should be 64 bytes");
+
+//! Version of the binary format
+inline constexpr uint32_t ws_binary_version = 1;
+
+//! Magic number at the beginning of each file
+inline constexpr char ws_binary_magic[8] = {'W', 'S', 'T', 'R', 'B', 'I', 'N', '\0'};
+
+//! Alignment in bytes of the probabilities in a file
+inline constexpr size_t ws_binary_alignment = 64;
+
+//! Return the alphabet of a Container in the order of its indices
+template <class Container>
+std::string container_alphabet()
+{
+    std::string alph;
+
+    Container().for_each([&alph](char c, double) {
+        alph += c;
+    });
+
+    return alph;
+}
+
+//! Check that weighted chars of a Container can be written and read as raw probabilities
+template <class Container>
+constexpr void check_binary_container()
+{
+    static_assert(std::is_trivially_copyable<weighted_char<Container>>::value, "The binary format only supports array Containers");
+    static_assert(std::is_same<typename Container::value_type, double>::value,
+                  "The binary format stores doubles, quantized Containers should be converted to a double array Container");
+    static_assert(sizeof(weighted_char<Container>) % sizeof(double) == 0, "The binary format only supports array Containers");
+    static_assert(alignof(weighted_char<Container>) <= ws_binary_alignment, "The binary format only supports array Containers");
+    static_assert(!has_log_at<Container, char>::value, "The binary format stores probabilities, not log-probabilities");
+}
+
+
+//! Read-only view on a weighted string stored in a mapped file
+/*!
+  * It is valid as long as the mapped_ws_collection which created it.
+  *
+  * \sa wstr::weighted_string_view
+ */
+template <class Container>
+using mapped_weighted_string = weighted_string_view<Container>;
+
+
+//! Read-only memory mapping of a whole file
+/*!
+  * The mapping is released at destruction. The class can be moved but not copied.
+ */
+class mapped_file
+{
+    private:
+
+        const char* _data = nullptr;
+        size_t _size = 0;
+
+    public:
+
+        mapped_file()
+        {
+
+        }
+
+        //! Map a file in memory
+        /*!
+          * \throw std::runtime_error if the file cannot be opened or mapped
+         */
+        explicit mapped_file(const std::string& path)
+        {
+            int fd = ::open(path.c_str(), O_RDONLY);
+
+            if (fd < 0) {
+                throw std::runtime_error("cannot open file " + path);
+            }
+
+            struct stat st;
+
+            if (::fstat(fd, &st) < 0) {
+                ::close(fd);
+                throw std::runtime_error("cannot read the size of file " + path);
+            }
+
+            _size = static_cast<size_t>(st.st_size);
+
+            if (_size > 0) {
+                void* p = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+                if (MAP_FAILED == p) {
+                    ::close(fd);
+                    throw std::runtime_error("cannot map file " + path);
+                }
+
+                _data = static_cast<const char*>(p);
+            }
+
+            ::close(fd);
+        }
+
+        mapped_file(const mapped_file&) = delete;
+        mapped_file& operator=(const mapped_file&) = delete;
+
+        mapped_file(mapped_file&& oth) noexcept : _data(oth._data), _size(oth._size)
+        {
+            oth._data = nullptr;
+            oth._size = 0;
+        }
+
+        mapped_file& operator=(mapped_file&& oth) noexcept
+        {
+            std::swap(_data, oth._data);
+            std::swap(_size, oth._size);
+            return *this;
+        }
+
+        ~mapped_file()
+        {
+            if (nullptr != _data) {
+                ::munmap(const_cast<char*>(_data), _size);
+            }
+        }
+
+        const char* data() const
+        {
+            return _data;
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+};
+
+
+//! Collection of weighted strings read from the binary format
+/*!
+  * \tparam Container   Container of the weighted chars, its alphabet must be the one of the file
+  *
+  * Opening a file maps it in memory and only checks the header and the offsets, so it costs O(l) for
+  * l weighted strings whatever the number of positions. Probabilities are read from the file when they are accessed.
+  *
+  * The collection can also be built on a buffer which already contains the binary format, the buffer
+  * should then be aligned on 64 bytes and live as long as the collection.
+  *
+  * \sa wstr::save_ws_binary
+  * \sa wstr::mapped_weighted_string
+ */
+template <class Container>
+class mapped_ws_collection
+{
+    public:
+
+        typedef weighted_char<Container> w_char;
+        typedef mapped_weighted_string<Container> value_type;
+
+    private:
+
+        mapped_file _file;
+        const w_char* _data = nullptr;
+        const uint64_t* _offsets = nullptr;
+        const char* _gaps = nullptr;
+        size_t _strings = 0;
+
+    public:
+
+        mapped_ws_collection()
+        {
+
+        }
+
+        //! Map a file written by save_ws_binary
+        /*!
+          * \throw std::runtime_error if the file cannot be mapped, is not in the binary format or has another alphabet
+         */
+        explicit mapped_ws_collection(const std::string& path) : _file(path)
+        {
+            _open(_file.data(), _file.size());
+        }
+
+        //! Use a buffer which contains the binary format
+        /*!
+          * \throw std::runtime_error if the buffer is not in the binary format or has another alphabet
+         */
+        mapped_ws_collection(const char* data, size_t size)
+        {
+            _open(data, size);
+        }
+
+        //! Number of weighted strings
+        size_t size() const
+        {
+            return _strings;
+        }
+
+        bool empty() const
+        {
+            return 0 == _strings;
+        }
+
+        //! Total number of positions of all weighted strings
+        size_t positions() const
+        {
+            return 0 == _strings ? 0 : _offsets[_strings];
+        }
+
+        value_type operator[](size_t i) const
+        {
+            return value_type(_data + _offsets[i], _offsets[i + 1] - _offsets[i], _gaps[i]);
+        }
+
+        //! Access with bound checking
+        /*!
+          * \throw std::out_of_range if i is not lower than size()
+         */
+        value_type at(size_t i) const
+        {
+            if (i >= _strings) {
+                throw std::out_of_range("There is no such weighted string in the collection");
+            }
+
+            return operator[](i);
+        }
+
+    private:
+
+        void _open(const char* data, size_t size)
+        {
+            check_binary_container<Container>();
+
+            ws_binary_header header;
+
+            if (size < sizeof(header)) {
+                throw std::runtime_error("The file does not contain weighted strings");
+            }
+
+            std::copy(data, data + sizeof(header), reinterpret_cast<char*>(&header));
+
+            if (!std::equal(header.magic, header.magic + sizeof(header.magic), ws_binary_magic)) {
+                throw std::runtime_error("The file does not contain weighted strings");
+            }
+
+            if (ws_binary_version != header.version) {
+                throw std::runtime_error("Unsupported version of weighted strings file");
+            }
+
+            std::string alph = container_alphabet<Container>();
+
+            if (header.sigma != alph.size() || header.sigma * sizeof(double) != sizeof(w_char)) {
+                throw std::runtime_error("The alphabet of the file is not the one of the container");
+            }
+
+            if (!_fits(header.alphabet, header.sigma, size) || !_fits(header.gaps, header.strings, size)
+                || header.strings > size || !_fits(header.offsets, (header.strings + 1) * sizeof(uint64_t), size)
+                || header.positions > size || !_fits(header.data, header.positions * sizeof(w_char), size)) {
+                throw std::runtime_error("The weighted strings file is truncated");
+            }
+
+            if (!std::equal(alph.begin(), alph.end(), data + header.alphabet)) {
+                throw std::runtime_error("The alphabet of the file is not the one of the container");
+            }
+
+            if (0 != reinterpret_cast<uintptr_t>(data + header.data) % alignof(w_char)
+                || 0 != reinterpret_cast<uintptr_t>(data + header.offsets) % alignof(uint64_t)) {
+                throw std::runtime_error("The weighted strings are not aligned in memory");
+            }
+
+            _offsets = reinterpret_cast<const uint64_t*>(data + header.offsets);
+
+            for (size_t i = 0; i < header.strings; ++i) {
+                if (_offsets[i] > _offsets[i + 1]) {
+                    throw std::runtime_error("The offsets of the weighted strings file are not sorted");
+                }
+            }
+
+            if (0 != _offsets[0] || header.positions != _offsets[header.strings]) {
+                throw std::runtime_error("The offsets of the weighted strings file are not valid");
+            }
+
+            _gaps = data + header.gaps;
+            _data = reinterpret_cast<const w_char*>(data + header.data);
+            _strings = header.strings;
+        }
+
+        //! Check that [offset, offset + bytes) is in a buffer of a given size
+        static bool _fits(uint64_t offset, uint64_t bytes, size_t size)
+        {
+            return offset <= size && bytes <= size - offset;
+        }
+};
+
+
+//! Write a collection of weighted strings in the binary format
+/*!
+  * \tparam WString     A weighted string with an array Container (or any class inheriting from it)
+  *
+  * \sa wstr::mapped_ws_collection
+ */
+template <class WString>
+void write_ws_binary(std::ostream& out, const WString* first, size_t count)
+{
+    typedef std::decay_t<decltype(first->data()->probabilities())> Container;
+    typedef weighted_char<Container> w_char;
+
+    check_binary_container<Container>();
+
+    std::string alph = container_alphabet<Container>();
+    std::vector<uint64_t> offsets(count + 1, 0);
+    std::string gaps(count, NO_GAP);
+
+    for (size_t i = 0; i < count; ++i) {
+        offsets[i + 1] = offsets[i] + first[i].size();
+        gaps[i] = first[i].gap();
+    }
+
+    auto align = [](uint64_t offset, uint64_t alignment) {
+        return (offset + alignment - 1) / alignment * alignment;
+    };
+
+    ws_binary_header header;
+    std::copy(ws_binary_magic, ws_binary_magic + sizeof(ws_binary_magic), header.magic);
+    header.version = ws_binary_version;
+    header.sigma = static_cast<uint32_t>(alph.size());
+    header.strings = count;
+    header.positions = offsets[count];
+    header.alphabet = sizeof(header);
+    header.gaps = header.alphabet + alph.size();
+    header.offsets = align(header.gaps + count, sizeof(uint64_t));
+    header.data = align(header.offsets + offsets.size() * sizeof(uint64_t), ws_binary_alignment);
+
+    const char padding[ws_binary_alignment] = {};
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(alph.data(), alph.size());
+    out.write(gaps.data(), gaps.size());
+    out.write(padding, header.offsets - header.gaps - count);
+    out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+    out.write(padding, header.data - header.offsets - offsets.size() * sizeof(uint64_t));
+
+    for (size_t i = 0; i < count; ++i) {
+        out.write(reinterpret_cast<const char*>(first[i].data()), first[i].size() * sizeof(w_char));
+    }
+}
+
+//! Write a weighted string in a binary file, as a collection of one weighted string
+/*!
+  * \tparam Container   An array Container (w_char_array, dna_container...)
+  *
+  * \throw std::runtime_error if the file cannot be written
+ */
+template <class Container, class Allocator>
+void save_ws_binary(const std::string& path, const weighted_string<Container, Allocator>& ws)
+{
+    std::ofstream out(path, std::ios::binary);
+    write_ws_binary(out, &ws, 1);
+
+    if (!out) {
+        throw std::runtime_error("cannot write file " + path);
+    }
+}
+
+//! Write the positions of a view in a binary file, as a collection of one weighted string
+/*!
+  * \throw std::runtime_error if the file cannot be written
+ */
+template <class Container>
+void save_ws_binary(const std::string& path, const weighted_string_view<Container>& ws)
+{
+    std::ofstream out(path, std::ios::binary);
+    write_ws_binary(out, &ws, 1);
+
+    if (!out) {
+        throw std::runtime_error("cannot write file " + path);
+    }
+}
+
+//! Write a collection of weighted strings in a binary file
+/*!
+  * \tparam WString     A weighted string with an array Container (or any class inheriting from it)
+  * \tparam Collection  Any contiguous collection with two template parameters such as std::vector
+  * \tparam Allocator   The allocator for the weighted strings
+  *
+  * \throw std::runtime_error if the file cannot be written
+ */
+template <
+    class WString,
+    template <class, class> class Collection,
+    class Allocator,
+    class = decltype(std::declval<const WString&>().gap())
+>
+void save_ws_binary(const std::string& path, const Collection<WString, Allocator>& wsc)
+{
+    std::ofstream out(path, std::ios::binary);
+    write_ws_binary(out, wsc.data(), wsc.size());
+
+    if (!out) {
+        throw std::runtime_error("cannot write file " + path);
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,239 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+//! Check if a Container has a static `is_extended(char)` method
+/*!
+  * Extended letters represent several letters of the alphabet (such as IUPAC codes for dna_container),
+  * so their probability can be greater than the probability of the heaviest letter.
+ */
+template <class Container, class = void>
+struct has_extended_letters : std::false_type {};
+
+template <class Container>
+struct has_extended_letters<Container, std::void_t<decltype(Container::is_extended(char()))>> : std::true_type {};
+
+
+//! Find occurrences of solid patterns in a weighted string with a probability threshold
+/*!
+  * \tparam WString     The weighted string type (weighted_string or any class inheriting from it, or weighted_string_view)
+  *
+  * A solid pattern P occurs at position i of a weighted string X with probability
+  * p(P, i) = X[i].p(P[0]) * ... * X[i + |P| - 1].p(P[|P| - 1]).
+  * The matcher reports all positions i such that p(P, i) >= 1/z.
+  *
+  * The preprocessing is a single O(n) pass which computes prefix sums of the logarithm of the heaviest probability
+  * of each position. Since a letter cannot be more probable than the heaviest letter, the sum over a window is an
+  * upper bound of log p(P, i), which discards a candidate in O(1). The remaining candidates are verified letter by
+  * letter, and the verification stops as soon as the bound corrected by the letters already seen is below log(1/z).
+  *
+  * Letters of the extended alphabet of the Container (see has_extended_letters), such as `N` or `R` for
+  * dna_container, are allowed in patterns. They do not take part in the upper bound, so they cost O(1) more
+  * per candidate.
+  *
+  * The matcher keeps a reference on the weighted string (a copy for a weighted_string_view), which should not be
+  * modified or destroyed while the matcher is used. Comparisons are done in log space with a tolerance of `log_epsilon`.
+  *
+  * \sa wstr::weighted_string
+  * \sa wstr::dna_container
+ */
+template <class WString>
+class weighted_pattern_matcher
+{
+    public:
+
+        typedef std::decay_t<decltype(std::declval<const WString&>()[0].probabilities())> container_type;
+
+    private:
+
+        std::conditional_t<is_weighted_string_view<WString>::value, const WString, const WString&> _ws;
+        double _z;
+        double _log_threshold;
+
+        //! _prefix[i] is the sum of log-probabilities of the heaviest letters of positions [0, i)
+        std::vector<double> _prefix;
+
+        //! _dead[i] is the number of positions in [0, i) where all probabilities are 0
+        std::vector<size_t> _dead;
+
+        std::vector<double> _log_heaviest;
+
+    public:
+
+        //! Preprocess a weighted string for a given threshold
+        /*!
+          * \param ws   The weighted string to search in
+          * \param z    Occurrences must have a probability greater or equal to 1/z
+          *
+          * \throw std::invalid_argument if z is lower than 1
+         */
+        weighted_pattern_matcher(const WString& ws, double z) : _ws(ws), _z(z), _log_threshold(-std::log(z))
+        {
+            if (!(z >= 1.)) {
+                throw std::invalid_argument("The threshold z must be greater or equal to 1");
+            }
+
+            size_t n = ws.size();
+
+            _prefix.resize(n + 1);
+            _dead.resize(n + 1);
+            _log_heaviest.resize(n);
+
+            _prefix[0] = 0.;
+            _dead[0] = 0;
+
+            for (size_t i = 0; i < n; ++i) {
+                // Containers storing only some letters have no heaviest letter when they are empty
+                double h = 0. == ws[i].probabilities().sum() ? 0. : ws[i].heaviest_proba();
+                bool dead = !(h > 0.);
+
+                _log_heaviest[i] = dead ? 0. : std::log(h);
+                _prefix[i + 1] = _prefix[i] + _log_heaviest[i];
+                _dead[i + 1] = _dead[i] + dead;
+            }
+        }
+
+        double z() const
+        {
+            return _z;
+        }
+
+        //! Return all positions (in increasing order) where the pattern occurs with probability >= 1/z
+        /*!
+          * An empty pattern has no occurrence.
+         */
+        std::vector<size_t> find(const std::string& pattern) const
+        {
+            std::vector<size_t> occ;
+            size_t m = pattern.size();
+            size_t n = _ws.size();
+
+            if (0 == m || m > n) {
+                return occ;
+            }
+
+            std::vector<size_t> extended = _extended_positions(pattern);
+
+            for (size_t i = 0; i + m <= n; ++i) {
+                if (_dead[i + m] != _dead[i]) {
+                    continue;
+                }
+
+                double bound = _prefix[i + m] - _prefix[i];
+
+                for (size_t j : extended) {
+                    bound -= _log_heaviest[i + j];
+                }
+
+                if (bound < _log_threshold - log_epsilon) {
+                    continue;
+                }
+
+                if (_verify(pattern, i, bound, extended)) {
+                    occ.push_back(i);
+                }
+            }
+
+            return occ;
+        }
+
+        //! Batch version of find, the i-th result is the list of occurrences of the i-th pattern
+        std::vector<std::vector<size_t>> find_all(const std::vector<std::string>& patterns) const
+        {
+            std::vector<std::vector<size_t>> occ;
+            occ.reserve(patterns.size());
+
+            for (const std::string& pattern : patterns) {
+                occ.push_back(find(pattern));
+            }
+
+            return occ;
+        }
+
+        //! Check if the pattern occurs at a given position with probability >= 1/z
+        bool occurs_at(const std::string& pattern, size_t i) const
+        {
+            size_t m = pattern.size();
+
+            if (0 == m || i + m > _ws.size() || _dead[i + m] != _dead[i]) {
+                return false;
+            }
+
+            std::vector<size_t> extended = _extended_positions(pattern);
+            double bound = _prefix[i + m] - _prefix[i];
+
+            for (size_t j : extended) {
+                bound -= _log_heaviest[i + j];
+            }
+
+            return bound >= _log_threshold - log_epsilon && _verify(pattern, i, bound, extended);
+        }
+
+    private:
+
+        //! Positions of the pattern which contain a letter of the extended alphabet
+        std::vector<size_t> _extended_positions(const std::string& pattern) const
+        {
+            std::vector<size_t> extended;
+
+            if constexpr (has_extended_letters<container_type>::value) {
+                for (size_t j = 0; j < pattern.size(); ++j) {
+                    if (container_type::is_extended(pattern[j])) {
+                        extended.push_back(j);
+                    }
+                }
+            }
+
+            return extended;
+        }
+
+        //! Replace the bound of each letter by its exact log-probability, stop as soon as the bound is too low
+        bool _verify(const std::string& pattern, size_t i, double bound, const std::vector<size_t>& extended) const
+        {
+            auto ext = extended.begin();
+
+            for (size_t j = 0; j < pattern.size(); ++j) {
+                double letter_bound = 0.;
+
+                if (ext != extended.end() && *ext == j) {
+                    ++ext;
+                }
+                else {
+                    letter_bound = _log_heaviest[i + j];
+                }
+
+                bound += _ws[i + j].log_p(pattern[j]) - letter_bound;
+
+                if (bound < _log_threshold - log_epsilon) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+};
+
+
+//! Return all positions where a solid pattern occurs in a weighted string with probability >= 1/z
+/*!
+  * Use a weighted_pattern_matcher instead to search several patterns in the same weighted string.
+  *
+  * \sa wstr::weighted_pattern_matcher
+ */
+template <class WString>
+std::vector<size_t> find_occurrences(const WString& ws, const std::string& pattern, double z)
+{
+    return weighted_pattern_matcher<WString>(ws, z).find(pattern);
+}
+
+}
\ No newline at end of file
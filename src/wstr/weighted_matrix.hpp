@@ -0,0 +1,355 @@
+#pragma once
+
+#include <new>
+#include <memory>
+
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+//! Minimal allocator returning memory aligned on `Align` bytes
+/*!
+  * \tparam T       The type of allocated elements
+  * \tparam Align   The alignment in bytes (should be a power of two)
+ */
+template <class T, std::size_t Align = 64>
+struct aligned_allocator
+{
+    typedef T value_type;
+
+    template <class U>
+    struct rebind { typedef aligned_allocator<U, Align> other; };
+
+    aligned_allocator() = default;
+
+    template <class U>
+    aligned_allocator(const aligned_allocator<U, Align>&) noexcept
+    {
+
+    }
+
+    T* allocate(std::size_t n)
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept
+    {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template <class U>
+    bool operator==(const aligned_allocator<U, Align>&) const noexcept { return true; }
+
+    template <class U>
+    bool operator!=(const aligned_allocator<U, Align>&) const noexcept { return false; }
+};
+
+
+//! A weighted string stored as a column-major σ×n matrix of probabilities
+/*!
+  * \tparam alph    The alphabet of the weighted string (a static const variable, as for w_array)
+  *
+  * All probabilities are kept in one contiguous buffer with one row per letter of the alphabet.
+  * Each row is padded to a multiple of 64 bytes so every row starts on a cache line, which makes
+  * per-letter scans over many positions stream through memory and easy to vectorize.
+  *
+  * The matrix offers the same queries as a weighted_string (`p`, `heaviest`, `heaviest_ungap` and gap)
+  * and can be converted from and to any weighted_string<Container>.
+  *
+  * \sa wstr::weighted_string
+  * \sa wstr::static_ws_translator
+ */
+template <const char* alph>
+class weighted_matrix
+{
+    public:
+
+        typedef static_ws_translator<alph> translator;
+
+        //! Number of rows (letters of the alphabet)
+        static constexpr size_t sigma = translator::size;
+
+        //! Alignment of each row, in bytes
+        static constexpr size_t alignment = 64;
+
+        static_assert(sigma > 0, "The alphabet of a weighted_matrix cannot be empty");
+
+    private:
+
+        static constexpr size_t _row_block = alignment / sizeof(double);
+
+        std::vector<double, aligned_allocator<double, alignment>> _data;
+        size_t _size = 0;
+        size_t _stride = 0;
+        char _gap = NO_GAP;
+
+    public:
+
+        //! Empty matrix
+        weighted_matrix()
+        {
+
+        }
+
+        //! Matrix of n positions where all probabilities are 0
+        explicit weighted_matrix(size_t n)
+        {
+            resize(n);
+        }
+
+        //! Copy all probabilities (and the gap) of a weighted string
+        /*!
+          * \tparam Container   Container of the weighted string
+          *
+          * Letters of the weighted string which are not in the alphabet are ignored.
+         */
+        template <class Container>
+        explicit weighted_matrix(const weighted_string<Container>& ws) : weighted_matrix(weighted_string_view<Container>(ws))
+        {
+
+        }
+
+        //! Copy all probabilities (and the gap) of a view on a weighted string
+        template <class Container>
+        explicit weighted_matrix(const weighted_string_view<Container>& ws) : weighted_matrix(ws.size())
+        {
+            for (size_t k = 0; k < sigma; ++k) {
+                double* r = row_at(k);
+                char c = alph[k];
+
+                for (size_t i = 0; i < _size; ++i) {
+                    r[i] = ws[i].p(c);
+                }
+            }
+
+            _gap = ws.gap();
+        }
+
+        //! Convert the matrix to a weighted string
+        /*!
+          * \tparam Container   Container of the weighted string
+          * \param strict       Same as for weighted_element constructor
+          * \param precision    Same as for weighted_element constructor
+          *
+          * As when reading a file, probabilities equal to 0 are not stored in the containers.
+         */
+        template <class Container>
+        weighted_string<Container> to_weighted_string(bool strict = true, double precision = 0.) const
+        {
+            weighted_string<Container> ws;
+            ws.reserve(_size);
+            ws.set_gap(_gap);
+
+            for (size_t i = 0; i < _size; ++i) {
+                Container wc;
+
+                for (size_t k = 0; k < sigma; ++k) {
+                    double v = row_at(k)[i];
+
+                    if (0. != v) {
+                        wc[alph[k]] = v;
+                    }
+                }
+
+                ws.emplace_back(weighted_char<Container>(wc, strict, precision));
+            }
+
+            return ws;
+        }
+
+        bool operator==(const weighted_matrix<alph>& oth) const
+        {
+            if (_size != oth._size || _gap != oth._gap) {
+                return false;
+            }
+
+            for (size_t k = 0; k < sigma; ++k) {
+                if (!std::equal(row_at(k), row_at(k) + _size, oth.row_at(k))) {
+                    return false;
+                }
+            }
+
+            return true;
+        }
+
+        bool operator!=(const weighted_matrix<alph>& oth) const
+        {
+            return !operator==(oth);
+        }
+
+        //! Number of positions
+        size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return 0 == _size;
+        }
+
+        //! Change the number of positions, new positions have all probabilities equal to 0
+        void resize(size_t n)
+        {
+            size_t stride = (n + _row_block - 1) / _row_block * _row_block;
+
+            if (stride != _stride) {
+                std::vector<double, aligned_allocator<double, alignment>> data(sigma * stride, 0.);
+
+                for (size_t k = 0; k < sigma; ++k) {
+                    std::copy(row_at(k), row_at(k) + std::min(n, _size), data.data() + k * stride);
+                }
+
+                _data.swap(data);
+                _stride = stride;
+            }
+            else if (n < _size) {
+                // Positions after the size are kept at 0, so growing inside the stride has nothing to do
+                for (size_t k = 0; k < sigma; ++k) {
+                    std::fill_n(_data.begin() + k * _stride + n, _size - n, 0.);
+                }
+            }
+
+            _size = n;
+        }
+
+        //! Return the probability of a letter at a given position, 0 if the letter is not in the alphabet
+        double p(size_t i, char c) const
+        {
+            size_t k = translator::find_indice(c);
+            return translator::npos == k ? 0. : _data[k * _stride + i];
+        }
+
+        //! Access to the probability of a letter at a given position
+        /*!
+          * \throw std::runtime_error if the letter is not in the alphabet
+         */
+        double& operator()(size_t i, char c)
+        {
+            return _data[translator::get_indice(c) * _stride + i];
+        }
+
+        //! Row of probabilities of a letter (size() values)
+        const double* row(char c) const
+        {
+            return row_at(translator::get_indice(c));
+        }
+
+        double* row(char c)
+        {
+            return row_at(translator::get_indice(c));
+        }
+
+        //! Row of probabilities of the k-th letter of the alphabet
+        const double* row_at(size_t k) const
+        {
+            return _data.data() + k * _stride;
+        }
+
+        double* row_at(size_t k)
+        {
+            return _data.data() + k * _stride;
+        }
+
+        void set_gap(char gap)
+        {
+            _gap = gap;
+        }
+
+        bool has_gap() const
+        {
+            return NO_GAP != gap();
+        }
+
+        char gap() const
+        {
+            return _gap;
+        }
+
+        //! Return the letter with the heaviest probability at a given position
+        char heaviest_value(size_t i) const
+        {
+            size_t best = 0;
+
+            for (size_t k = 1; k < sigma; ++k) {
+                if (row_at(k)[i] > row_at(best)[i]) {
+                    best = k;
+                }
+            }
+
+            return alph[best];
+        }
+
+        //! Return the probability of the heaviest letter at a given position
+        double heaviest_proba(size_t i) const
+        {
+            return p(i, heaviest_value(i));
+        }
+
+        //! Check if the sum of probabilities at a given position equals to 1
+        bool is_good(size_t i, double precision = 0.) const
+        {
+            double sum = 0.;
+
+            for (size_t k = 0; k < sigma; ++k) {
+                sum += row_at(k)[i];
+            }
+
+            return fabs(1.0 - sum) < precision + std::numeric_limits<double>::epsilon();
+        }
+
+        std::string heaviest() const
+        {
+            return _heaviest(true);
+        }
+
+        std::string heaviest_ungap() const
+        {
+            return _heaviest(false);
+        }
+
+    private:
+
+        //! Scan the rows by blocks of positions so that each row is read sequentially
+        std::string _heaviest(bool with_gap) const
+        {
+            static constexpr size_t block = 1024;
+
+            std::string h;
+            h.reserve(_size);
+
+            double best[block];
+            unsigned char arg[block];
+
+            for (size_t start = 0; start < _size; start += block) {
+                size_t len = std::min(block, _size - start);
+
+                std::copy(row_at(0) + start, row_at(0) + start + len, best);
+                std::fill(arg, arg + len, 0);
+
+                for (size_t k = 1; k < sigma; ++k) {
+                    const double* r = row_at(k) + start;
+
+                    for (size_t i = 0; i < len; ++i) {
+                        bool greater = r[i] > best[i];
+                        best[i] = greater ? r[i] : best[i];
+                        arg[i] = greater ? static_cast<unsigned char>(k) : arg[i];
+                    }
+                }
+
+                for (size_t i = 0; i < len; ++i) {
+                    char c = alph[arg[i]];
+
+                    if (with_gap || c != _gap) {
+                        h += c;
+                    }
+                }
+            }
+
+            return h;
+        }
+};
+
+}
\ No newline at end of file
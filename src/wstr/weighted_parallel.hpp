@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+
+namespace wstr
+{
+
+//! Call f on the ranges [begin, end) of chunk items of [0, count), with several threads
+/*!
+  * \param count    Number of items
+  * \param chunk    Number of items given to a thread at a time
+  * \param threads  Number of threads (0 for one thread per core), the calling thread is one of them
+  * \param f        Called as f(begin, end), concurrently from the threads
+  *
+  * Threads take the next chunk from a shared counter, so a slow chunk does not delay the others.
+  * No more threads are started than there are chunks. f should not throw: errors of an item should be stored
+  * and reported after the call.
+ */
+template <class F>
+void parallel_for(size_t count, size_t chunk, size_t threads, F f)
+{
+    std::atomic<size_t> next(0);
+
+    auto work = [&]() {
+        for (size_t start = next.fetch_add(chunk); start < count; start = next.fetch_add(chunk)) {
+            f(start, std::min(count, start + chunk));
+        }
+    };
+
+    if (0 == threads) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    std::vector<std::thread> workers;
+
+    for (size_t t = 1; t < std::min(threads, (count + chunk - 1) / chunk); ++t) {
+        workers.emplace_back(work);
+    }
+
+    work();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <stdexcept>
+#include <algorithm>
+
+#include "weighted_kernels.hpp"
+
+namespace wstr
+{
+
+//! Code of each letter of a DNA sequence in the scores of a pwm_scanner: A, C, G, T (any case) and 4 for others
+inline constexpr std::array<std::uint8_t, 256> pwm_codes = []() {
+    std::array<std::uint8_t, 256> codes{};
+
+    for (auto& c : codes) {
+        c = 4;
+    }
+
+    codes['A'] = codes['a'] = 0;
+    codes['C'] = codes['c'] = 1;
+    codes['G'] = codes['g'] = 2;
+    codes['T'] = codes['t'] = 3;
+
+    return codes;
+}();
+
+//! Pack a DNA sequence on 2 bits per base: A = 0, C = 1, G = 2, T = 3, the first base in the high bits of a byte
+/*!
+  * \throw std::invalid_argument if the sequence has other letters than A, C, G and T (any case)
+ */
+inline std::vector<std::uint8_t> pack_dna(const std::string& seq)
+{
+    std::vector<std::uint8_t> packed((seq.size() + 3) / 4, 0);
+
+    for (size_t i = 0; i < seq.size(); ++i) {
+        std::uint8_t code = pwm_codes[static_cast<unsigned char>(seq[i])];
+
+        if (code > 3) {
+            throw std::invalid_argument(std::string("The letter '") + seq[i] + "' cannot be packed on 2 bits");
+        }
+
+        packed[i / 4] |= code << (6 - 2 * (i % 4));
+    }
+
+    return packed;
+}
+
+//! Scores of the windows of a sequence of codes with a table of scores, the windows with a score >= threshold are reported
+/*!
+  * \param scores       Scores of m columns of 8 floats, the score of the code c at the column j is scores[8 * j + c]
+  * \param m            Number of columns (length of the windows)
+  * \param codes        Codes of the sequence (from 0 to 7), there are count + m - 1 codes
+  * \param count        Number of windows
+  * \param threshold    Minimum score of a reported window
+  * \param report       Called with the indice of each window with a score >= threshold (in increasing order) and its score
+  *
+  * Scores are summed in the order of the columns, so the AVX2 version gives exactly the same scores.
+ */
+template <class F>
+void pwm_hits_scalar(const float* scores, size_t m, const std::uint8_t* codes, size_t count, float threshold, F& report)
+{
+    for (size_t i = 0; i < count; ++i) {
+        float score = 0.f;
+
+        for (size_t j = 0; j < m; ++j) {
+            score += scores[8 * j + codes[i + j]];
+        }
+
+        if (score >= threshold) {
+            report(i, score);
+        }
+    }
+}
+
+#ifdef WSTR_AVX2_KERNELS
+
+//! Same as pwm_hits_scalar with AVX2 instructions, 32 windows at a time
+/*!
+  * Each column of scores is a register of 8 floats, so the scores of a column for 8 windows are a single
+  * permutation of the column by the codes of the 8 windows.
+ */
+template <class F>
+__attribute__((target("avx2"))) void pwm_hits_avx2(const float* scores, size_t m, const std::uint8_t* codes, size_t count, float threshold, F& report)
+{
+    const __m256 t = _mm256_set1_ps(threshold);
+
+    size_t i = 0;
+
+    for (; i + 32 <= count; i += 32) {
+        __m256 sum[4] = {_mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps(), _mm256_setzero_ps()};
+
+        for (size_t j = 0; j < m; ++j) {
+            __m256 column = _mm256_loadu_ps(scores + 8 * j);
+            const std::uint8_t* c = codes + i + j;
+
+            for (size_t k = 0; k < 4; ++k) {
+                __m256i lanes = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(c + 8 * k)));
+                sum[k] = _mm256_add_ps(sum[k], _mm256_permutevar8x32_ps(column, lanes));
+            }
+        }
+
+        for (size_t k = 0; k < 4; ++k) {
+            unsigned hits = _mm256_movemask_ps(_mm256_cmp_ps(sum[k], t, _CMP_GE_OQ));
+
+            if (0 != hits) {
+                alignas(32) float values[8];
+                _mm256_store_ps(values, sum[k]);
+
+                for (; 0 != hits; hits &= hits - 1) {
+                    unsigned l = __builtin_ctz(hits);
+                    report(i + 8 * k + l, values[l]);
+                }
+            }
+        }
+    }
+
+    auto shifted = [&report, i](size_t w, float score) {
+        report(i + w, score);
+    };
+
+    pwm_hits_scalar(scores, m, codes + i, count - i, threshold, shifted);
+}
+
+#endif
+
+//! Scanner of DNA sequences with a weighted string used as a position weight matrix
+/*!
+  * The probabilities of A, C, G and T at each position of the profile (a weighted_string<dna_container<...>> or any
+  * weighted string with these letters) are compiled into log-odds scores in bits: a base b at the column j has the
+  * score log2(p'(j, b) / background(b)) with p'(j, b) = (p(j, b) + pseudocount * background(b)) / (1 + pseudocount).
+  * The score of a window of the sequence is the sum of the scores of its bases, and the scanner reports all windows
+  * with a score greater or equal to a threshold. Windows with other letters than A, C, G and T (such as N) have
+  * a score -infinity and are never reported, as are windows with a base of probability 0 without pseudocount.
+  *
+  * Sequences are either ASCII or packed on 2 bits per base (see pack_dna). They are scanned by blocks of
+  * `block_size` windows: the bases of a block are translated into codes, then scores are computed with AVX2
+  * instructions for 32 windows at a time when the processor has them (define `WSTR_NO_SIMD` to disable them).
+  * Scores are floats, summed in the order of the columns whatever the instructions used.
+  *
+  * Hits are given to a callback as soon as they are found, with their position and their score:
+  *
+  *     pwm_scanner scanner(motif);
+  *     scanner.scan(genome.data(), genome.size(), 8., [](size_t i, float score) {
+  *         // window [i, i + scanner.size())
+  *     });
+  *
+  * \sa wstr::pwm_stream
+ */
+class pwm_scanner
+{
+    public:
+
+        //! Number of windows of each block
+        static constexpr size_t block_size = 1 << 12;
+
+    private:
+
+        std::vector<float> _scores;
+        size_t _m = 0;
+        bool _simd = true;
+
+    public:
+
+        //! Compile a profile into log-odds scores
+        /*!
+          * \param profile      The weighted string of the motif
+          * \param background   Probabilities of A, C, G and T in the scanned sequences
+          * \param pseudocount  Weight of the background added to the probabilities of the profile
+          *
+          * \throw std::invalid_argument if the background is not a distribution with positive probabilities,
+          *        if the pseudocount is negative or if the profile is empty
+         */
+        template <class WString>
+        explicit pwm_scanner(const WString& profile, const std::array<double, 4>& background = {.25, .25, .25, .25},
+                             double pseudocount = 0.)
+            : _scores(8 * profile.size(), -std::numeric_limits<float>::infinity()), _m(profile.size())
+        {
+            double sum = 0.;
+
+            for (double b : background) {
+                if (!(b > 0.)) {
+                    throw std::invalid_argument("The probabilities of the background must be positive");
+                }
+
+                sum += b;
+            }
+
+            if (std::abs(sum - 1.) > 1e-6) {
+                throw std::invalid_argument("The probabilities of the background must sum to 1");
+            }
+
+            if (!(pseudocount >= 0.)) {
+                throw std::invalid_argument("The pseudocount must be positive or 0");
+            }
+
+            if (0 == _m) {
+                throw std::invalid_argument("The profile must not be empty");
+            }
+
+            for (size_t j = 0; j < _m; ++j) {
+                for (size_t b = 0; b < 4; ++b) {
+                    double p = (profile[j].p("ACGT"[b]) + pseudocount * background[b]) / (1. + pseudocount);
+                    _scores[8 * j + b] = static_cast<float>(std::log2(p / background[b]));
+                }
+            }
+        }
+
+        //! Length of the motif
+        size_t size() const
+        {
+            return _m;
+        }
+
+        //! Score of a base at a column of the motif
+        float score(size_t j, char base) const
+        {
+            return _scores[8 * j + pwm_codes[static_cast<unsigned char>(base)]];
+        }
+
+        //! Score of the window of size() bases starting at a position of an ASCII sequence
+        float score(const char* window) const
+        {
+            float score = 0.f;
+
+            for (size_t j = 0; j < _m; ++j) {
+                score += this->score(j, window[j]);
+            }
+
+            return score;
+        }
+
+        //! Highest score of a window
+        double max_score() const
+        {
+            double max = 0.;
+
+            for (size_t j = 0; j < _m; ++j) {
+                max += *std::max_element(_scores.begin() + 8 * j, _scores.begin() + 8 * j + 4);
+            }
+
+            return max;
+        }
+
+        //! Use AVX2 instructions when the processor has them (default), or always use the scalar version
+        void set_simd(bool simd)
+        {
+            _simd = simd;
+        }
+
+        //! Report all windows of an ASCII sequence with a score greater or equal to a threshold
+        /*!
+          * \param seq          The sequence
+          * \param n            Length of the sequence
+          * \param threshold    Minimum score of a reported window
+          * \param report       Called with the position of each hit (in increasing order) and its score
+          * \param offset       Added to the reported positions, to scan a long sequence by parts
+         */
+        template <class F>
+        void scan(const char* seq, size_t n, double threshold, F report, size_t offset = 0) const
+        {
+            _scan(n, threshold, report, offset, [seq](std::uint8_t* codes, size_t first, size_t count) {
+                for (size_t i = 0; i < count; ++i) {
+                    codes[i] = pwm_codes[static_cast<unsigned char>(seq[first + i])];
+                }
+            });
+        }
+
+        //! Same on a sequence packed on 2 bits per base, from the base first to the base first + n (excluded)
+        /*!
+          * Positions are reported in the packed sequence (from first).
+          *
+          * \sa wstr::pack_dna
+         */
+        template <class F>
+        void scan_2bit(const std::uint8_t* packed, size_t first, size_t n, double threshold, F report) const
+        {
+            _scan(n, threshold, report, first, [packed, first](std::uint8_t* codes, size_t start, size_t count) {
+                for (size_t i = first + start; i < first + start + count; ++i) {
+                    *codes++ = (packed[i / 4] >> (6 - 2 * (i % 4))) & 3;
+                }
+            });
+        }
+
+        //! All windows of an ASCII sequence with a score greater or equal to a threshold, with their score
+        std::vector<std::pair<size_t, float>> find(const std::string& seq, double threshold) const
+        {
+            std::vector<std::pair<size_t, float>> hits;
+
+            scan(seq.data(), seq.size(), threshold, [&hits](size_t i, float score) {
+                hits.emplace_back(i, score);
+            });
+
+            return hits;
+        }
+
+    private:
+
+        //! Scan n bases by blocks, translate(codes, first, count) writes the codes of count bases from first
+        template <class F, class Translate>
+        void _scan(size_t n, double threshold, F& report, size_t offset, Translate translate) const
+        {
+            if (n < _m) {
+                return;
+            }
+
+            size_t windows = n - _m + 1;
+            float t = static_cast<float>(threshold);
+
+            std::vector<std::uint8_t> codes(std::min(windows, block_size) + _m - 1);
+
+            for (size_t first = 0; first < windows; first += block_size) {
+                size_t count = std::min(block_size, windows - first);
+                translate(codes.data(), first, count + _m - 1);
+
+                auto shifted = [&report, first, offset](size_t w, float score) {
+                    report(offset + first + w, score);
+                };
+
+#ifdef WSTR_AVX2_KERNELS
+                if (_simd && has_avx2()) {
+                    pwm_hits_avx2(_scores.data(), _m, codes.data(), count, t, shifted);
+                    continue;
+                }
+#endif
+
+                pwm_hits_scalar(_scores.data(), _m, codes.data(), count, t, shifted);
+            }
+        }
+};
+
+
+//! Scanner of an ASCII sequence given by chunks, such as a genome read from a file
+/*!
+  * The last size() - 1 bases of each chunk are kept, so windows over two chunks are scanned and positions
+  * are the positions in the whole sequence.
+  *
+  * \sa wstr::pwm_scanner
+ */
+class pwm_stream
+{
+    private:
+
+        const pwm_scanner& _scanner;
+        double _threshold;
+        std::string _tail;
+        size_t _position = 0;
+
+    public:
+
+        //! Scan with a scanner, which should live as long as the stream
+        pwm_stream(const pwm_scanner& scanner, double threshold) : _scanner(scanner), _threshold(threshold)
+        {
+
+        }
+
+        //! Scan the next chunk of the sequence, report is called as in pwm_scanner::scan
+        template <class F>
+        void feed(const char* chunk, size_t n, F report)
+        {
+            _tail.append(chunk, n);
+
+            if (_tail.size() < _scanner.size()) {
+                return;
+            }
+
+            _scanner.scan(_tail.data(), _tail.size(), _threshold, report, _position);
+
+            size_t scanned = _tail.size() - _scanner.size() + 1;
+            _tail.erase(0, scanned);
+            _position += scanned;
+        }
+
+        //! Number of windows scanned
+        size_t position() const
+        {
+            return _position;
+        }
+};
+
+}
\ No newline at end of file
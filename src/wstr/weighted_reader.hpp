@@ -0,0 +1,498 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <fstream>
+#include <charconv>
+#include <exception>
+#include <stdexcept>
+
+#include "weighted_string.hpp"
+#include "weighted_parallel.hpp"
+
+namespace wstr
+{
+
+//! Error while reading a weighted string, with the line where it happened
+class ws_parse_error : public std::runtime_error
+{
+    private:
+
+        size_t _line;
+
+    public:
+
+        ws_parse_error(size_t line, const std::string& what) : std::runtime_error("line " + std::to_string(line) + ": " + what), _line(line)
+        {
+
+        }
+
+        //! Line of the error (starting at 1)
+        size_t line() const
+        {
+            return _line;
+        }
+};
+
+
+//! Reader of the weighted string file format working on a raw buffer
+/*!
+  * This reader accepts the same format as the >> operators (size, alphabet and one line of σ whitespace separated
+  * probabilities per position) but parses numbers with std::from_chars on a buffer instead of going through
+  * the locale machinery of streams. Each position must be on its own line.
+  *
+  * All errors are reported with a ws_parse_error which gives the line of the error.
+  * The buffer is not copied and should live as long as the reader.
+  *
+  * \sa wstr::parse_ws
+  * \sa wstr::load_ws
+ */
+class ws_buffer_reader
+{
+    private:
+
+        const char* _cur;
+        const char* _end;
+        size_t _line = 1;
+
+    public:
+
+        //! Reader of [first, last), line is the line number of first in the file
+        ws_buffer_reader(const char* first, const char* last, size_t line = 1) : _cur(first), _end(last), _line(line)
+        {
+
+        }
+
+        explicit ws_buffer_reader(const std::string& buffer) : ws_buffer_reader(buffer.data(), buffer.data() + buffer.size())
+        {
+
+        }
+
+        //! Current line (starting at 1)
+        size_t line() const
+        {
+            return _line;
+        }
+
+        //! Current position in the buffer
+        const char* position() const
+        {
+            return _cur;
+        }
+
+        //! True if there is nothing but spaces until the end of the buffer
+        bool eof()
+        {
+            skip_spaces();
+            return _cur == _end;
+        }
+
+        //! Skip all spaces, tabulations and line breaks
+        void skip_spaces()
+        {
+            while (_cur != _end && _is_space(*_cur)) {
+                _line += ('\n' == *_cur);
+                ++_cur;
+            }
+        }
+
+        //! Skip n lines which are not empty, without reading them
+        /*!
+          * Stop at the end of the buffer if there are less than n such lines.
+         */
+        void skip_lines(size_t n)
+        {
+            for (size_t i = 0; i < n && !eof(); ++i) {
+                const char* eol = static_cast<const char*>(std::memchr(_cur, '\n', _end - _cur));
+                _cur = nullptr == eol ? _end : eol;
+            }
+        }
+
+        //! Read a size (a non negative integer)
+        size_t read_size()
+        {
+            skip_spaces();
+
+            size_t v = 0;
+            auto result = std::from_chars(_cur, _end, v);
+
+            if (std::errc() != result.ec || !_ends_token(result.ptr)) {
+                throw ws_parse_error(_line, "expected a size, found '" + _token() + "'");
+            }
+
+            _cur = result.ptr;
+            return v;
+        }
+
+        //! Read a word (sequence of non space characters), such as the alphabet
+        std::string read_word()
+        {
+            skip_spaces();
+
+            const char* begin = _cur;
+
+            while (_cur != _end && !_is_space(*_cur)) {
+                ++_cur;
+            }
+
+            if (begin == _cur) {
+                throw ws_parse_error(_line, "unexpected end of file");
+            }
+
+            return std::string(begin, _cur);
+        }
+
+        //! Read one position: σ probabilities on a single line
+        /*!
+          * \tparam Container   Container param for weighted_char
+          *
+          * Probabilities equal to 0 are not stored in the container, which allocates with alloc if it uses it.
+         */
+        template <class Container, class Alloc = std::allocator<Container>>
+        Container read_position(const std::string& alph, const Alloc& alloc = Alloc())
+        {
+            skip_spaces();
+
+            Container wc = make_container<Container>(alloc);
+            size_t line = _line;
+
+            for (size_t k = 0; k < alph.size(); ++k) {
+                _skip_blanks();
+
+                if (_cur == _end || '\n' == *_cur || '\r' == *_cur) {
+                    throw ws_parse_error(line, "expected " + std::to_string(alph.size()) + " probabilities, found " + std::to_string(k));
+                }
+
+                double v = _read_double();
+
+                if (0. != v) {
+                    try {
+                        wc[alph[k]] = v;
+                    }
+                    catch (const std::runtime_error& e) {
+                        throw ws_parse_error(line, e.what());
+                    }
+                }
+            }
+
+            _skip_blanks();
+
+            if (_cur != _end && '\n' != *_cur && '\r' != *_cur) {
+                throw ws_parse_error(line, "expected " + std::to_string(alph.size()) + " probabilities, found more");
+            }
+
+            return wc;
+        }
+
+        //! Read n positions and append them to a weighted string
+        /*!
+          * \tparam Container   Same as Container param for weighted_element
+          *
+          * \throw ws_parse_error on syntax error, or if strict is true and the sum of probabilities of a position is not 1.
+         */
+        template <class Container, class Allocator>
+        void read_positions(weighted_string<Container, Allocator>& ws, size_t n, const std::string& alph, bool strict, double precision)
+        {
+            reserve_positions(ws, n);
+
+            for (size_t i = 0; i < n; ++i) {
+                if (eof()) {
+                    throw ws_parse_error(_line, "expected " + std::to_string(n) + " positions, found " + std::to_string(i));
+                }
+
+                size_t line = _line;
+
+                try {
+                    ws.emplace_back(read_position<Container>(alph, ws.get_allocator()), strict, precision);
+                }
+                catch (const std::invalid_argument& e) {
+                    throw ws_parse_error(line, e.what());
+                }
+            }
+        }
+
+    private:
+
+        static bool _is_space(char c)
+        {
+            return ' ' == c || '\t' == c || '\n' == c || '\r' == c || '\v' == c || '\f' == c;
+        }
+
+        //! Skip spaces and tabulations but not line breaks
+        void _skip_blanks()
+        {
+            while (_cur != _end && (' ' == *_cur || '\t' == *_cur || '\v' == *_cur || '\f' == *_cur)) {
+                ++_cur;
+            }
+        }
+
+        bool _ends_token(const char* p) const
+        {
+            return p == _end || _is_space(*p);
+        }
+
+        //! The token at the current position, for error messages
+        std::string _token() const
+        {
+            const char* p = _cur;
+
+            while (p != _end && !_is_space(*p)) {
+                ++p;
+            }
+
+            return p == _cur ? std::string("end of file") : std::string(_cur, p);
+        }
+
+        double _read_double()
+        {
+            const char* begin = _cur;
+
+            // std::from_chars does not accept the + sign
+            if ('+' == *begin && begin + 1 != _end && '-' != begin[1]) {
+                ++begin;
+            }
+
+            double v;
+            auto result = std::from_chars(begin, _end, v);
+
+            if (std::errc() != result.ec || !_ends_token(result.ptr)) {
+                throw ws_parse_error(_line, "expected a probability, found '" + _token() + "'");
+            }
+
+            _cur = result.ptr;
+            return v;
+        }
+};
+
+
+//! Read a weighted string from a buffer containing the same format as the >> operator
+/*!
+  * \tparam Container   Same as Container param for weighted_element
+  *
+  * \param options     Same options as the stream manipulators (ws_strict, ws_gap, ws_set_precision)
+  *
+  * The weighted string is cleared before reading.
+  *
+  * \throw ws_parse_error on error, with the line of the error
+ */
+template <class Container, class Allocator>
+void parse_ws(const char* first, const char* last, weighted_string<Container, Allocator>& ws, const ws_options& options = ws_options())
+{
+    ws_buffer_reader reader(first, last);
+
+    size_t n = reader.read_size();
+    std::string alph = reader.read_word();
+
+    ws.clear();
+
+    if (options.gap) {
+        ws.set_gap(alph.back());
+    }
+
+    reader.read_positions(ws, n, alph, options.strict, options.precision);
+}
+
+//! Read a collection of weighted strings from a buffer containing the same format as the >> operator
+/*!
+  * \tparam Container   Container parameter of weighted_string
+  * \tparam Collection  Any collection with two template parameters such as STL collection
+  * \tparam WAllocator  Allocator parameter of weighted_string
+  * \tparam Allocator   The allocator for the weighted strings
+  *
+  * Weighted strings are created with the allocator of the collection when they use it.
+  *
+  * \throw ws_parse_error on error, with the line of the error
+ */
+template <
+    class Container,
+    class WAllocator,
+    template <class, class> class Collection,
+    class Allocator
+>
+void parse_ws(const char* first, const char* last, Collection<weighted_string<Container, WAllocator>, Allocator>& wsc, const ws_options& options = ws_options())
+{
+    ws_buffer_reader reader(first, last);
+
+    size_t l = reader.read_size();
+    std::string alph = reader.read_word();
+
+    wsc.clear();
+
+    for (size_t _ = 0; _ < l; ++_) {
+        size_t n = reader.read_size();
+        auto ws = make_container<weighted_string<Container, WAllocator>>(wsc.get_allocator());
+
+        if (options.gap) {
+            ws.set_gap(alph.back());
+        }
+
+        reader.read_positions(ws, n, alph, options.strict, options.precision);
+
+        wsc.push_back(std::move(ws));
+    }
+}
+
+//! Read a collection of weighted strings from a buffer with several threads
+/*!
+  * \tparam Container   Container parameter of weighted_string
+  * \tparam Collection  Any collection with two template parameters such as STL collection
+  * \tparam WAllocator  Allocator parameter of weighted_string
+  * \tparam Allocator   The allocator for the weighted strings
+  * \param options     Same options as the stream manipulators (ws_strict, ws_gap, ws_set_precision)
+  * \param threads     Number of threads (0 to use one thread per core)
+  *
+  * A first pass reads the size of each weighted string and skips its lines to find where the next one starts.
+  * Then weighted strings are parsed concurrently and moved into the collection.
+  *
+  * Weighted strings are created with the allocator of the collection, so a memory resource given to the
+  * collection should be thread-safe (such as std::pmr::synchronized_pool_resource).
+  *
+  * The result is the same as parse_ws. Errors are deterministic: if several weighted strings are not valid,
+  * the reported error is always the one of the first of them.
+  *
+  * \throw ws_parse_error on error, with the line of the error
+ */
+template <
+    class Container,
+    class WAllocator,
+    template <class, class> class Collection,
+    class Allocator
+>
+void parse_ws_parallel(const char* first, const char* last, Collection<weighted_string<Container, WAllocator>, Allocator>& wsc,
+                       const ws_options& options = ws_options(), size_t threads = 0)
+{
+    struct range
+    {
+        const char* first;
+        const char* last;
+        size_t line;
+        size_t size;
+    };
+
+    ws_buffer_reader reader(first, last);
+
+    size_t l = reader.read_size();
+    std::string alph = reader.read_word();
+
+    std::vector<range> ranges;
+    ranges.reserve(std::min<size_t>(l, last - first));
+
+    // Error of the first pass, which comes after the errors of all weighted strings found before it
+    std::exception_ptr scan_error;
+
+    try {
+        for (size_t _ = 0; _ < l; ++_) {
+            reader.skip_spaces();
+
+            if (!ranges.empty()) {
+                ranges.back().last = reader.position();
+            }
+
+            size_t n = reader.read_size();
+
+            ranges.push_back({reader.position(), last, reader.line(), n});
+            reader.skip_lines(n);
+        }
+    }
+    catch (...) {
+        scan_error = std::current_exception();
+    }
+
+    std::vector<weighted_string<Container, WAllocator>> result;
+    result.reserve(ranges.size());
+
+    for (size_t i = 0; i < ranges.size(); ++i) {
+        result.push_back(make_container<weighted_string<Container, WAllocator>>(wsc.get_allocator()));
+    }
+
+    std::vector<std::exception_ptr> errors(ranges.size());
+
+    parallel_for(ranges.size(), 1, threads, [&](size_t i, size_t) {
+        try {
+            ws_buffer_reader string_reader(ranges[i].first, ranges[i].last, ranges[i].line);
+
+            if (options.gap) {
+                result[i].set_gap(alph.back());
+            }
+
+            string_reader.read_positions(result[i], ranges[i].size, alph, options.strict, options.precision);
+        }
+        catch (...) {
+            errors[i] = std::current_exception();
+        }
+    });
+
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    if (scan_error) {
+        std::rethrow_exception(scan_error);
+    }
+
+    wsc.clear();
+
+    for (weighted_string<Container, WAllocator>& ws : result) {
+        wsc.push_back(std::move(ws));
+    }
+}
+
+//! Open a file in binary mode, for the readers which keep a stream on the file
+/*!
+  * \throw std::runtime_error if the file cannot be opened
+ */
+inline std::unique_ptr<std::ifstream> open_file(const std::string& path, std::ios::openmode mode = std::ios::binary)
+{
+    std::unique_ptr<std::ifstream> file(new std::ifstream(path, mode | std::ios::binary));
+
+    if (!*file) {
+        throw std::runtime_error("cannot open file " + path);
+    }
+
+    return file;
+}
+
+//! Read the whole content of a file
+/*!
+  * \throw std::runtime_error if the file cannot be read
+ */
+inline std::string read_file(const std::string& path)
+{
+    std::unique_ptr<std::ifstream> in = open_file(path, std::ios::ate);
+
+    std::string buffer(static_cast<size_t>(in->tellg()), '\0');
+    in->seekg(0);
+    in->read(&buffer[0], buffer.size());
+
+    return buffer;
+}
+
+//! Read a weighted string (or a collection) from a file with the buffer reader
+/*!
+  * \tparam WString     A weighted string or a collection of weighted strings
+  *
+  * \sa wstr::parse_ws
+ */
+template <class WString>
+void load_ws(const std::string& path, WString& ws, const ws_options& options = ws_options())
+{
+    std::string buffer = read_file(path);
+    parse_ws(buffer.data(), buffer.data() + buffer.size(), ws, options);
+}
+
+//! Read a collection of weighted strings from a file with several threads
+/*!
+  * \sa wstr::parse_ws_parallel
+ */
+template <class WStringCollection>
+void load_ws_parallel(const std::string& path, WStringCollection& wsc, const ws_options& options = ws_options(), size_t threads = 0)
+{
+    std::string buffer = read_file(path);
+    parse_ws_parallel(buffer.data(), buffer.data() + buffer.size(), wsc, options, threads);
+}
+
+}
\ No newline at end of file
@@ -0,0 +1,297 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <exception>
+#include <stdexcept>
+#include <algorithm>
+
+#include "weighted_parallel.hpp"
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+//! SplitMix64 pseudo-random generator, a UniformRandomBitGenerator with a 64-bit state
+/*!
+  * It is fast, passes statistical test suites such as BigCrush, and any 64-bit seed gives a good stream,
+  * so one generator can be seeded for each sample of a batch.
+ */
+class splitmix64
+{
+    public:
+
+        typedef std::uint64_t result_type;
+
+    private:
+
+        std::uint64_t _state;
+
+    public:
+
+        explicit splitmix64(std::uint64_t seed = 0) : _state(seed)
+        {
+
+        }
+
+        static constexpr result_type min()
+        {
+            return 0;
+        }
+
+        static constexpr result_type max()
+        {
+            return ~result_type(0);
+        }
+
+        result_type operator()()
+        {
+            return mix(_state += 0x9E3779B97F4A7C15);
+        }
+
+        //! Finalizer of SplitMix64, a bijection which mixes the bits of x
+        static constexpr std::uint64_t mix(std::uint64_t x)
+        {
+            x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9;
+            x = (x ^ (x >> 27)) * 0x94D049BB133111EB;
+            return x ^ (x >> 31);
+        }
+
+        //! Generator of the k-th stream of a seed, streams of different k are independent
+        static splitmix64 stream(std::uint64_t seed, std::uint64_t k)
+        {
+            return splitmix64(mix(seed ^ mix(k + 1)));
+        }
+};
+
+
+//! Sampler of random strings from the distribution of a weighted string
+/*!
+  * Each position of the weighted string is turned into a Walker alias table once: a position with m non-zero
+  * probabilities has m entries, each one with a letter, an alias letter and a threshold. A letter is drawn with
+  * a single random number: its high bits choose an entry, its low bits are compared to the threshold of the
+  * entry. Thresholds are stored on 32 bits, so probabilities are rounded to multiples of 2^-32 of their sum.
+  *
+  * All tables are stored in one array, so the sampler does not depend on the Container of the weighted string
+  * and drawing a string of n letters costs O(n) without allocation. Probabilities do not need to sum to 1,
+  * they are normalized by their sum.
+  *
+  * As for `heaviest` and `heaviest_ungap`, gaps are either kept or removed from the samples (`with_gap`).
+  *
+  *     ws_sampler sampler(ws);
+  *     splitmix64 rng(42);
+  *     std::string s(sampler.size(), '\0');
+  *     s.resize(sampler.sample(&s[0], rng));
+  *
+  * \sa wstr::splitmix64
+ */
+class ws_sampler
+{
+    public:
+
+        //! One entry of an alias table
+        struct entry
+        {
+            //! The letter is chosen if the low 32 bits of the random number are lower than the threshold
+            std::uint32_t threshold;
+            char letter;
+            char alias;
+        };
+
+    private:
+
+        std::vector<entry> _entries;
+        std::vector<size_t> _offsets = {0};
+        char _gap = NO_GAP;
+
+    public:
+
+        ws_sampler()
+        {
+
+        }
+
+        //! Build the alias tables of a weighted string (or a view)
+        /*!
+          * \throw std::invalid_argument if a position has no positive probability
+         */
+        template <class WString>
+        explicit ws_sampler(const WString& ws) : _gap(ws.gap())
+        {
+            _offsets.reserve(ws.size() + 1);
+
+            // Buffers reused for all positions
+            std::vector<std::pair<char, double>> probabilities;
+            std::vector<double> scaled;
+            std::vector<size_t> small, large;
+
+            for (const auto& wc : ws) {
+                probabilities.clear();
+
+                wc.probabilities().for_each([&probabilities](char c, double p) {
+                    if (p > 0.) {
+                        probabilities.emplace_back(c, p);
+                    }
+                });
+
+                _add_position(probabilities, scaled, small, large);
+            }
+        }
+
+        //! Number of positions
+        size_t size() const
+        {
+            return _offsets.size() - 1;
+        }
+
+        bool has_gap() const
+        {
+            return NO_GAP != _gap;
+        }
+
+        char gap() const
+        {
+            return _gap;
+        }
+
+        //! Alias table of a position
+        const entry* table(size_t i) const
+        {
+            return _entries.data() + _offsets[i];
+        }
+
+        //! Number of entries of the alias table of a position
+        size_t table_size(size_t i) const
+        {
+            return _offsets[i + 1] - _offsets[i];
+        }
+
+        //! Draw a letter at a position with a random number
+        char letter(size_t i, std::uint64_t r) const
+        {
+            std::uint64_t m = _offsets[i + 1] - _offsets[i];
+            const entry& e = _entries[_offsets[i] + (((r >> 32) * m) >> 32)];
+
+            return static_cast<std::uint32_t>(r) < e.threshold ? e.letter : e.alias;
+        }
+
+        //! Draw a string
+        /*!
+          * \param out      Output, should have size() chars
+          * \param rng      A UniformRandomBitGenerator of 64-bit numbers (such as splitmix64 or std::mt19937_64)
+          * \param with_gap If false, gaps are not written
+          *
+          * \return the number of letters written
+         */
+        template <class Rng>
+        size_t sample(char* out, Rng& rng, bool with_gap = true) const
+        {
+            static_assert(Rng::max() - Rng::min() == ~std::uint64_t(0), "The generator should give 64-bit numbers");
+
+            size_t w = 0;
+
+            for (size_t i = 0; i < size(); ++i) {
+                char c = letter(i, static_cast<std::uint64_t>(rng() - Rng::min()));
+
+                out[w] = c;
+                w += with_gap || c != _gap;
+            }
+
+            return w;
+        }
+
+        //! Draw a batch of strings, the sample k is drawn with the stream first + k of the seed
+        /*!
+          * \param out      Output, the sample k is written at out + k * size()
+          * \param lengths  Output, length of each sample (can be null if with_gap is true)
+          * \param count    Number of samples
+          * \param seed     Seed of the streams
+          * \param first    Index of the first sample, to split a batch
+          * \param threads  Number of threads (0 to use one thread per core)
+          * \param with_gap If false, gaps are not written
+          *
+          * Each sample has its own random stream, so the samples do not depend on the number of threads and
+          * a batch of count samples gives the same samples as two batches with first = 0 and first = count / 2.
+         */
+        void sample_batch(char* out, size_t* lengths, size_t count, std::uint64_t seed, size_t first = 0,
+                          size_t threads = 1, bool with_gap = true) const
+        {
+            parallel_for(count, 64, threads, [&](size_t begin, size_t end) {
+                for (size_t k = begin; k < end; ++k) {
+                    splitmix64 rng = splitmix64::stream(seed, first + k);
+                    size_t length = sample(out + k * size(), rng, with_gap);
+
+                    if (nullptr != lengths) {
+                        lengths[k] = length;
+                    }
+                }
+            });
+        }
+
+    private:
+
+        //! Build the alias table of a position with Vose's method
+        void _add_position(const std::vector<std::pair<char, double>>& probabilities, std::vector<double>& scaled,
+                           std::vector<size_t>& small, std::vector<size_t>& large)
+        {
+            size_t m = probabilities.size();
+
+            if (0 == m) {
+                throw std::invalid_argument("A position has no positive probability");
+            }
+
+            double sum = 0.;
+
+            for (const auto& p : probabilities) {
+                sum += p.second;
+            }
+
+            size_t offset = _entries.size();
+
+            scaled.resize(m);
+            small.clear();
+            large.clear();
+
+            for (size_t j = 0; j < m; ++j) {
+                scaled[j] = probabilities[j].second * m / sum;
+                (scaled[j] < 1. ? small : large).push_back(j);
+
+                _entries.push_back({0, probabilities[j].first, probabilities[j].first});
+            }
+
+            while (!small.empty() && !large.empty()) {
+                size_t s = small.back();
+                size_t l = large.back();
+                small.pop_back();
+
+                _entries[offset + s].threshold = _threshold(scaled[s]);
+                _entries[offset + s].alias = probabilities[l].first;
+
+                scaled[l] -= 1. - scaled[s];
+
+                if (scaled[l] < 1.) {
+                    large.pop_back();
+                    small.push_back(l);
+                }
+            }
+
+            // Entries left have a probability 1 up to rounding errors, their letter is always chosen
+            for (size_t j : small) {
+                _entries[offset + j].threshold = ~std::uint32_t(0);
+            }
+
+            for (size_t j : large) {
+                _entries[offset + j].threshold = ~std::uint32_t(0);
+            }
+
+            _offsets.push_back(_entries.size());
+        }
+
+        static std::uint32_t _threshold(double q)
+        {
+            double t = q * 4294967296.;
+            return t >= 4294967295. ? ~std::uint32_t(0) : static_cast<std::uint32_t>(t);
+        }
+};
+
+}
\ No newline at end of file
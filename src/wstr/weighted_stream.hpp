@@ -0,0 +1,397 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstring>
+#include <fstream>
+#include <exception>
+#include <condition_variable>
+
+#include "weighted_reader.hpp"
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+//! Reader of a weighted string file by blocks of positions, with a bounded memory
+/*!
+  * \tparam Container   Container param for weighted_char
+  *
+  * The reader accepts the format of a single weighted string, with the constraints of the buffer reader
+  * (each position on its own line). The size and the alphabet are read by the constructor, then each call
+  * to `next` gives a view on the next block of `block_size` positions (the last block can be smaller):
+  *
+  *     ws_stream_reader<dna_container<dna_alph>> reader("my_file");
+  *     weighted_string_view<dna_container<dna_alph>> block;
+  *
+  *     while (reader.next(block)) {
+  *         // positions [reader.block_position(), reader.block_position() + block.size())
+  *     }
+  *
+  * Positions are parsed into two buffers which are reused for all blocks (double buffering): by default a
+  * thread parses the next block while the current one is processed. A view stays valid until the next call
+  * to `next`, so the memory used is two blocks and a buffer of the file whatever the size of the file.
+  *
+  * \sa wstr::ws_buffer_reader
+ */
+template <class Container>
+class ws_stream_reader
+{
+    public:
+
+        typedef weighted_string_view<Container> block_type;
+
+        //! Size in bytes of each read of the input
+        static constexpr size_t chunk_size = 1 << 16;
+
+    private:
+
+        //! One of the two buffers, and whether it holds a block ready to be processed
+        struct slot
+        {
+            weighted_string<Container> ws;
+            size_t position = 0;
+            bool full = false;
+            bool last = false;
+            std::exception_ptr error;
+        };
+
+        std::unique_ptr<std::ifstream> _file;
+        std::istream& _in;
+        size_t _block_size;
+        ws_options _options;
+        bool _background;
+
+        // Text read from the input and not parsed yet, in [_text_begin, _text_end)
+        std::vector<char> _text;
+        size_t _text_begin = 0;
+        size_t _text_end = 0;
+        size_t _line = 0;
+
+        size_t _size = 0;
+        std::string _alph;
+        size_t _parsed = 0;
+
+        slot _slots[2];
+        size_t _produced = 0;
+        size_t _consumed = 0;
+        bool _holding = false;
+        bool _done = false;
+        size_t _block_position = 0;
+
+        bool _stop = false;
+        std::mutex _mutex;
+        std::condition_variable _cv;
+        std::thread _thread;
+
+    public:
+
+        //! Read the size and the alphabet of a weighted string from a stream
+        /*!
+          * \param in           The input, which should live as long as the reader
+          * \param block_size   Number of positions of each block
+          * \param options      Same options as the stream manipulators (ws_strict, ws_gap, ws_set_precision)
+          * \param background   If true, a thread parses the next block while the current one is processed
+          *
+          * \throw ws_parse_error if the size or the alphabet cannot be read
+         */
+        ws_stream_reader(std::istream& in, size_t block_size = 1 << 16, const ws_options& options = ws_options(), bool background = true)
+            : _in(in), _block_size(std::max<size_t>(1, block_size)), _options(options), _background(background)
+        {
+            _start();
+        }
+
+        //! Same on a file
+        /*!
+          * \throw std::runtime_error if the file cannot be opened
+          * \throw ws_parse_error if the size or the alphabet cannot be read
+         */
+        explicit ws_stream_reader(const std::string& path, size_t block_size = 1 << 16, const ws_options& options = ws_options(), bool background = true)
+            : _file(open_file(path)), _in(*_file), _block_size(std::max<size_t>(1, block_size)), _options(options), _background(background)
+        {
+            _start();
+        }
+
+        ws_stream_reader(const ws_stream_reader&) = delete;
+        ws_stream_reader& operator=(const ws_stream_reader&) = delete;
+
+        ~ws_stream_reader()
+        {
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _stop = true;
+            }
+
+            _cv.notify_all();
+
+            if (_thread.joinable()) {
+                _thread.join();
+            }
+        }
+
+        //! Number of positions of the weighted string
+        size_t size() const
+        {
+            return _size;
+        }
+
+        //! Alphabet of the file
+        const std::string& alphabet() const
+        {
+            return _alph;
+        }
+
+        //! Number of positions of each block (except the last one)
+        size_t block_size() const
+        {
+            return _block_size;
+        }
+
+        //! Position in the weighted string of the first position of the last block given by next
+        size_t block_position() const
+        {
+            return _block_position;
+        }
+
+        //! Give the next block of positions, the previous block is not valid anymore
+        /*!
+          * \return false if all positions have been read
+          *
+          * \throw ws_parse_error if a position of the block is not valid (then next always returns false)
+         */
+        bool next(block_type& block)
+        {
+            if (_done) {
+                return false;
+            }
+
+            slot* s;
+
+            if (_background) {
+                std::unique_lock<std::mutex> lock(_mutex);
+
+                if (_holding) {
+                    _slots[_consumed++ % 2].full = false;
+                    _cv.notify_all();
+                }
+
+                s = &_slots[_consumed % 2];
+                _cv.wait(lock, [s]() { return s->full; });
+            }
+            else {
+                s = &_slots[0];
+                _fill(*s);
+            }
+
+            _holding = true;
+
+            if (s->error) {
+                _done = true;
+                std::rethrow_exception(s->error);
+            }
+
+            _done = s->last && s->ws.empty();
+
+            if (_done) {
+                return false;
+            }
+
+            block = block_type(s->ws);
+            _block_position = s->position;
+
+            return true;
+        }
+
+    private:
+
+        //! Read the header, prepare the buffers and start the thread
+        void _start()
+        {
+            _read_header();
+
+            for (slot& s : _slots) {
+                s.ws.reserve(std::min(_block_size, _size));
+
+                if (_options.gap) {
+                    s.ws.set_gap(_alph.back());
+                }
+            }
+
+            if (_background) {
+                _thread = std::thread([this]() { _produce(); });
+            }
+        }
+
+        //! Next line of the input (without the line break), false at the end of the input
+        bool _next_line(const char*& first, const char*& last)
+        {
+            while (true) {
+                // The buffer is empty (and its data may be null) before the first chunk
+                const char* eol = _text_begin == _text_end ? nullptr
+                    : static_cast<const char*>(std::memchr(_text.data() + _text_begin, '\n', _text_end - _text_begin));
+
+                if (nullptr != eol || !_refill()) {
+                    if (nullptr == eol && _text_begin == _text_end) {
+                        return false;
+                    }
+
+                    first = _text.data() + _text_begin;
+                    last = nullptr == eol ? _text.data() + _text_end : eol;
+                    _text_begin = nullptr == eol ? _text_end : eol + 1 - _text.data();
+                    ++_line;
+
+                    return true;
+                }
+            }
+        }
+
+        //! Read the next chunk of the input after the text which is not parsed yet, false at the end of the input
+        bool _refill()
+        {
+            if (!_in) {
+                return false;
+            }
+
+            // Keep the text which is not parsed at the beginning of the buffer, and make room for a chunk
+            if (_text_begin < _text_end) {
+                std::memmove(_text.data(), _text.data() + _text_begin, _text_end - _text_begin);
+            }
+
+            _text_end -= _text_begin;
+            _text_begin = 0;
+
+            if (_text.size() < _text_end + chunk_size) {
+                _text.resize(_text_end + chunk_size);
+            }
+
+            _in.read(_text.data() + _text_end, chunk_size);
+            size_t count = static_cast<size_t>(_in.gcount());
+            _text_end += count;
+
+            return count > 0;
+        }
+
+        //! Read the size and the alphabet, which can be on one or two lines
+        void _read_header()
+        {
+            const char* first;
+            const char* last;
+
+            std::vector<std::string> tokens;
+
+            while (tokens.size() < 2 && _next_line(first, last)) {
+                ws_buffer_reader reader(first, last, _line);
+
+                while (tokens.size() < 2 && !reader.eof()) {
+                    tokens.push_back(reader.read_word());
+                }
+
+                if (!reader.eof()) {
+                    throw ws_parse_error(_line, "unexpected data after the alphabet");
+                }
+            }
+
+            if (tokens.size() < 2) {
+                throw ws_parse_error(_line, "unexpected end of file");
+            }
+
+            _size = ws_buffer_reader(tokens[0]).read_size();
+            _alph = tokens[1];
+        }
+
+        //! Parse the next block into a slot, errors are stored in the slot
+        void _fill(slot& s)
+        {
+            s.ws.clear();
+            s.position = _parsed;
+            s.error = nullptr;
+
+            try {
+                size_t n = std::min(_block_size, _size - _parsed);
+                const char* first;
+                const char* last;
+
+                while (s.ws.size() < n) {
+                    if (!_next_line(first, last)) {
+                        throw ws_parse_error(_line, "expected " + std::to_string(_size) + " positions, found " + std::to_string(_parsed));
+                    }
+
+                    ws_buffer_reader reader(first, last, _line);
+
+                    if (reader.eof()) {
+                        continue;
+                    }
+
+                    try {
+                        s.ws.emplace_back(reader.read_position<Container>(_alph), _options.strict, _options.precision);
+                    }
+                    catch (const std::invalid_argument& e) {
+                        throw ws_parse_error(_line, e.what());
+                    }
+
+                    ++_parsed;
+                }
+            }
+            catch (...) {
+                s.error = std::current_exception();
+            }
+
+            s.last = _parsed == _size || s.error;
+        }
+
+        //! Parse all blocks in the background, each block waits until its slot has been released
+        void _produce()
+        {
+            while (true) {
+                slot& s = _slots[_produced % 2];
+
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cv.wait(lock, [this, &s]() { return _stop || !s.full; });
+
+                    if (_stop) {
+                        return;
+                    }
+                }
+
+                _fill(s);
+
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    s.full = true;
+                    ++_produced;
+                }
+
+                _cv.notify_all();
+
+                if (s.last && (s.error || s.ws.empty())) {
+                    return;
+                }
+
+                if (s.last) {
+                    // An empty block marks the end
+                    slot& end = _slots[_produced % 2];
+
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cv.wait(lock, [this, &end]() { return _stop || !end.full; });
+
+                    if (!_stop) {
+                        end.ws.clear();
+                        end.error = nullptr;
+                        end.last = true;
+                        end.full = true;
+                        ++_produced;
+                        lock.unlock();
+                        _cv.notify_all();
+                    }
+
+                    return;
+                }
+            }
+        }
+};
+
+}
\ No newline at end of file
@@ -3,14 +3,19 @@
 #include <vector>
 #include <cstring>
 #include <iostream>
+#include <memory_resource>
 
 #include "weighted_char.hpp"
+#include "weighted_kernels.hpp"
 
 #define NO_GAP -1
 
 namespace wstr
 {
 
+//! Absolute tolerance of the algorithms comparing sums of log-probabilities with a threshold log(1/z)
+inline constexpr double log_epsilon = 1e-10;
+
 //! A class for weighted strings based on a collection (std::vector) of weighted characters.
 /*! 
   * \tparam Container   Same as Container param for weighted_char
@@ -44,6 +49,23 @@ class weighted_string : public std::vector<weighted_char<Container>, Allocator>
         //! Allow all other std::vector constructors
         using std::vector<weighted_char<Container>, Allocator>::vector;
 
+        weighted_string()
+        {
+
+        }
+
+        //! Copy with another allocator, which is also given to the containers of the weighted chars if they use it
+        weighted_string(const weighted_string& oth, const Allocator& alloc) : std::vector<weighted_char<Container>, Allocator>(oth, alloc), _gap(oth._gap)
+        {
+
+        }
+
+        //! Move with another allocator (weighted chars are moved one by one if the allocators are not equal)
+        weighted_string(weighted_string&& oth, const Allocator& alloc) : std::vector<weighted_char<Container>, Allocator>(std::move(oth), alloc), _gap(oth._gap)
+        {
+
+        }
+
         void set_gap(char gap)
         {
             _gap = gap;
@@ -69,20 +91,47 @@ class weighted_string : public std::vector<weighted_char<Container>, Allocator>
             return _heaviest(false);
         }
 
-    private:
+        //! Write the heaviest string into a preallocated output (which should have size() chars), return its length
+        size_t heaviest(char* out) const
+        {
+            return heaviest_into(this->data(), this->size(), out, _gap, true);
+        }
 
-        std::string _heaviest(bool with_gap) const
+        //! Write the heaviest string without gaps into a preallocated output (which should have size() chars), return its length
+        size_t heaviest_ungap(char* out) const
         {
-            std::string h = "";
+            return heaviest_into(this->data(), this->size(), out, _gap, false);
+        }
 
-            for (const w_char& wc : *this) {
-                char c = wc.heaviest_value();
-                
-                if (with_gap || c != _gap) {
-                    h += c;
-                }
+        //! Return the natural logarithm of the probability that a solid string occurs at a given position
+        /*!
+          * The probability is the product of probabilities of each letter, so its logarithm is a sum which
+          * does not underflow on long strings (especially with log-probability containers).
+          *
+          * \throw std::out_of_range if the string goes beyond the end of the weighted string
+         */
+        double log_p(size_t pos, const std::string& s) const
+        {
+            if (pos + s.size() > this->size()) {
+                throw std::out_of_range("The string goes beyond the end of the weighted string");
+            }
+
+            double log = 0.;
+
+            for (size_t j = 0; j < s.size(); ++j) {
+                log += (*this)[pos + j].log_p(s[j]);
             }
 
+            return log;
+        }
+
+    private:
+
+        std::string _heaviest(bool with_gap) const
+        {
+            std::string h(this->size(), '\0');
+            h.resize(heaviest_into(this->data(), this->size(), &h[0], _gap, with_gap));
+
             return h;
         }
 };
@@ -105,7 +154,12 @@ template<
 >
 class weighted_string_collection : public Collection<WString, Allocator>
 {
-    
+    public:
+
+        typedef Collection<WString, Allocator> base_type;
+
+        //! Allow all constructors of the Collection, such as the one with an allocator
+        using base_type::base_type;
 };
 
 
@@ -125,7 +179,7 @@ struct basic_ws_translator
     public:
 
         //! Return the indice of a letter inside the array
-        //! TODO: Find a O(1) way to do this
+        //! This is a linear scan of the alphabet, see wstr::static_ws_translator for a O(1) lookup
         static size_t get_indice(char c)
         {
             for (size_t i = 0; i < strlen(alph); ++i) {
@@ -143,6 +197,79 @@ struct basic_ws_translator
         }
 };
 
+//! Translator for weighted string using a w_array Container with an index table built at compile time
+/*!
+  * \tparam alph    The string representing the alphabet of the weighted_string
+  *
+  * The indice of each letter is stored in a 256-entry table, so the lookup of a letter is a single memory access.
+  * Letters outside of the alphabet are mapped to `npos` by `find_indice`, which allows w_array::at to return 0
+  * without throwing. If a letter appears several times in the alphabet, its first position is kept.
+  *
+  * Like basic_ws_translator, the alphabet should be a static const variable.
+  *
+  * \sa wstr::basic_ws_translator
+  * \sa wstr::w_array
+ */
+template <const char* alph>
+struct static_ws_translator
+{
+    public:
+
+        //! Indice returned for letters which are not in the alphabet
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        //! Size of the alphabet
+        static constexpr size_t size = strlen(alph);
+
+        static_assert(size < 0xFF, "The alphabet of a static_ws_translator must have less than 255 letters");
+
+        //! Return the indice of a letter inside the array or npos if the letter is not in the alphabet
+        static constexpr size_t find_indice(char c) noexcept
+        {
+            unsigned char i = _table[static_cast<unsigned char>(c)];
+            return _absent == i ? npos : i;
+        }
+
+        //! Return the indice of a letter inside the array
+        static size_t get_indice(char c)
+        {
+            size_t i = find_indice(c);
+
+            if (npos == i) {
+                throw std::runtime_error("character " + std::string(1, c) + " doesn't exists in the alphabet");
+            }
+
+            return i;
+        }
+
+        static const char& get_element(size_t i)
+        {
+            return alph[i];
+        }
+
+    private:
+
+        static constexpr unsigned char _absent = 0xFF;
+
+        //! Letters are written from the end of the alphabet so the first position of a repeated letter is kept
+        static constexpr std::array<unsigned char, 256> _build_table()
+        {
+            std::array<unsigned char, 256> table{};
+
+            for (size_t c = 0; c < table.size(); ++c) {
+                table[c] = _absent;
+            }
+
+            for (size_t k = size; k-- > 0;) {
+                table[static_cast<unsigned char>(alph[k])] = static_cast<unsigned char>(k);
+            }
+
+            return table;
+        }
+
+        static constexpr std::array<unsigned char, 256> _table = _build_table();
+};
+
 //! weighted char using map
 using w_char_map = wc_map<>;
 
@@ -152,12 +279,21 @@ using w_string_map = weighted_string<w_char_map>;
 //! weighted string collection for weighted string using map
 using w_string_map_collection = weighted_string_collection<w_string_map>;
 
+//! weighted char storing only non-zero probabilities
+using w_char_sparse = wc_sparse<>;
+
+//! weighted string using a sparse container as weighted element
+using w_string_sparse = weighted_string<w_char_sparse>;
+
+//! weighted string collection for weighted string using sparse containers
+using w_string_sparse_collection = weighted_string_collection<w_string_sparse>;
+
 //! weighted char using an array
 /*!
   * \tparam alph    The alphabet of the weighted char
  */
 template <const char* alph>
-using w_char_array = wc_array<strlen(alph), basic_ws_translator<alph>>;
+using w_char_array = wc_array<static_ws_translator<alph>::size, static_ws_translator<alph>>;
 
 //! weighted string using an array as weighted element
 /*!
@@ -174,86 +310,248 @@ template <const char* alph>
 using w_string_array_collection = weighted_string_collection<w_string_array<alph>>;
 
 
+//! weighted char using an array of log-probabilities
+/*!
+  * \tparam alph    The alphabet of the weighted char
+ */
+template <const char* alph>
+using w_char_log_array = wc_log_array<static_ws_translator<alph>::size, static_ws_translator<alph>>;
+
+//! weighted string using an array of log-probabilities as weighted element
+/*!
+  * \tparam alph    The alphabet of the weighted string
+ */
+template <const char* alph>
+using w_string_log_array = weighted_string<w_char_log_array<alph>>;
+
+//! weighted collection for weighted string using array of log-probabilities
+/*!
+  * \tparam alph    The alphabet of the weighted collection
+ */
+template <const char* alph>
+using w_string_log_array_collection = weighted_string_collection<w_string_log_array<alph>>;
+
+
+//! weighted char using an array of quantized probabilities
+/*!
+  * \tparam alph    The alphabet of the weighted char
+  * \tparam Storage float, or an unsigned integer type for fixed-point probabilities
+  * \tparam Scale   For integer storages, the value which represents the probability 1
+ */
+template <const char* alph, class Storage, std::uint64_t Scale = default_quantization_scale<Storage>()>
+using w_char_quantized_array = wc_quantized_array<static_ws_translator<alph>::size, static_ws_translator<alph>, Storage, Scale>;
+
+//! weighted string using an array of quantized probabilities as weighted element
+/*!
+  * \tparam alph    The alphabet of the weighted string
+  * \tparam Storage float, or an unsigned integer type for fixed-point probabilities
+  * \tparam Scale   For integer storages, the value which represents the probability 1
+ */
+template <const char* alph, class Storage, std::uint64_t Scale = default_quantization_scale<Storage>()>
+using w_string_quantized_array = weighted_string<w_char_quantized_array<alph, Storage, Scale>>;
+
+//! weighted collection for weighted string using array of quantized probabilities
+template <const char* alph, class Storage, std::uint64_t Scale = default_quantization_scale<Storage>()>
+using w_string_quantized_array_collection = weighted_string_collection<w_string_quantized_array<alph, Storage, Scale>>;
+
+//! weighted string storing probabilities as float (4 bytes per probability)
+template <const char* alph>
+using w_string_float_array = w_string_quantized_array<alph, float>;
+
+//! weighted string storing probabilities in 16-bit fixed point (2 bytes per probability)
+template <const char* alph>
+using w_string_u16_array = w_string_quantized_array<alph, std::uint16_t>;
+
+//! weighted string storing probabilities in 8-bit fixed point (1 byte per probability)
+template <const char* alph>
+using w_string_u8_array = w_string_quantized_array<alph, std::uint8_t>;
+
+
+//! Aliases of weighted strings and collections using polymorphic allocators (std::pmr)
+/*!
+  * The memory resource of a collection is given to its weighted strings, then to the containers of their
+  * positions (the nodes of the maps, the buffers of the sparse containers). A whole collection can then be
+  * read into a std::pmr::monotonic_buffer_resource and released at once without freeing each node:
+  *
+  *     std::pmr::monotonic_buffer_resource resource;
+  *     wstr::pmr::w_string_map_collection wsc(&resource);
+  *     in >> wsc;
+  *
+  * Containers which do not allocate (arrays) only have their weighted strings in the resource.
+ */
+namespace pmr
+{
+
+template <class Container>
+using weighted_string = wstr::weighted_string<Container, std::pmr::polymorphic_allocator<weighted_char<Container>>>;
+
+template <class WString>
+using weighted_string_collection = wstr::weighted_string_collection<WString, std::vector, std::pmr::polymorphic_allocator<WString>>;
+
+using w_char_map = wc_map<std::hash<char>, std::equal_to<char>, std::pmr::polymorphic_allocator<std::pair<const char, double>>>;
+
+using w_string_map = weighted_string<w_char_map>;
+
+using w_string_map_collection = weighted_string_collection<w_string_map>;
+
+using w_char_sparse = wc_sparse<4, std::pmr::polymorphic_allocator<std::pair<char, double>>>;
+
+using w_string_sparse = weighted_string<w_char_sparse>;
+
+using w_string_sparse_collection = weighted_string_collection<w_string_sparse>;
+
+template <const char* alph>
+using w_string_array = weighted_string<w_char_array<alph>>;
+
+template <const char* alph>
+using w_string_array_collection = weighted_string_collection<w_string_array<alph>>;
+
+}
+
+
 /*! 
   *
   * Functions and classes to allow reading weighted strings from file
   *
  */ 
 
-//! Represents if the weighted elements are strict (= sum of probabilities equals to 1).
-inline bool& ws_strict()
+//! Options to read weighted strings from file
+struct ws_options
+{
+    //! The weighted elements are strict (= sum of probabilities equals to 1)
+    bool strict = true;
+
+    //! The last letter of the alphabet is the gap of the weighted strings
+    bool gap = false;
+
+    //! The precision of strict probabilities
+    double precision = 0.;
+};
+
+//! Index of the ws_options of a stream in its pword array
+inline int ws_options_index()
 {
-    static bool strict = true;
-    return strict;
+    static const int index = std::ios_base::xalloc();
+    return index;
 }
 
-//! Represents the gap of the weighted elements.
-inline bool& ws_gap()
+//! Free or copy the ws_options of a stream
+inline void ws_options_callback(std::ios_base::event ev, std::ios_base& s, int index)
 {
-    static bool has_gap = false;
-    return has_gap;
+    void*& p = s.pword(index);
+
+    if (nullptr == p) {
+        return;
+    }
+
+    if (std::ios_base::erase_event == ev) {
+        delete static_cast<ws_options*>(p);
+        p = nullptr;
+    }
+    else if (std::ios_base::copyfmt_event == ev) {
+        // The pointer has been copied from the other stream
+        p = new ws_options(*static_cast<ws_options*>(p));
+    }
 }
 
-//! Represents the precision of strict probabilities.
-inline double& ws_precision()
+//! Return the options of a stream (the default options if none were set)
+/*!
+  * Options are stored in each stream, so several streams can be read concurrently with different options.
+  * They are freed with the stream and copied by `copyfmt`.
+ */
+inline ws_options& ws_get_options(std::ios_base& s)
 {
-    static double precision = 0.;
-    return precision;
+    int index = ws_options_index();
+    void*& p = s.pword(index);
+
+    if (nullptr == p) {
+        p = new ws_options();
+        s.register_callback(ws_options_callback, index);
+    }
+
+    return *static_cast<ws_options*>(p);
+}
+
+//! Set all options of a stream
+inline std::istream& operator>>(std::istream& in, const ws_options& options)
+{
+    ws_get_options(in) = options;
+    return in;
 }
 
 //! Class to create manipulators with parameters
-class ws_manip {};
+struct ws_manip
+{
+    double precision;
+};
 
 inline std::istream& operator>>(std::istream& in, const ws_manip& manip)
 {
+    ws_get_options(in).precision = manip.precision;
     return in;
 }
 
 inline std::istream& ws_strict(std::istream& in)
 {
-    ws_strict() = true;
+    ws_get_options(in).strict = true;
     return in;
 }
 
 inline std::istream& ws_not_strict(std::istream& in)
 {
-    ws_strict() = false;
+    ws_get_options(in).strict = false;
     return in;
 }
 
 inline std::istream& ws_gap(std::istream& in)
 {
-    ws_gap() = true;
+    ws_get_options(in).gap = true;
     return in;
 }
 
 inline std::istream& ws_no_gap(std::istream& in)
 {
-    ws_gap() = false;
+    ws_get_options(in).gap = false;
     return in;
 }
 
 inline ws_manip ws_set_precision(double p)
 { 
-    ws_precision() = p;
-    return ws_manip();
+    return ws_manip{p};
+}
+
+//! Reserve memory to append n positions to a weighted string
+/*!
+  * The capacity grows at least geometrically, so appending many weighted strings one after the other
+  * to the same weighted string (as flat_ws_collection does) costs a linear time.
+ */
+template <class Container, class Allocator>
+void reserve_positions(weighted_string<Container, Allocator>& ws, size_t n)
+{
+    if (ws.capacity() < ws.size() + n) {
+        ws.reserve(std::max(ws.size() + n, 2 * ws.capacity()));
+    }
 }
 
 //! Generic function to create a weighted_string from file
 /*!
   * \tparam Container   Same as Container param for weighted_element
+  *
+  * The containers of the positions are created with the allocator of the weighted string when they use it.
  */
-template <class Container>
-void construct_ws_from_file(std::istream& in, weighted_string<Container>& ws, size_t n, const std::string& alph)
+template <class Container, class Allocator>
+void construct_ws_from_file(std::istream& in, weighted_string<Container, Allocator>& ws, size_t n, const std::string& alph, const ws_options& options)
 {
-    if (ws_gap()) {
+    if (options.gap) {
         ws.set_gap(alph.back());
     }
 
     double v;
 
-    for (int i = 0; i < n; ++i) {
-        Container wc;
+    reserve_positions(ws, n);
+
+    for (size_t i = 0; i < n; ++i) {
+        Container wc = make_container<Container>(ws.get_allocator());
 
         for (char c : alph) {
             in >> v;
@@ -264,16 +562,23 @@ void construct_ws_from_file(std::istream& in, weighted_string<Container>& ws, si
             }
         }
         
-        ws.emplace_back(weighted_char<Container>(wc, ws_strict(), ws_precision()));
+        ws.emplace_back(std::move(wc), options.strict, options.precision);
     }
 }
 
+//! Same as above with the options of the stream
+template <class Container, class Allocator>
+void construct_ws_from_file(std::istream& in, weighted_string<Container, Allocator>& ws, size_t n, const std::string& alph)
+{
+    construct_ws_from_file<Container>(in, ws, n, alph, ws_get_options(in));
+}
+
 //! >> operator to read a weighted string from a file
 /*!
   * \tparam Container   Same as Container param for weighted_element
  */
-template <class Container>
-std::istream& operator>>(std::istream& in, weighted_string<Container>& ws)
+template <class Container, class Allocator>
+std::istream& operator>>(std::istream& in, weighted_string<Container, Allocator>& ws)
 {
     size_t n;
     std::string alph;
@@ -290,14 +595,18 @@ std::istream& operator>>(std::istream& in, weighted_string<Container>& ws)
 /*!
   * \tparam Container   Container parameter of weighted_string
   * \tparam Collection  Any collection with two template parameters such as STL collection
+  * \tparam WAllocator  Allocator parameter of weighted_string
   * \tparam Allocator   The allocator for the weighted strings
+  *
+  * Weighted strings are created with the allocator of the collection when they use it.
  */
 template <
     class Container,
+    class WAllocator,
     template <class, class> class Collection,
     class Allocator
 >
-std::istream& operator>>(std::istream& in, Collection<weighted_string<Container>, Allocator>& wsc)
+std::istream& operator>>(std::istream& in, Collection<weighted_string<Container, WAllocator>, Allocator>& wsc)
 {
     size_t l, n;
     std::string alph;
@@ -309,11 +618,11 @@ std::istream& operator>>(std::istream& in, Collection<weighted_string<Container>
 
     for (size_t _ = 0; _ < l; ++_) {
         in >> n;
-        weighted_string<Container> ws;
+        auto ws = make_container<weighted_string<Container, WAllocator>>(wsc.get_allocator());
 
         construct_ws_from_file<Container>(in, ws, n, alph);
 
-        wsc.push_back(ws);
+        wsc.push_back(std::move(ws));
     }
 
     return in;
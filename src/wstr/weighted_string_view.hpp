@@ -0,0 +1,220 @@
+#pragma once
+
+#include <string>
+#include <stdexcept>
+#include <type_traits>
+
+#include "weighted_string.hpp"
+
+namespace wstr
+{
+
+//! Read-only view on consecutive positions of a weighted string
+/*!
+  * \tparam Container   Container of the weighted chars
+  *
+  * The view only stores a pointer to the first weighted char, a length and a gap, so taking a substring,
+  * a window or a slice of a weighted string does not copy any probability. It offers the same queries as
+  * a weighted_string and can be given to all read-only algorithms of the library.
+  *
+  * As a std::string_view, the view is valid as long as the weighted chars it points to: it is invalidated
+  * when the weighted string it comes from is destroyed or reallocated.
+  *
+  * \sa wstr::weighted_string
+  * \sa wstr::mapped_ws_collection
+ */
+template <class Container>
+class weighted_string_view
+{
+    public:
+
+        typedef weighted_char<Container> w_char;
+        typedef w_char value_type;
+        typedef const w_char* const_iterator;
+        typedef const w_char* iterator;
+
+        //! Same as std::string::npos
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    private:
+
+        const w_char* _data = nullptr;
+        size_t _size = 0;
+        char _gap = NO_GAP;
+
+    public:
+
+        weighted_string_view()
+        {
+
+        }
+
+        weighted_string_view(const w_char* data, size_t size, char gap = NO_GAP) : _data(data), _size(size), _gap(gap)
+        {
+
+        }
+
+        //! View on the positions [pos, pos + n) of a weighted string (or until its end), with its gap
+        /*!
+          * \throw std::out_of_range if pos is greater than the size of the weighted string
+         */
+        template <class Allocator>
+        weighted_string_view(const weighted_string<Container, Allocator>& ws, size_t pos = 0, size_t n = npos) : weighted_string_view(ws.data(), ws.size(), ws.gap())
+        {
+            *this = subview(pos, n);
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return 0 == _size;
+        }
+
+        const w_char& operator[](size_t i) const
+        {
+            return _data[i];
+        }
+
+        //! Access with bound checking
+        /*!
+          * \throw std::out_of_range if i is not lower than size()
+         */
+        const w_char& at(size_t i) const
+        {
+            if (i >= _size) {
+                throw std::out_of_range("The position is beyond the end of the weighted string");
+            }
+
+            return _data[i];
+        }
+
+        const w_char& front() const
+        {
+            return _data[0];
+        }
+
+        const w_char& back() const
+        {
+            return _data[_size - 1];
+        }
+
+        const w_char* data() const
+        {
+            return _data;
+        }
+
+        const_iterator begin() const
+        {
+            return _data;
+        }
+
+        const_iterator end() const
+        {
+            return _data + _size;
+        }
+
+        //! View on the positions [pos, pos + n) of this view (or until its end)
+        /*!
+          * \throw std::out_of_range if pos is greater than size()
+         */
+        weighted_string_view subview(size_t pos, size_t n = npos) const
+        {
+            if (pos > _size) {
+                throw std::out_of_range("The position is beyond the end of the weighted string");
+            }
+
+            return weighted_string_view(_data + pos, std::min(n, _size - pos), _gap);
+        }
+
+        //! Change the gap of the view (the weighted string is not modified)
+        void set_gap(char gap)
+        {
+            _gap = gap;
+        }
+
+        bool has_gap() const
+        {
+            return NO_GAP != gap();
+        }
+
+        char gap() const
+        {
+            return _gap;
+        }
+
+        std::string heaviest() const
+        {
+            return _heaviest(true);
+        }
+
+        std::string heaviest_ungap() const
+        {
+            return _heaviest(false);
+        }
+
+        //! Same as weighted_string::heaviest(char*)
+        size_t heaviest(char* out) const
+        {
+            return heaviest_into(_data, _size, out, _gap, true);
+        }
+
+        //! Same as weighted_string::heaviest_ungap(char*)
+        size_t heaviest_ungap(char* out) const
+        {
+            return heaviest_into(_data, _size, out, _gap, false);
+        }
+
+        //! Same as weighted_string::log_p
+        /*!
+          * \throw std::out_of_range if the string goes beyond the end of the weighted string
+         */
+        double log_p(size_t pos, const std::string& s) const
+        {
+            if (pos + s.size() > _size) {
+                throw std::out_of_range("The string goes beyond the end of the weighted string");
+            }
+
+            double log = 0.;
+
+            for (size_t j = 0; j < s.size(); ++j) {
+                log += _data[pos + j].log_p(s[j]);
+            }
+
+            return log;
+        }
+
+        //! Copy the view into a weighted string
+        weighted_string<Container> to_weighted_string() const
+        {
+            weighted_string<Container> ws(begin(), end());
+            ws.set_gap(_gap);
+            return ws;
+        }
+
+    private:
+
+        std::string _heaviest(bool with_gap) const
+        {
+            std::string h(_size, '\0');
+            h.resize(heaviest_into(_data, _size, &h[0], _gap, with_gap));
+
+            return h;
+        }
+};
+
+template <class Container, class Allocator>
+weighted_string_view(const weighted_string<Container, Allocator>&, size_t = 0, size_t = 0) -> weighted_string_view<Container>;
+
+
+//! Check if a weighted string type is a view, algorithms keep a copy of views instead of a reference
+template <class WString>
+struct is_weighted_string_view : std::false_type {};
+
+template <class Container>
+struct is_weighted_string_view<weighted_string_view<Container>> : std::true_type {};
+
+}
\ No newline at end of file
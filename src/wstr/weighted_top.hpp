@@ -0,0 +1,279 @@
+#pragma once
+
+#include <queue>
+#include <cmath>
+#include <limits>
+#include <string>
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <stdexcept>
+
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+//! Enumerator of the solid strings of a weighted string in decreasing order of probability
+/*!
+  * The probability of a solid string S of length n is X[0].p(S[0]) * ... * X[n - 1].p(S[n - 1]). The enumerator
+  * gives the heaviest string first, then each call to `next` gives the next most probable string.
+  *
+  * The letters of each position are sorted by decreasing probability, so a string is the heaviest string with
+  * some deviations (position, rank of the letter). Positions with several letters are sorted by the loss of their
+  * second letter, and the strings form a tree where the children of a string whose last deviation is (j, r) are:
+  * - the same string with the rank r + 1 at j,
+  * - the same string with a new deviation of rank 1 at the next position j + 1,
+  * - if r is 1, the same string with this deviation moved from j to j + 1.
+  * Each string has a single parent and is never more probable than it, so a best-first search of the tree with
+  * a heap gives the strings in decreasing order. A string only stores its last deviation and a link to the string
+  * of its other deviations, which is shared by all its descendants.
+  *
+  * Getting k strings costs O(k (n + log k)) and stores at most 3k + 1 strings in O(1) memory each. Probabilities are
+  * computed in log space. Strings with a probability lower than a threshold are never stored.
+  *
+  * \sa wstr::top_k_strings
+  * \sa wstr::strings_above
+ */
+class ws_top_strings
+{
+    private:
+
+        //! A string of the tree, given by its last deviation and the string of its other deviations
+        struct node
+        {
+            double log_p;
+            size_t prefix;
+            size_t j;
+            size_t rank;
+        };
+
+        static constexpr size_t _none = static_cast<size_t>(-1);
+
+        // Letters of each position in decreasing order of probability, with their log-probabilities
+        std::vector<size_t> _offsets = {0};
+        std::vector<char> _letters;
+        std::vector<double> _logs;
+
+        // Positions with several letters, by increasing loss of their second letter
+        std::vector<size_t> _order;
+
+        std::string _heaviest;
+        double _log_heaviest = 0.;
+        double _log_threshold;
+
+        std::vector<node> _nodes;
+        std::priority_queue<std::pair<double, size_t>> _heap;
+        bool _started = false;
+        bool _empty = false;
+
+    public:
+
+        //! Prepare the enumeration of the strings of a weighted string (or a view)
+        /*!
+          * \param ws   The weighted string
+          * \param z    Only strings with a probability greater or equal to 1/z are given (all strings by default)
+          *
+          * \throw std::invalid_argument if z is lower than 1
+         */
+        template <class WString>
+        explicit ws_top_strings(const WString& ws, double z = std::numeric_limits<double>::infinity())
+            : _log_threshold(-std::log(z) - log_epsilon)
+        {
+            if (!(z >= 1.)) {
+                throw std::invalid_argument("The threshold z must be greater or equal to 1");
+            }
+
+            std::vector<std::pair<double, char>> position;
+            std::vector<std::pair<double, size_t>> losses;
+
+            for (const auto& wc : ws) {
+                position.clear();
+
+                wc.probabilities().for_each([&position](char c, double p) {
+                    if (p > 0.) {
+                        position.emplace_back(p, c);
+                    }
+                });
+
+                // Decreasing probabilities, ties by letter to be deterministic
+                std::sort(position.begin(), position.end(), [](const auto& a, const auto& b) {
+                    return a.first > b.first || (a.first == b.first && a.second < b.second);
+                });
+
+                if (position.empty()) {
+                    _empty = true;
+                }
+
+                for (const auto& p : position) {
+                    _letters.push_back(p.second);
+                    _logs.push_back(wc.log_p(p.second));
+                }
+
+                _offsets.push_back(_letters.size());
+
+                size_t i = _offsets.size() - 2;
+
+                if (position.size() > 1) {
+                    losses.emplace_back(_log(i, 0) - _log(i, 1), i);
+                }
+            }
+
+            if (_empty) {
+                return;
+            }
+
+            std::stable_sort(losses.begin(), losses.end(), [](const auto& a, const auto& b) {
+                return a.first < b.first;
+            });
+
+            for (const auto& loss : losses) {
+                _order.push_back(loss.second);
+            }
+
+            for (size_t i = 0; i + 1 < _offsets.size(); ++i) {
+                _heaviest.push_back(_letters[_offsets[i]]);
+                _log_heaviest += _log(i, 0);
+            }
+        }
+
+        //! Length of the strings
+        size_t size() const
+        {
+            return _offsets.size() - 1;
+        }
+
+        //! Give the next most probable string and the logarithm of its probability
+        /*!
+          * \return false if there are no more strings (above the threshold)
+         */
+        bool next(std::string& s, double& log_p)
+        {
+            if (!_started) {
+                _started = true;
+
+                if (_empty || _log_heaviest < _log_threshold) {
+                    return false;
+                }
+
+                if (!_order.empty()) {
+                    _push({_log_heaviest - _loss(0), _none, 0, 1});
+                }
+
+                s = _heaviest;
+                log_p = _log_heaviest;
+
+                return true;
+            }
+
+            if (_heap.empty()) {
+                return false;
+            }
+
+            size_t k = _heap.top().second;
+            _heap.pop();
+
+            node v = _nodes[k];
+
+            _write(k, s);
+            log_p = v.log_p;
+
+            size_t i = _order[v.j];
+
+            if (v.rank + 1 < _offsets[i + 1] - _offsets[i]) {
+                _push({v.log_p - _log(i, v.rank) + _log(i, v.rank + 1), v.prefix, v.j, v.rank + 1});
+            }
+
+            if (v.j + 1 < _order.size()) {
+                _push({v.log_p - _loss(v.j + 1), k, v.j + 1, 1});
+
+                if (1 == v.rank) {
+                    _push({v.log_p + _loss(v.j) - _loss(v.j + 1), v.prefix, v.j + 1, 1});
+                }
+            }
+
+            return true;
+        }
+
+    private:
+
+        double _log(size_t i, size_t rank) const
+        {
+            return _logs[_offsets[i] + rank];
+        }
+
+        //! Loss of log-probability of the second letter of the j-th position of the order
+        double _loss(size_t j) const
+        {
+            return _log(_order[j], 0) - _log(_order[j], 1);
+        }
+
+        void _push(const node& v)
+        {
+            if (v.log_p >= _log_threshold) {
+                _nodes.push_back(v);
+                _heap.emplace(v.log_p, _nodes.size() - 1);
+            }
+        }
+
+        //! Write the string of a node: the heaviest string with all its deviations
+        void _write(size_t k, std::string& s) const
+        {
+            s = _heaviest;
+
+            for (; _none != k; k = _nodes[k].prefix) {
+                size_t i = _order[_nodes[k].j];
+                s[i] = _letters[_offsets[i] + _nodes[k].rank];
+            }
+        }
+};
+
+
+//! The k most probable solid strings of a weighted string (or a view), with the logarithm of their probability
+/*!
+  * Strings are given in decreasing order of probability, there are less than k strings if the weighted string
+  * does not have k different strings with a probability greater than 0.
+  *
+  * \sa wstr::ws_top_strings
+ */
+template <class WString>
+std::vector<std::pair<std::string, double>> top_k_strings(const WString& ws, size_t k)
+{
+    std::vector<std::pair<std::string, double>> strings;
+    ws_top_strings top(ws);
+
+    std::string s;
+    double log_p;
+
+    while (strings.size() < k && top.next(s, log_p)) {
+        strings.emplace_back(s, log_p);
+    }
+
+    return strings;
+}
+
+//! All solid strings of a weighted string (or a view) with a probability greater or equal to 1/z
+/*!
+  * There are at most z such strings, given in decreasing order of probability with the logarithm of their probability.
+  *
+  * \throw std::invalid_argument if z is lower than 1
+  *
+  * \sa wstr::ws_top_strings
+ */
+template <class WString>
+std::vector<std::pair<std::string, double>> strings_above(const WString& ws, double z)
+{
+    std::vector<std::pair<std::string, double>> strings;
+    ws_top_strings top(ws, z);
+
+    std::string s;
+    double log_p;
+
+    while (top.next(s, log_p)) {
+        strings.emplace_back(s, log_p);
+    }
+
+    return strings;
+}
+
+}
\ No newline at end of file
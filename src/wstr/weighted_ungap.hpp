@@ -0,0 +1,511 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+//! Static bitvector with rank and select queries
+/*!
+  * Bits are stored in 64-bit words. The number of ones before each block of 8 words (512 bits) is stored, so
+  * `rank` is one lookup and at most 8 popcounts. The position of every 512-th one is also stored, and splits
+  * the ones into groups of 512:
+  * - a dense group spans less than `sparse_span` bits, `select` looks for the block of the one with a binary
+  *   search over at most 128 blocks, then counts ones in at most 8 words,
+  * - a sparse group spans at least `sparse_span` bits, the positions of its 512 ones are stored explicitly.
+  *
+  * So `select` takes a constant time. The rank directory and the samples take 1/8 of the size of the bits each,
+  * and the explicit positions (4096 bytes per group of at least 8192 bytes of bits) at most 1/2.
+ */
+class rank_select_bitvector
+{
+    public:
+
+        //! Number of bits of a block of the rank directory
+        static constexpr size_t block_bits = 512;
+
+        //! One of every `select_sample` ones has its position stored
+        static constexpr size_t select_sample = 512;
+
+        //! Groups of `select_sample` ones which span at least this number of bits have their positions stored
+        static constexpr size_t sparse_span = 1 << 16;
+
+    private:
+
+        static constexpr size_t _block_words = block_bits / 64;
+        static constexpr size_t _dense = static_cast<size_t>(-1);
+
+        std::vector<std::uint64_t> _words;
+        std::vector<std::uint64_t> _ranks;
+        std::vector<std::uint64_t> _samples;
+
+        // Offset of the positions of each group in _positions, _dense for dense groups
+        std::vector<std::uint64_t> _groups;
+        std::vector<std::uint64_t> _positions;
+
+        size_t _size = 0;
+        size_t _ones = 0;
+        size_t _last_one = 0;
+
+    public:
+
+        rank_select_bitvector()
+        {
+
+        }
+
+        //! Bitvector of n bits set to 0
+        explicit rank_select_bitvector(size_t n) : _words((n + 63) / 64, 0), _size(n)
+        {
+
+        }
+
+        //! Number of bits
+        size_t size() const
+        {
+            return _size;
+        }
+
+        //! Number of bits set to 1 (once built)
+        size_t ones() const
+        {
+            return _ones;
+        }
+
+        bool operator[](size_t i) const
+        {
+            return (_words[i / 64] >> (i % 64)) & 1;
+        }
+
+        //! Set a bit, `build` should be called after all bits are set
+        void set(size_t i, bool value = true)
+        {
+            std::uint64_t mask = std::uint64_t(1) << (i % 64);
+            _words[i / 64] = value ? (_words[i / 64] | mask) : (_words[i / 64] & ~mask);
+        }
+
+        //! Number of bytes used by the bits and the directories
+        size_t memory() const
+        {
+            return (_words.size() + _ranks.size() + _samples.size() + _groups.size() + _positions.size()) * sizeof(std::uint64_t);
+        }
+
+        //! Words of the bitvector, bit i is the bit i % 64 of word i / 64
+        const std::uint64_t* words() const
+        {
+            return _words.data();
+        }
+
+        //! Build the rank and select directories
+        void build()
+        {
+            size_t blocks = (_words.size() + _block_words - 1) / _block_words;
+
+            _ranks.assign(blocks + 1, 0);
+            _samples.clear();
+            _groups.clear();
+            _positions.clear();
+
+            size_t ones = 0;
+
+            for (size_t w = 0; w < _words.size(); ++w) {
+                if (0 == w % _block_words) {
+                    _ranks[w / _block_words] = ones;
+                }
+
+                std::uint64_t word = _words[w];
+
+                // Position of the ones which are a multiple of select_sample
+                while (word) {
+                    if (0 == ones % select_sample) {
+                        _samples.push_back(w * 64 + __builtin_ctzll(word));
+                    }
+
+                    size_t next = select_sample - ones % select_sample;
+                    size_t count = __builtin_popcountll(word);
+
+                    if (count < next) {
+                        ones += count;
+                        break;
+                    }
+
+                    word = _clear_lowest(word, next);
+                    ones += next;
+                }
+            }
+
+            _ranks[blocks] = ones;
+            _ones = ones;
+            _last_one = 0;
+
+            if (0 == ones) {
+                return;
+            }
+
+            for (size_t w = _words.size(); w-- > 0;) {
+                if (_words[w]) {
+                    _last_one = w * 64 + 63 - __builtin_clzll(_words[w]);
+                    break;
+                }
+            }
+
+            for (size_t s = 0; s < _samples.size(); ++s) {
+                size_t end = s + 1 < _samples.size() ? _samples[s + 1] : _last_one + 1;
+
+                if (end - _samples[s] < sparse_span) {
+                    _groups.push_back(_dense);
+                    continue;
+                }
+
+                _groups.push_back(_positions.size());
+
+                for (size_t i = _samples[s]; i < end; i = next_one(i + 1)) {
+                    _positions.push_back(i);
+                }
+            }
+        }
+
+        //! Number of ones in the bits [0, i), i should be lower or equal to size()
+        size_t rank(size_t i) const
+        {
+            size_t w = i / 64;
+            size_t r = _ranks[w / _block_words];
+
+            for (size_t k = w / _block_words * _block_words; k < w; ++k) {
+                r += __builtin_popcountll(_words[k]);
+            }
+
+            if (i % 64) {
+                r += __builtin_popcountll(_words[w] & ((std::uint64_t(1) << (i % 64)) - 1));
+            }
+
+            return r;
+        }
+
+        //! Position of the k-th one (starting from 0), k should be lower than ones()
+        size_t select(size_t k) const
+        {
+            size_t s = k / select_sample;
+
+            if (_dense != _groups[s]) {
+                return _positions[_groups[s] + k % select_sample];
+            }
+
+            size_t first = _samples[s] / block_bits;
+            size_t last = (s + 1 < _samples.size() ? _samples[s + 1] : _last_one) / block_bits + 1;
+
+            // Last block which starts with at most k ones (less than sparse_span / block_bits + 1 blocks)
+            size_t b = std::upper_bound(_ranks.begin() + first + 1, _ranks.begin() + last, k) - _ranks.begin() - 1;
+            size_t r = _ranks[b];
+
+            for (size_t w = b * _block_words; ; ++w) {
+                size_t count = __builtin_popcountll(_words[w]);
+
+                if (r + count > k) {
+                    return w * 64 + __builtin_ctzll(_clear_lowest(_words[w], k - r));
+                }
+
+                r += count;
+            }
+        }
+
+        //! Position of the first one at a position greater or equal to i, size() if there is none
+        size_t next_one(size_t i) const
+        {
+            if (i >= _size) {
+                return _size;
+            }
+
+            size_t w = i / 64;
+            std::uint64_t word = _words[w] & (~std::uint64_t(0) << (i % 64));
+
+            while (0 == word) {
+                if (++w == _words.size()) {
+                    return _size;
+                }
+
+                word = _words[w];
+            }
+
+            return w * 64 + __builtin_ctzll(word);
+        }
+
+    private:
+
+        //! Clear the n lowest ones of a word
+        static std::uint64_t _clear_lowest(std::uint64_t word, size_t n)
+        {
+            for (size_t j = 0; j < n; ++j) {
+                word &= word - 1;
+            }
+
+            return word;
+        }
+};
+
+
+//! Read-only view on the positions of a weighted string which are not gaps
+/*!
+  * \tparam Container   Container of the weighted chars
+  *
+  * A position is a gap when its heaviest letter is the gap of the weighted string, as for `heaviest_ungap`.
+  * The view marks the other positions in a rank_select_bitvector once (about 1.25 bit per position, at most
+  * 1.75 when the kept positions are sparse), then:
+  * - the k-th position of the view is the k-th one of the bitvector (`select`),
+  * - the position of the view of an original position is the number of ones before it (`rank`).
+  * Probabilities are not copied, the view is valid as long as the weighted string.
+  *
+  * The view has the same read-only queries as a weighted string, its gap is the gap of the weighted string
+  * (which never is the heaviest letter of a position of the view).
+  *
+  * \sa wstr::weighted_string_view
+  * \sa wstr::rank_select_bitvector
+ */
+template <class Container>
+class weighted_string_ungap_view
+{
+    public:
+
+        typedef weighted_char<Container> w_char;
+        typedef w_char value_type;
+
+        //! Forward iterator on the positions of the view, in order
+        class const_iterator
+        {
+            private:
+
+                const weighted_string_ungap_view* _view = nullptr;
+                size_t _position = 0;
+
+            public:
+
+                typedef std::forward_iterator_tag iterator_category;
+                typedef w_char value_type;
+                typedef std::ptrdiff_t difference_type;
+                typedef const w_char* pointer;
+                typedef const w_char& reference;
+
+                const_iterator()
+                {
+
+                }
+
+                const_iterator(const weighted_string_ungap_view* view, size_t position) : _view(view), _position(position)
+                {
+
+                }
+
+                //! Position of the weighted char in the weighted string
+                size_t position() const
+                {
+                    return _position;
+                }
+
+                reference operator*() const
+                {
+                    return _view->_ws[_position];
+                }
+
+                pointer operator->() const
+                {
+                    return &_view->_ws[_position];
+                }
+
+                const_iterator& operator++()
+                {
+                    _position = _view->_kept.next_one(_position + 1);
+                    return *this;
+                }
+
+                const_iterator operator++(int)
+                {
+                    const_iterator it = *this;
+                    ++(*this);
+                    return it;
+                }
+
+                bool operator==(const const_iterator& oth) const
+                {
+                    return _position == oth._position;
+                }
+
+                bool operator!=(const const_iterator& oth) const
+                {
+                    return _position != oth._position;
+                }
+        };
+
+        typedef const_iterator iterator;
+
+    private:
+
+        weighted_string_view<Container> _ws;
+        rank_select_bitvector _kept;
+
+    public:
+
+        weighted_string_ungap_view()
+        {
+
+        }
+
+        //! Find the gaps of a weighted string
+        explicit weighted_string_ungap_view(const weighted_string_view<Container>& ws) : _ws(ws), _kept(ws.size())
+        {
+            static constexpr size_t block = 4096;
+
+            char heaviest[block];
+
+            for (size_t start = 0; start < _ws.size(); start += block) {
+                size_t len = _ws.subview(start, block).heaviest(heaviest);
+
+                for (size_t i = 0; i < len; ++i) {
+                    if (!_ws.has_gap() || heaviest[i] != _ws.gap()) {
+                        _kept.set(start + i);
+                    }
+                }
+            }
+
+            _kept.build();
+        }
+
+        template <class Allocator>
+        explicit weighted_string_ungap_view(const weighted_string<Container, Allocator>& ws) : weighted_string_ungap_view(weighted_string_view<Container>(ws))
+        {
+
+        }
+
+        //! Number of positions which are not gaps
+        size_t size() const
+        {
+            return _kept.ones();
+        }
+
+        bool empty() const
+        {
+            return 0 == size();
+        }
+
+        //! The k-th position which is not a gap
+        const w_char& operator[](size_t k) const
+        {
+            return _ws[_kept.select(k)];
+        }
+
+        //! Access with bound checking
+        /*!
+          * \throw std::out_of_range if k is not lower than size()
+         */
+        const w_char& at(size_t k) const
+        {
+            if (k >= size()) {
+                throw std::out_of_range("The position is beyond the end of the weighted string");
+            }
+
+            return operator[](k);
+        }
+
+        //! Position in the weighted string of the k-th position of the view
+        size_t original_position(size_t k) const
+        {
+            return _kept.select(k);
+        }
+
+        //! Position in the view of a position of the weighted string
+        /*!
+          * For a gap, it is the position of the view of the next position which is not a gap (or size()).
+         */
+        size_t ungapped_position(size_t i) const
+        {
+            return _kept.rank(i);
+        }
+
+        //! Return true if the heaviest letter of a position of the weighted string is the gap
+        bool is_gap(size_t i) const
+        {
+            return !_kept[i];
+        }
+
+        //! The weighted string with its gaps
+        const weighted_string_view<Container>& original() const
+        {
+            return _ws;
+        }
+
+        const_iterator begin() const
+        {
+            return const_iterator(this, _kept.next_one(0));
+        }
+
+        const_iterator end() const
+        {
+            return const_iterator(this, _ws.size());
+        }
+
+        bool has_gap() const
+        {
+            return _ws.has_gap();
+        }
+
+        char gap() const
+        {
+            return _ws.gap();
+        }
+
+        //! Same as the heaviest_ungap of the weighted string
+        std::string heaviest() const
+        {
+            return _ws.heaviest_ungap();
+        }
+
+        //! Same as heaviest since the view has no gap
+        std::string heaviest_ungap() const
+        {
+            return heaviest();
+        }
+
+        //! Same as weighted_string::log_p, on the positions of the view
+        /*!
+          * \throw std::out_of_range if the string goes beyond the end of the view
+         */
+        double log_p(size_t pos, const std::string& s) const
+        {
+            if (pos + s.size() > size()) {
+                throw std::out_of_range("The string goes beyond the end of the weighted string");
+            }
+
+            double log = 0.;
+
+            if (s.empty()) {
+                return log;
+            }
+
+            size_t i = _kept.select(pos);
+
+            for (size_t j = 0; j < s.size(); ++j, i = _kept.next_one(i + 1)) {
+                log += _ws[i].log_p(s[j]);
+            }
+
+            return log;
+        }
+
+        //! Copy the positions of the view into a weighted string (without gap)
+        weighted_string<Container> to_weighted_string() const
+        {
+            weighted_string<Container> ws;
+            ws.reserve(size());
+            ws.insert(ws.end(), begin(), end());
+            ws.set_gap(_ws.gap());
+
+            return ws;
+        }
+};
+
+}
\ No newline at end of file
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <cstring>
+#include <fstream>
+#include <charconv>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+
+#include "weighted_string.hpp"
+#include "weighted_string_view.hpp"
+
+namespace wstr
+{
+
+template <class Container, class Allocator>
+std::true_type is_weighted_string_test(const weighted_string<Container, Allocator>*);
+
+std::false_type is_weighted_string_test(const void*);
+
+//! Check if a type is a weighted_string or inherits from it (such as w_string_dna_gap)
+template <class T>
+struct is_weighted_string : decltype(is_weighted_string_test(std::declval<const T*>())) {};
+
+//! Check if a type is a collection of weighted strings (or of views), but not a weighted string or a view
+/*!
+  * A collection has `begin` and `end`, and its elements have a gap.
+ */
+template <class T, class = void>
+struct is_ws_collection : std::false_type {};
+
+template <class T>
+struct is_ws_collection<T, std::void_t<decltype((*std::begin(std::declval<const T&>())).gap()), decltype(std::end(std::declval<const T&>()))>>
+    : std::bool_constant<!is_weighted_string<T>::value && !is_weighted_string_view<T>::value> {};
+
+//! Writer of the weighted string file format, with a large output buffer
+/*!
+  * The output is the format read by the >> operators and parse_ws: the size, the alphabet, then one line of σ
+  * probabilities per position (and the size of each weighted string for a collection). Numbers are formatted
+  * with std::to_chars into a buffer which is written to the stream when it is full, so the output goes through
+  * the locale machinery of streams only once per buffer.
+  *
+  * Probabilities are written in the shortest form which reads back to the same double (precision -1), or with
+  * a fixed number of digits after the decimal point. Probabilities equal to 0 are written as "0".
+  *
+  * The alphabet is made of all letters of the positions in increasing order. If a weighted string has a gap,
+  * the gap is moved to the end of the alphabet, so the weighted string is read back with its gap by `ws_gap`.
+  * All weighted strings of a collection should then have the same gap. When no position has any letter (such as
+  * empty weighted strings), one letter of probability 0 is written so that the alphabet line is not empty.
+  *
+  * The buffer is flushed by `flush` and by the destructor.
+  *
+  * \sa wstr::save_ws
+ */
+class ws_writer
+{
+    public:
+
+        //! Default size of the buffer (1 MiB)
+        static constexpr size_t default_buffer_size = 1 << 20;
+
+    private:
+
+        std::ostream& _out;
+        int _precision;
+        std::unique_ptr<char[]> _buffer;
+        size_t _capacity;
+        size_t _used = 0;
+
+    public:
+
+        //! Writer on a stream
+        /*!
+          * \param out          The output, which should live as long as the writer
+          * \param precision    Number of digits after the decimal point, -1 for the shortest round-trip form
+          * \param buffer_size  Size of the buffer, in bytes
+         */
+        explicit ws_writer(std::ostream& out, int precision = -1, size_t buffer_size = default_buffer_size)
+            : _out(out), _precision(precision), _capacity(std::max<size_t>(buffer_size, 4096))
+        {
+            // Not initialized, so a large buffer only costs the pages which are written
+            _buffer.reset(new char[_capacity]);
+        }
+
+        ws_writer(const ws_writer&) = delete;
+        ws_writer& operator=(const ws_writer&) = delete;
+
+        ~ws_writer()
+        {
+            try {
+                flush();
+            }
+            catch (...) {
+
+            }
+        }
+
+        //! Write a weighted string
+        /*!
+          * \throw std::runtime_error if the stream cannot be written
+         */
+        template <class Container, class Allocator>
+        void write(const weighted_string<Container, Allocator>& ws)
+        {
+            write(weighted_string_view<Container>(ws));
+        }
+
+        //! Write a view as a weighted string
+        template <class Container>
+        void write(const weighted_string_view<Container>& ws)
+        {
+            std::string alph = _alphabet(&ws, &ws + 1);
+
+            _write_size(ws.size());
+            _write_line(alph.data(), alph.size());
+            _write_positions(ws, alph);
+        }
+
+        //! Write a collection of weighted strings (or of views)
+        /*!
+          * \throw std::invalid_argument if two weighted strings have different gaps
+          * \throw std::runtime_error if the stream cannot be written
+         */
+        template <class WStringCollection, class = std::enable_if_t<is_ws_collection<WStringCollection>::value>>
+        void write(const WStringCollection& wsc)
+        {
+            std::string alph = _alphabet(std::begin(wsc), std::end(wsc));
+
+            _write_size(std::distance(std::begin(wsc), std::end(wsc)));
+            _write_line(alph.data(), alph.size());
+
+            for (const auto& ws : wsc) {
+                _write_size(ws.size());
+                _write_positions(ws, alph);
+            }
+        }
+
+        //! Write the buffer to the stream
+        /*!
+          * \throw std::runtime_error if the stream cannot be written
+         */
+        void flush()
+        {
+            if (_used > 0) {
+                _out.write(_buffer.get(), _used);
+                _used = 0;
+            }
+
+            if (!_out) {
+                throw std::runtime_error("cannot write the weighted string");
+            }
+        }
+
+    private:
+
+        //! Alphabet of weighted strings, in increasing order with the gap at the end
+        template <class Iterator>
+        static std::string _alphabet(Iterator first, Iterator last)
+        {
+            using Container = std::decay_t<decltype(std::begin(*first)->probabilities())>;
+
+            std::array<bool, 256> letters{};
+            char gap = NO_GAP;
+
+            for (; first != last; ++first) {
+                const auto& ws = *first;
+
+                if (ws.has_gap()) {
+                    if (NO_GAP != gap && ws.gap() != gap) {
+                        throw std::invalid_argument("All weighted strings should have the same gap");
+                    }
+
+                    gap = ws.gap();
+                }
+
+                for (const auto& wc : ws) {
+                    wc.probabilities().for_each([&letters](char c, double) {
+                        letters[static_cast<unsigned char>(c)] = true;
+                    });
+                }
+            }
+
+            std::string alph;
+
+            for (size_t c = 0; c < letters.size(); ++c) {
+                if (letters[c] && static_cast<char>(c) != gap) {
+                    alph.push_back(static_cast<char>(c));
+                }
+            }
+
+            if (NO_GAP != gap) {
+                alph.push_back(gap);
+            }
+
+            // The readers need at least one letter: take the first one of the Container, or 'A' for maps
+            if (alph.empty()) {
+                Container().for_each([&alph](char c, double) {
+                    if (alph.empty()) {
+                        alph.push_back(c);
+                    }
+                });
+            }
+
+            if (alph.empty()) {
+                alph.push_back('A');
+            }
+
+            return alph;
+        }
+
+        template <class WString>
+        void _write_positions(const WString& ws, const std::string& alph)
+        {
+            for (const auto& wc : ws) {
+                for (size_t k = 0; k < alph.size(); ++k) {
+                    if (k > 0) {
+                        _put(' ');
+                    }
+
+                    _write_double(wc.p(alph[k]));
+                }
+
+                _put('\n');
+            }
+        }
+
+        void _write_size(size_t n)
+        {
+            _reserve(24);
+
+            char* first = _buffer.get() + _used;
+            _used = std::to_chars(first, first + 24, n).ptr - _buffer.get();
+            _put('\n');
+        }
+
+        void _write_line(const char* s, size_t n)
+        {
+            _reserve(n + 1);
+
+            std::memcpy(_buffer.get() + _used, s, n);
+            _used += n;
+            _put('\n');
+        }
+
+        void _write_double(double v)
+        {
+            if (0. == v) {
+                _put('0');
+                return;
+            }
+
+            // The shortest form of a double has at most 24 chars, a fixed form is longer for large values
+            _reserve(_precision < 0 ? 32 : 32 + _precision);
+
+            if (_precision < 0 ? _write_short_decimal(v) : _write_fixed_decimal(v)) {
+                return;
+            }
+
+            char* first = _buffer.get() + _used;
+            char* last = _buffer.get() + _capacity;
+            std::to_chars_result result = _precision < 0 ? std::to_chars(first, last, v)
+                                                         : std::to_chars(first, last, v, std::chars_format::fixed, _precision);
+
+            if (std::errc() != result.ec) {
+                // Fixed form of a very large value
+                _reserve(_capacity + 1);
+                return _write_double(v);
+            }
+
+            _used = result.ptr - _buffer.get();
+        }
+
+        //! Write v in the shortest round-trip form if it has at most 12 digits after the decimal point
+        /*!
+          * Probabilities of files usually have a few decimals: they are written from an integer, which is much
+          * faster than std::to_chars. Below 1000, two decimals with at most 12 digits after the point are further
+          * apart than two consecutive doubles, so the only one which reads back to v is its shortest form.
+         */
+        bool _write_short_decimal(double v)
+        {
+            static constexpr double scale = 1e12;
+
+            if (!(v > 0. && v < 1000.)) {
+                return false;
+            }
+
+            double scaled = std::floor(v * scale + .5);
+
+            if (scaled / scale != v) {
+                return false;
+            }
+
+            std::uint64_t r = static_cast<std::uint64_t>(scaled);
+            std::uint64_t fraction = r % static_cast<std::uint64_t>(scale);
+            int digits = 12;
+
+            while (fraction > 0 && 0 == fraction % 10) {
+                fraction /= 10;
+                --digits;
+            }
+
+            _write_decimal(r / static_cast<std::uint64_t>(scale), fraction, fraction > 0 ? digits : 0);
+            return true;
+        }
+
+        //! Write v with _precision digits after the decimal point if it is not close to a rounding tie
+        /*!
+          * The product v * 10^_precision is exact up to 2^-14 below 2^40, so if it is not that close to the
+          * middle of two integers, its nearest integer is the one std::to_chars would round to.
+         */
+        bool _write_fixed_decimal(double v)
+        {
+            static constexpr double powers[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12};
+
+            if (_precision > 12 || !(v > 0.)) {
+                return false;
+            }
+
+            double scaled = v * powers[_precision];
+
+            if (scaled >= static_cast<double>(std::uint64_t(1) << 40)) {
+                return false;
+            }
+
+            double floor = std::floor(scaled);
+            double tie = scaled - floor - .5;
+
+            if (tie > -1. / 4096 && tie < 1. / 4096) {
+                return false;
+            }
+
+            std::uint64_t r = static_cast<std::uint64_t>(floor) + (tie > 0.);
+            std::uint64_t p = static_cast<std::uint64_t>(powers[_precision]);
+
+            _write_decimal(r / p, r % p, _precision);
+            return true;
+        }
+
+        //! Write integer.fraction where fraction has the given number of digits (no decimal point if 0)
+        void _write_decimal(std::uint64_t integer, std::uint64_t fraction, int digits)
+        {
+            char* first = _buffer.get() + _used;
+            char* last = std::to_chars(first, first + 20, integer).ptr;
+
+            if (digits > 0) {
+                *last++ = '.';
+
+                for (int k = digits - 1; k >= 0; --k) {
+                    last[k] = static_cast<char>('0' + fraction % 10);
+                    fraction /= 10;
+                }
+
+                last += digits;
+            }
+
+            _used = last - _buffer.get();
+        }
+
+        void _put(char c)
+        {
+            _reserve(1);
+            _buffer[_used++] = c;
+        }
+
+        //! Flush the buffer if it has less than n free chars
+        void _reserve(size_t n)
+        {
+            if (_used + n > _capacity) {
+                flush();
+
+                if (n > _capacity) {
+                    _capacity = std::max(n, 2 * _capacity);
+                    _buffer.reset(new char[_capacity]);
+                }
+            }
+        }
+};
+
+
+//! Precision of a ws_writer from the flags of a stream: fixed with the precision of the stream if `std::fixed` is set
+inline int ws_writer_precision(const std::ios_base& out)
+{
+    return std::ios_base::fixed == (out.flags() & std::ios_base::floatfield) ? static_cast<int>(out.precision()) : -1;
+}
+
+//! << operator to write a weighted string in the format of the >> operator
+/*!
+  * Probabilities are written in their shortest round-trip form, or with `out.precision()` digits after the
+  * decimal point if `std::fixed` is set on the stream.
+  *
+  * \sa wstr::ws_writer
+ */
+template <class Container, class Allocator>
+std::ostream& operator<<(std::ostream& out, const weighted_string<Container, Allocator>& ws)
+{
+    ws_writer(out, ws_writer_precision(out)).write(ws);
+    return out;
+}
+
+//! Same for a view
+template <class Container>
+std::ostream& operator<<(std::ostream& out, const weighted_string_view<Container>& ws)
+{
+    ws_writer(out, ws_writer_precision(out)).write(ws);
+    return out;
+}
+
+//! << operator to write a collection of weighted strings in the format of the >> operator
+/*!
+  * \tparam WString    weighted_string or any class inheriting from it, such as w_string_dna_gap
+  *
+  * \throw std::invalid_argument if two weighted strings have different gaps
+  *
+  * \sa wstr::ws_writer
+ */
+template <
+    template <class, class> class Collection,
+    class WString,
+    class Allocator,
+    class = std::enable_if_t<is_weighted_string<WString>::value>
+>
+std::ostream& operator<<(std::ostream& out, const Collection<WString, Allocator>& wsc)
+{
+    ws_writer(out, ws_writer_precision(out)).write(wsc);
+    return out;
+}
+
+//! Write a weighted string, or a collection of weighted strings, to a file
+/*!
+  * \param precision    Number of digits after the decimal point, -1 for the shortest round-trip form
+  *
+  * \throw std::runtime_error if the file cannot be written
+  *
+  * \sa wstr::load_ws
+ */
+template <class WString>
+void save_ws(const std::string& path, const WString& ws, int precision = -1)
+{
+    std::ofstream out(path, std::ios::binary);
+
+    if (!out) {
+        throw std::runtime_error("cannot open file " + path);
+    }
+
+    ws_writer writer(out, precision);
+    writer.write(ws);
+    writer.flush();
+}
+
+}
\ No newline at end of file
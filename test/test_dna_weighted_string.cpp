@@ -134,4 +134,50 @@ TYPED_TEST(DnaWeightedStringTest, CollectionFile) {
     EXPECT_EQ(wsv[1].heaviest(), "TACCTGGTTGATTCTGCCAGTAGT");
     EXPECT_EQ(wsv[2].heaviest(), "TACCTGGTTGATCCTGCCAGTAGT");
     EXPECT_EQ(wsv[3].heaviest(), "TACCTGGTTGATCCTGCCAGTAGT");
+}
+
+TYPED_TEST(DnaWeightedStringTest, ExtendedMasks) {
+    using Container = std::decay_t<decltype(std::declval<typename TypeParam::w_char>().probabilities())>;
+    using translator = typename Container::translator;
+
+    for (const auto& code : dna_ext_alph) {
+        unsigned char mask = 0;
+
+        for (char c : code.second) {
+            mask |= 1 << translator::find_indice(c);
+        }
+
+        EXPECT_TRUE(Container::is_extended(code.first));
+        EXPECT_EQ(Container::mask(code.first), mask) << code.first;
+    }
+
+    for (char c : std::string(dna_alph)) {
+        EXPECT_FALSE(Container::is_extended(c));
+        EXPECT_EQ(Container::mask(c), 1 << translator::find_indice(c));
+    }
+
+    EXPECT_EQ(Container::mask('-'), Container::translator::size == 5 ? 1 << 4 : 0);
+    EXPECT_EQ(Container::mask('Z'), 0);
+    EXPECT_FALSE(Container::is_extended('Z'));
+
+    static_assert(Container::mask('N') == 0xF, "N should represent A, C, G and T");
+}
+
+TYPED_TEST(DnaWeightedStringTest, Range) {
+    TypeParam ws;
+    TEST_FILE("dna1.txt") >> ws;
+
+    std::string letters = std::string(dna_alph) + "RYMKSWHBVDN-Z";
+
+    for (char c : letters) {
+        std::vector<double> p = dna_p_range(ws, c);
+
+        ASSERT_EQ(p.size(), ws.size());
+
+        for (size_t i = 0; i < ws.size(); ++i) {
+            EXPECT_EQ(p[i], ws[i].p(c)) << c << " at position " << i;
+        }
+    }
+
+    EXPECT_TRUE(dna_p_range(TypeParam(), 'N').empty());
 }
\ No newline at end of file
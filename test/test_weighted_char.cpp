@@ -34,4 +34,54 @@ TYPED_TEST(WeightedCharTest, BasicConstructor) {
 
     EXPECT_EQ(el2.heaviest_non_gap_value('G'), 'A');
     EXPECT_EQ(el2.heaviest_non_gap_proba('G'), .4);
+}
+
+TEST(WeightedCharTest, LogArray) {
+    using WType = weighted_char<w_char_log_array<test_alphabet>>;
+
+    WType el;
+    el['A'] = .4;
+    el['C'] = .2;
+    el['G'] = .4;
+
+    EXPECT_TRUE(el.is_good());
+    EXPECT_EQ(el.heaviest_value(), 'A');
+    EXPECT_EQ(el.heaviest_non_gap_value('A'), 'G');
+    EXPECT_DOUBLE_EQ(el.heaviest_non_gap_proba('A'), .4);
+    EXPECT_EQ(el.heaviest_non_gap_value('-'), 'A');
+}
+
+TEST(WeightedCharTest, Sparse) {
+    using WType = weighted_char<wc_sparse<2>>;
+
+    WType el;
+    el['-'] = .5;
+    el['C'] = .2;
+    el['G'] = .3;
+
+    EXPECT_TRUE(el.is_good());
+    EXPECT_TRUE(el.probabilities().spilled());
+    EXPECT_EQ(el.heaviest_value(), '-');
+    EXPECT_EQ(el.heaviest_non_gap_value('-'), 'G');
+    EXPECT_DOUBLE_EQ(el.heaviest_non_gap_proba('-'), .3);
+    EXPECT_EQ(el.heaviest_non_gap_value('A'), '-');
+
+    EXPECT_THROW({
+        WType().heaviest_non_gap_value('-');
+    }, std::runtime_error);
+}
+
+TEST(WeightedCharTest, QuantizedArray) {
+    using WType = weighted_char<w_char_quantized_array<test_alphabet, uint16_t>>;
+
+    WType el;
+    el['A'] = .4;
+    el['C'] = .2;
+    el['G'] = .4;
+
+    EXPECT_TRUE(el.is_good());
+    EXPECT_EQ(el.heaviest_value(), 'A');
+    EXPECT_EQ(el.heaviest_non_gap_value('A'), 'G');
+    EXPECT_NEAR(el.heaviest_non_gap_proba('A'), .4, 1e-5);
+    EXPECT_EQ(el.heaviest_non_gap_value('-'), 'A');
 }
\ No newline at end of file
@@ -0,0 +1,236 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <random>
+#include <algorithm>
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_compressed.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedCompressedTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedCompressedTest, MyTypes);
+
+//! Random weighted string over "abcd" where most positions have a letter of probability 1, and some have none
+template <class Container>
+weighted_string<Container> random_certain_ws(size_t n, std::mt19937& gen)
+{
+    weighted_string<Container> ws = random_ws<Container>(n, gen, "abcd", .3, .7);
+
+    for (size_t i = 0; i < n; i += 50) {
+        ws[i] = weighted_char<Container>(WstrTest<Container>::el({{'a', 0.}, {'b', 0.}}), false);
+    }
+
+    return ws;
+}
+
+TYPED_TEST(WeightedCompressedTest, Access) {
+    using WType = weighted_string<TypeParam>;
+
+    std::mt19937 gen(1);
+    WType ws = random_certain_ws<TypeParam>(1000, gen);
+    ws.set_gap('d');
+
+    compressed_ws<TypeParam> cws(ws);
+
+    ASSERT_EQ(cws.size(), ws.size());
+    EXPECT_EQ(cws.gap(), 'd');
+    EXPECT_EQ(cws.letter_bits(), 2);
+    EXPECT_LT(cws.uncertain(), 400);
+    EXPECT_GT(cws.uncertain(), 200);
+
+    // Dead positions (every 50 positions) take the first letter of the alphabet
+    std::string heaviest = ws.heaviest();
+
+    for (size_t i = 0; i < ws.size(); i += 50) {
+        heaviest[i] = 'a';
+    }
+
+    std::string heaviest_ungap = heaviest;
+    heaviest_ungap.erase(std::remove(heaviest_ungap.begin(), heaviest_ungap.end(), 'd'), heaviest_ungap.end());
+
+    for (size_t i = 0; i < ws.size(); ++i) {
+        EXPECT_EQ(cws.certain(i), ws[i].heaviest_proba() == 1.) << "position " << i;
+        EXPECT_EQ(cws.letter(i), heaviest[i]);
+
+        for (char c : std::string("abcdj")) {
+            ASSERT_EQ(cws.p(i, c), ws[i].p(c)) << "position " << i << ", letter " << c;
+            ASSERT_EQ(cws[i].p(c), ws[i].p(c));
+        }
+    }
+
+    EXPECT_EQ(cws.heaviest(), heaviest);
+    EXPECT_EQ(cws.heaviest_ungap(), heaviest_ungap);
+
+    std::vector<char> h(ws.size());
+    EXPECT_EQ(cws.heaviest_ungap(h.data()), heaviest_ungap.size());
+    EXPECT_EQ(std::string(h.data(), heaviest_ungap.size()), heaviest_ungap);
+
+    EXPECT_NEAR(cws.log_p(10, ws.heaviest().substr(10, 20)), ws.log_p(10, ws.heaviest().substr(10, 20)), 1e-12);
+
+    weighted_string<TypeParam> decompressed = cws.decompress();
+
+    ASSERT_EQ(decompressed.size(), ws.size());
+    EXPECT_EQ(decompressed.gap(), 'd');
+    EXPECT_EQ(decompressed.heaviest(), ws.heaviest());
+
+    EXPECT_THROW(cws.at(ws.size()), std::out_of_range);
+}
+
+TYPED_TEST(WeightedCompressedTest, Dead) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws;
+
+    ws.emplace_back(this->el({{'a', 1.}}), false);
+    ws.emplace_back(this->el({}), false);
+    ws.emplace_back(this->el({{'a', .5}, {'b', .5}}), false);
+
+    // Positions without any letter are allowed with ws_not_strict, they are uncertain and no pattern occurs over them
+    compressed_ws<TypeParam> cws(ws);
+
+    EXPECT_EQ(cws.uncertain(), 2);
+    EXPECT_FALSE(cws.certain(1));
+    EXPECT_EQ(cws.p(1, 'a'), 0.);
+    EXPECT_EQ(cws.letter(1), 'a');
+
+    for (const std::string& pattern : {"a", "ab", "b"}) {
+        EXPECT_EQ(find_occurrences(cws, pattern, 2.), find_occurrences(ws, pattern, 2.)) << pattern;
+    }
+
+    EXPECT_EQ(find_occurrences(cws, "a", 2.), std::vector<size_t>({0, 2}));
+
+    WType all_dead;
+    all_dead.emplace_back(this->el({}), false);
+    all_dead.emplace_back(this->el({}), false);
+
+    compressed_ws<TypeParam> cws_dead(all_dead);
+
+    EXPECT_EQ(cws_dead.uncertain(), 2);
+    EXPECT_EQ(cws_dead.heaviest(), "AA");
+    EXPECT_TRUE(find_occurrences(cws_dead, "A", 1.).empty());
+}
+
+TYPED_TEST(WeightedCompressedTest, Epsilon) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws = {
+        this->el({{'a', .999999}, {'b', .000001}}),
+        this->el({{'a', .9}, {'b', .1}}),
+        this->el({{'c', 1.}})
+    };
+
+    compressed_ws<TypeParam> exact(ws);
+    compressed_ws<TypeParam> rounded(ws, 1e-5);
+
+    EXPECT_EQ(exact.uncertain(), 2);
+    EXPECT_EQ(rounded.uncertain(), 1);
+    EXPECT_EQ(rounded.p(0, 'a'), 1.);
+    EXPECT_EQ(rounded.p(0, 'b'), 0.);
+    EXPECT_EQ(rounded.p(1, 'b'), .1);
+    EXPECT_EQ(rounded.heaviest(), "aac");
+
+    EXPECT_THROW(compressed_ws<TypeParam>(ws, 1.), std::invalid_argument);
+    EXPECT_THROW(compressed_ws<TypeParam>(ws, -.1), std::invalid_argument);
+
+    compressed_ws<TypeParam> empty{WType()};
+
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.heaviest(), "");
+}
+
+TYPED_TEST(WeightedCompressedTest, Matching) {
+    using WType = weighted_string<TypeParam>;
+
+    std::mt19937 gen(2);
+    std::uniform_int_distribution<int> letter(0, 3);
+
+    WType ws = random_certain_ws<TypeParam>(2000, gen);
+    compressed_ws<TypeParam> cws(ws);
+
+    std::vector<std::string> patterns;
+    std::string h = ws.heaviest();
+
+    for (size_t m : {1, 2, 3, 5, 8}) {
+        patterns.push_back(h.substr(100 * m, m));
+
+        std::string random(m, 'a');
+
+        for (char& c : random) {
+            c = "abcd"[letter(gen)];
+        }
+
+        patterns.push_back(random);
+    }
+
+    for (double z : {1., 2., 8., 100.}) {
+        weighted_pattern_matcher<WType> expected(ws, z);
+        compressed_pattern_matcher<TypeParam> matcher(cws, z);
+
+        EXPECT_EQ(matcher.find_all(patterns), expected.find_all(patterns)) << "z = " << z;
+
+        for (size_t i = 0; i < 200; ++i) {
+            ASSERT_EQ(matcher.occurs_at(patterns[0], i), expected.occurs_at(patterns[0], i));
+        }
+    }
+
+    EXPECT_EQ(find_occurrences(cws, h.substr(10, 4), 4.), find_occurrences(ws, h.substr(10, 4), 4.));
+    EXPECT_TRUE(find_occurrences(cws, "", 4.).empty());
+
+    EXPECT_THROW(compressed_pattern_matcher<TypeParam>(cws, .5), std::invalid_argument);
+}
+
+TEST(WeightedCompressedTest, Dna) {
+    std::vector<w_string_dna> wsv;
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> wsv;
+
+    for (const w_string_dna& original : wsv) {
+        // Most positions have a letter of probability > 0.999
+        compressed_ws<dna_container<dna_alph>> cws(original, 1e-3);
+        w_string_dna ws = cws.decompress();
+
+        EXPECT_EQ(cws.heaviest(), original.heaviest());
+        EXPECT_LT(cws.uncertain(), ws.size() / 4);
+        EXPECT_EQ(compressed_ws<dna_container<dna_alph>>(original).uncertain(), ws.size());
+
+        for (const std::string& pattern : {std::string("A"), std::string("AN"), std::string("RY"), ws.heaviest().substr(0, 3)}) {
+            for (double z : {1., 2., 16.}) {
+                EXPECT_EQ(find_occurrences(cws, pattern, z), find_occurrences(ws, pattern, z)) << pattern << ", z = " << z;
+            }
+        }
+
+        for (size_t i = 0; i < ws.size(); ++i) {
+            EXPECT_EQ(cws.p(i, 'N'), ws[i].p('N'));
+            EXPECT_EQ(cws.p(i, 'R'), ws[i].p('R'));
+        }
+    }
+
+    // A long DNA weighted string which is mostly certain takes a fraction of its size
+    std::mt19937 gen(3);
+    std::uniform_int_distribution<int> letter(0, 3);
+    w_string_dna ws;
+
+    for (size_t i = 0; i < 10000; ++i) {
+        dna_container<dna_alph> wc;
+        wc["ACGT"[letter(gen)]] = 1.;
+
+        if (0 == i % 20) {
+            wc["ACGT"[(letter(gen))]] = .5;
+            wc["ACGT"[(letter(gen) + 1) % 4]] = .5;
+        }
+
+        ws.emplace_back(wc, false);
+    }
+
+    compressed_ws<dna_container<dna_alph>> cws(ws);
+
+    EXPECT_EQ(cws.letter_bits(), 2);
+    EXPECT_LT(cws.memory(), ws.size() * sizeof(ws[0]) / 5);
+}
\ No newline at end of file
@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
 
+#include <map>
+
 #include "types.h"
 
 #include <wstr/weighted_element.hpp>
@@ -216,4 +218,186 @@ TEST(WeightedElementTest, AdvancedConstructorArray) {
     WType el = t;
 
     advanced_constructor_test(el);
+}
+
+TEST(WeightedElementTest, LogArray) {
+    static const char ab[] = "abc";
+    using CType = w_log_array<char, 3, static_ws_translator<ab>>;
+    using WType = weighted_element<char, CType>;
+
+    WType el1 = CType({.2, .8});
+
+    EXPECT_DOUBLE_EQ(el1.p('a'), .2);
+    EXPECT_DOUBLE_EQ(el1.p('b'), .8);
+    EXPECT_EQ(el1.p('c'), 0.);
+    EXPECT_EQ(el1.p('z'), 0.);
+    EXPECT_DOUBLE_EQ(el1.log_p('a'), std::log(.2));
+    EXPECT_EQ(el1.log_p('c'), -std::numeric_limits<double>::infinity());
+    EXPECT_EQ(el1.log_p('z'), -std::numeric_limits<double>::infinity());
+    EXPECT_EQ(el1.heaviest_value(), 'b');
+    EXPECT_DOUBLE_EQ(el1.heaviest_proba(), .8);
+    EXPECT_TRUE(el1.is_good());
+
+    el1['c'] = .3;
+    el1['a'] = el1['c'];
+
+    EXPECT_DOUBLE_EQ(el1.p('c'), .3);
+    EXPECT_DOUBLE_EQ(el1.p('a'), .3);
+    EXPECT_DOUBLE_EQ(el1['c'], .3);
+    EXPECT_FALSE(el1.is_good());
+    EXPECT_TRUE(el1.is_good(.5));
+    EXPECT_DOUBLE_EQ(el1.probabilities().log_sum(), std::log(1.4));
+
+    // Sum of tiny probabilities, which would underflow with a naive exp
+    CType tiny;
+    for (char c : {'a', 'b', 'c'}) {
+        tiny.data()[static_ws_translator<ab>::get_indice(c)] = -800.;
+    }
+    EXPECT_DOUBLE_EQ(tiny.log_sum(), -800. + std::log(3.));
+
+    EXPECT_THROW({
+        WType(CType({.2, .7}));
+    }, std::invalid_argument);
+
+    WType empty;
+    EXPECT_EQ(empty.p('a'), 0.);
+    EXPECT_EQ(empty.probabilities().log_sum(), -std::numeric_limits<double>::infinity());
+    EXPECT_FALSE(empty.is_good());
+}
+
+TEST(WeightedElementTest, QuantizedArray) {
+    static const char ab[] = "abc";
+    using U8Type = w_quantized_array<char, 3, static_ws_translator<ab>, uint8_t>;
+    using U16Type = w_quantized_array<char, 3, static_ws_translator<ab>, uint16_t, 10000>;
+    using FType = w_quantized_array<char, 3, static_ws_translator<ab>, float>;
+    using U8Element = weighted_element<char, U8Type>;
+    using FElement = weighted_element<char, FType>;
+
+    static_assert(sizeof(U8Type) == 3);
+    static_assert(sizeof(U16Type) == 6);
+    static_assert(sizeof(FType) == 12);
+
+    // Values are rounded to the nearest multiple of 1 / Scale
+    EXPECT_EQ(U8Type::quantizer::encode(1.), 255);
+    EXPECT_EQ(U8Type::quantizer::encode(.5), 128);
+    EXPECT_EQ(U8Type::quantizer::encode(-.1), 0);
+    EXPECT_EQ(U8Type::quantizer::encode(2.), 255);
+    EXPECT_EQ(U8Type::quantizer::decode(255), 1.);
+    EXPECT_EQ(U16Type::quantizer::encode(.12345), 1235);
+    EXPECT_EQ(U16Type::quantizer::encode(3.), 30000);
+    EXPECT_EQ(U16Type::quantizer::decode(2500), .25);
+
+    U8Element el1 = U8Type({.2, .7, .1});
+
+    EXPECT_NEAR(el1.p('a'), .2, U8Type::quantizer::error());
+    EXPECT_NEAR(el1.p('b'), .7, U8Type::quantizer::error());
+    EXPECT_EQ(el1.p('z'), 0.);
+    EXPECT_EQ(el1.heaviest_value(), 'b');
+    EXPECT_TRUE(el1.is_good());
+
+    el1['c'] = .3;
+    el1['a'] = el1['b'];
+
+    EXPECT_EQ(el1.p('a'), el1.p('b'));
+    EXPECT_NEAR(el1['c'], .3, U8Type::quantizer::error());
+    EXPECT_FALSE(el1.is_good());
+    EXPECT_TRUE(el1.is_good(.8));
+
+    weighted_element<char, U16Type> el2 = U16Type({1. / 3, 1. / 3, 1. / 3});
+
+    EXPECT_NEAR(el2.p('c'), 1. / 3, 1e-4);
+    EXPECT_EQ(el2.probabilities().sum(), .9999);
+    EXPECT_TRUE(el2.is_good());
+
+    FElement el3 = FType({.1, .2, .7});
+
+    EXPECT_FLOAT_EQ(el3.p('a'), .1);
+    EXPECT_EQ(el3.heaviest_value(), 'c');
+    EXPECT_TRUE(el3.is_good());
+
+    EXPECT_THROW({
+        U8Element bad(U8Type({.2, .7}));
+    }, std::invalid_argument);
+
+    EXPECT_THROW({
+        FElement bad(FType({.1, .2, .6999}));
+    }, std::invalid_argument);
+}
+
+TEST(WeightedElementTest, Sparse) {
+    using CType = w_sparse<char, 2>;
+    using WType = weighted_element<char, CType>;
+
+    CType c = {{'d', .1}, {'b', .2}};
+
+    EXPECT_FALSE(c.spilled());
+    EXPECT_EQ(c.size(), 2);
+    EXPECT_EQ(c.begin()->first, 'b');
+
+    // Third element goes to the heap, the order is kept
+    c['a'] = .3;
+    c['c'] = .4;
+
+    EXPECT_TRUE(c.spilled());
+    EXPECT_EQ(c.size(), 4);
+
+    std::string keys;
+    c.for_each([&keys](char k, double) { keys += k; });
+    EXPECT_EQ(keys, "abcd");
+
+    WType el = c;
+
+    EXPECT_DOUBLE_EQ(el.p('a'), .3);
+    EXPECT_DOUBLE_EQ(el.p('d'), .1);
+    EXPECT_EQ(el.p('e'), 0.);
+    EXPECT_EQ(el.heaviest_value(), 'c');
+    EXPECT_TRUE(el.is_good());
+
+    // Copies do not share the buffers
+    CType copy = c;
+    copy['a'] = .5;
+
+    EXPECT_DOUBLE_EQ(c.at('a'), .3);
+    EXPECT_NE(copy, c);
+    copy['a'] = .3;
+    EXPECT_EQ(copy, c);
+
+    CType small;
+    small['z'] = 1.;
+    small['y'] = 0.;
+
+    EXPECT_EQ(small.size(), 2);
+    EXPECT_EQ(small.heaviest(), 'z');
+    EXPECT_NE(small, CType({{'z', 1.}}));
+
+    EXPECT_THROW({
+        CType().heaviest();
+    }, std::runtime_error);
+}
+
+TYPED_TEST(WeightedElementTest, LogP) {
+    using WType = weighted_element<char, TypeParam>;
+    using CType = WeightedElementTest<TypeParam>;
+
+    WType el = CType::el({{'a', .25}, {'b', .75}});
+
+    EXPECT_DOUBLE_EQ(el.log_p('a'), std::log(.25));
+    EXPECT_DOUBLE_EQ(el.log_p('b'), std::log(.75));
+    EXPECT_EQ(el.log_p('c'), -std::numeric_limits<double>::infinity());
+}
+
+TYPED_TEST(WeightedElementTest, ForEach) {
+    using WType = weighted_element<char, TypeParam>;
+    using CType = WeightedElementTest<TypeParam>;
+
+    WType el = CType::el({{'a', .25}, {'b', .75}});
+
+    std::map<char, double> values;
+    el.for_each([&values](char c, double p) {
+        if (0. != p) {
+            values[c] = p;
+        }
+    });
+
+    EXPECT_EQ(values, (std::map<char, double>({{'a', .25}, {'b', .75}})));
 }
\ No newline at end of file
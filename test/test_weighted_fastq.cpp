@@ -0,0 +1,201 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+
+#include <random>
+#include <sstream>
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_fastq.hpp>
+
+using namespace wstr;
+
+typedef dna_container<dna_alph> dna;
+
+//! Text of n random FASTQ records, with reads of 0 to 200 bases and some N
+static std::string random_fastq(size_t n, const char* end = "\n")
+{
+    std::mt19937 gen(n);
+    std::uniform_int_distribution<size_t> length(0, 200);
+    std::uniform_int_distribution<int> base(0, 39), quality('!', '~');
+
+    std::string text;
+
+    for (size_t k = 0; k < n; ++k) {
+        size_t l = length(gen);
+        std::string bases, qualities;
+
+        for (size_t i = 0; i < l; ++i) {
+            int b = base(gen);
+            bases += b < 36 ? "ACGTacgt"[b % 8] : 'N';
+            qualities += static_cast<char>(quality(gen));
+        }
+
+        text += "@read" + std::to_string(k) + end + bases + end + "+" + end + qualities + end;
+    }
+
+    return text;
+}
+
+TEST(WeightedFastqTest, Table) {
+    phred_table<dna> table;
+
+    EXPECT_NEAR(table('A', 'I').p('A'), .9999, 1e-12);
+    EXPECT_NEAR(table('A', 'I').p('C'), .0001 / 3, 1e-12);
+    EXPECT_NEAR(table('c', '5').p('C'), .99, 1e-12);
+    EXPECT_NEAR(table('c', '5').p('G'), .01 / 3, 1e-12);
+    EXPECT_EQ(table('G', '!').p('G'), 0.);
+    EXPECT_NEAR(table('G', '!').p('T'), 1. / 3, 1e-12);
+    EXPECT_EQ(table('N', 'I').p('T'), .25);
+    EXPECT_EQ(table('N', 'I').p('N'), 1.);
+
+    for (char q = '!'; q <= '~'; ++q) {
+        EXPECT_NEAR(table('T', q).p('N'), 1., 1e-12);
+    }
+
+    EXPECT_TRUE(table.valid_base('R'));
+    EXPECT_TRUE(table.valid_base('.'));
+    EXPECT_FALSE(table.valid_base('1'));
+    EXPECT_FALSE(table.valid_base('-'));
+    EXPECT_FALSE(table.valid_quality(' '));
+    EXPECT_FALSE(table.valid_quality(127));
+
+    phred_table<dna> old(64);
+
+    EXPECT_FALSE(old.valid_quality('?'));
+    EXPECT_NEAR(old('A', 'T').p('A'), .99, 1e-12);
+
+    // Other containers and bases
+    phred_table<w_char_map> binary(33, "ab");
+
+    EXPECT_NEAR(binary('a', '+').p('b'), .1, 1e-12);
+    EXPECT_EQ(binary('a', '+').probabilities().size(), 2);
+    EXPECT_EQ(binary('z', '+').p('a'), .5);
+
+    EXPECT_THROW({
+        phred_table<dna> t(33, "A");
+    }, std::invalid_argument);
+}
+
+TEST(WeightedFastqTest, File) {
+    std::vector<w_string_dna> reads;
+    std::vector<std::string> names;
+
+    load_fastq(TEST_PATH("reads.fastq"), reads, &names);
+
+    ASSERT_EQ(reads.size(), 3);
+    EXPECT_EQ(names, std::vector<std::string>({"read1 first read", "read2", "read3"}));
+
+    ASSERT_EQ(reads[0].size(), 4);
+    // The quality 0 of the last base gives it a probability 0
+    EXPECT_EQ(reads[0].heaviest(), "ACGA");
+    EXPECT_NEAR(reads[0][0].p('A'), .9999, 1e-12);
+    EXPECT_NEAR(reads[0][1].p('C'), .99, 1e-12);
+    EXPECT_NEAR(reads[0][2].p('G'), .9, 1e-12);
+    EXPECT_EQ(reads[0][3].p('T'), 0.);
+
+    ASSERT_EQ(reads[1].size(), 4);
+    EXPECT_NEAR(reads[1][0].p('A'), 1. - std::pow(10., -3.), 1e-12);
+    EXPECT_EQ(reads[1][2].p('G'), .25);
+    EXPECT_EQ(reads[1].heaviest(), "ACAG");
+
+    EXPECT_TRUE(reads[2].empty());
+
+    // Same in a flat collection
+    flat_ws_collection<dna> flat;
+    load_fastq(TEST_PATH("reads.fastq"), flat);
+
+    ASSERT_EQ(flat.size(), 3);
+
+    for (size_t k = 0; k < 3; ++k) {
+        ASSERT_EQ(flat[k].size(), reads[k].size());
+
+        for (size_t i = 0; i < reads[k].size(); ++i) {
+            EXPECT_EQ(flat[k][i], reads[k][i]);
+        }
+    }
+
+    EXPECT_THROW(load_fastq(TEST_PATH("missing.fastq"), reads), std::runtime_error);
+}
+
+TEST(WeightedFastqTest, Batches) {
+    // Several chunks of input
+    std::string text = random_fastq(20000);
+    ASSERT_GT(text.size(), 2 * fastq_reader<dna>::chunk_size);
+
+    std::vector<w_string_dna> expected;
+    std::vector<std::string> names;
+
+    {
+        std::istringstream in(text);
+        fastq_reader<dna> reader(in);
+
+        EXPECT_EQ(reader.read(expected, static_cast<size_t>(-1), &names), 20000);
+        EXPECT_EQ(reader.read(expected), 0);
+        EXPECT_EQ(names[12345], "read12345");
+    }
+
+    phred_table<dna> table;
+
+    for (size_t k = 0; k < expected.size(); k += 101) {
+        size_t start = text.find("@" + names[k] + "\n") + names[k].size() + 2;
+        size_t size = expected[k].size();
+
+        for (size_t i = 0; i < size; ++i) {
+            ASSERT_EQ(expected[k][i], table(text[start + i], text[start + size + 3 + i]));
+        }
+    }
+
+    // By batches, with several threads, and with Windows line ends
+    std::string crlf = random_fastq(20000, "\r\n");
+
+    for (const std::string* input : {&text, &crlf}) {
+        std::istringstream in(*input);
+        fastq_reader<dna> reader(in);
+        std::vector<w_string_dna> reads, batch;
+
+        while (size_t count = reader.read(batch, 777, nullptr, 3)) {
+            ASSERT_EQ(count, batch.size());
+            ASSERT_LE(count, 777);
+
+            reads.insert(reads.end(), batch.begin(), batch.end());
+            batch.clear();
+        }
+
+        EXPECT_EQ(reads, expected);
+        EXPECT_EQ(reader.line(), 80001);
+    }
+
+    // Without the last line end
+    std::istringstream in(text.substr(0, text.size() - 1));
+    std::vector<w_string_dna> reads;
+    fastq_reader<dna>(in).read(reads);
+
+    EXPECT_EQ(reads, expected);
+}
+
+TEST(WeightedFastqTest, Errors) {
+    auto error_line = [](const std::string& text) -> size_t {
+        std::istringstream in(text);
+        fastq_reader<dna> reader(in);
+        std::vector<w_string_dna> reads;
+
+        try {
+            reader.read(reads);
+        }
+        catch (const ws_parse_error& e) {
+            EXPECT_TRUE(reads.empty());
+            return e.line();
+        }
+
+        return 0;
+    };
+
+    EXPECT_EQ(error_line("@r\nAC\n+\nII\n"), 0);
+    EXPECT_EQ(error_line("@r\nAC\n+\nII\n>r\nAC\n+\nII\n"), 5);
+    EXPECT_EQ(error_line("@r\nAC\n+\nII\n@r\nAC\n-\nII\n"), 7);
+    EXPECT_EQ(error_line("@r\nAC\n+\nII\n@r\nAC\n+\nIII\n"), 8);
+    EXPECT_EQ(error_line("@r\nAC\n+\nII\n@r\nAC\n+\n"), 8);
+    EXPECT_EQ(error_line("@r\nAC\n+\nII\n@r\nA1\n+\nII\n"), 6);
+    EXPECT_EQ(error_line("@r\nAC\n+\nII\n@r\nAC\n+\nI \n"), 8);
+    EXPECT_EQ(error_line("\n\n@r\nAC\n+\nII\n@r\nAC"), 9);
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <sstream>
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_flat.hpp>
+
+using namespace wstr;
+
+//! Check that the flat collection has exactly the weighted strings of a collection
+template <class Container, class WStringCollection>
+void expect_same(const flat_ws_collection<Container>& flat, const WStringCollection& wsc)
+{
+    ASSERT_EQ(flat.size(), wsc.size());
+
+    size_t positions = 0;
+
+    for (size_t i = 0; i < wsc.size(); ++i) {
+        ASSERT_EQ(flat[i].size(), wsc[i].size());
+        EXPECT_EQ(flat[i].gap(), wsc[i].gap());
+        EXPECT_EQ(flat[i].data(), flat.data() + flat.offset(i));
+        EXPECT_EQ(flat[i].to_weighted_string(), wsc[i]);
+        EXPECT_EQ(flat[i].heaviest(), wsc[i].heaviest());
+
+        positions += wsc[i].size();
+    }
+
+    EXPECT_EQ(flat.positions(), positions);
+}
+
+TEST(WeightedFlatTest, Read) {
+    using Container = w_char_array<test_alphabet>;
+
+    std::vector<weighted_string<Container>> wsc;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsc;
+
+    flat_ws_collection<Container> flat;
+    TEST_FILE("wsv2.txt") >> ws_gap >> flat;
+    expect_same(flat, wsc);
+
+    ws_options options;
+    options.gap = true;
+
+    flat_ws_collection<Container> parsed;
+    load_ws(TEST_PATH("wsv2.txt"), parsed, options);
+    expect_same(parsed, wsc);
+
+    // Reading again replaces the weighted strings
+    load_ws(TEST_PATH("wsv2.txt"), parsed);
+    EXPECT_EQ(parsed.size(), wsc.size());
+    EXPECT_EQ(parsed[0].gap(), NO_GAP);
+}
+
+TEST(WeightedFlatTest, Errors) {
+    using Container = w_char_array<test_alphabet>;
+
+    std::string text = "2\nab\n1\n.5 .5\n2\n.5 .5\n.5\n";
+    flat_ws_collection<Container> flat;
+
+    EXPECT_THROW(parse_ws(text.data(), text.data() + text.size(), flat), ws_parse_error);
+
+    // The weighted strings read before the error are kept, without the positions of the invalid one
+    EXPECT_EQ(flat.size(), 1);
+    EXPECT_EQ(flat.positions(), 1);
+
+    // A corrupt count of weighted strings is a parse error, not an allocation failure
+    for (std::string corrupt : {"18446744073709551615\nab\n1\n.5 .5\n", "1000000000000\nab\n1\n.5 .5\n"}) {
+        EXPECT_THROW(parse_ws(corrupt.data(), corrupt.data() + corrupt.size(), flat), ws_parse_error);
+    }
+
+    // A truncated stream fails and keeps the weighted strings read entirely
+    for (size_t length : {0, 3, 10, 14, 18}) {
+        std::stringstream in(text.substr(0, length));
+        in >> ws_not_strict >> flat;
+
+        EXPECT_TRUE(in.fail()) << length;
+        EXPECT_EQ(flat.size(), length >= 14 ? 1 : 0) << length;
+        EXPECT_EQ(flat.positions(), flat.size()) << length;
+    }
+}
+
+TEST(WeightedFlatTest, Append) {
+    w_string_dna_gap_collection wsc;
+    TEST_FILE("dna3.txt") >> wsc;
+    wsc.push_back(w_string_dna_gap());
+
+    flat_ws_collection<dna_container<dna_alph_gap>> flat;
+    flat.append(wsc);
+    expect_same(flat, wsc);
+    EXPECT_TRUE(flat[2].empty());
+
+    flat.push_back(weighted_string_view<dna_container<dna_alph_gap>>(wsc[0], 1, 2));
+    flat.append(wsc[1].data(), 1, 'A');
+
+    ASSERT_EQ(flat.size(), 5);
+    EXPECT_EQ(flat[3].heaviest(), wsc[0].heaviest().substr(1, 2));
+    EXPECT_EQ(flat[4].size(), 1);
+    EXPECT_EQ(flat[4].gap(), 'A');
+    EXPECT_THROW(flat.at(5), std::out_of_range);
+
+    size_t strings = 0;
+
+    for (weighted_string_view<dna_container<dna_alph_gap>> ws : flat) {
+        EXPECT_EQ(ws.data(), flat.data() + flat.offset(strings++));
+    }
+
+    EXPECT_EQ(strings, flat.size());
+    EXPECT_EQ(flat.end() - flat.begin(), 5);
+
+    // Moving keeps the positions in place
+    const auto* data = flat.data();
+    flat_ws_collection<dna_container<dna_alph_gap>> moved(std::move(flat));
+
+    EXPECT_EQ(moved.data(), data);
+    EXPECT_EQ(moved.size(), 5);
+
+    // The moved-from collection is empty and can be used again
+    EXPECT_TRUE(flat.empty());
+    EXPECT_EQ(flat.positions(), 0);
+
+    flat.push_back(wsc[0]);
+    ASSERT_EQ(flat.size(), 1);
+    EXPECT_EQ(flat.at(0).heaviest(), wsc[0].heaviest());
+
+    flat = std::move(moved);
+    EXPECT_EQ(flat.size(), 5);
+    EXPECT_TRUE(moved.empty());
+
+    moved.push_back(wsc[1]);
+    EXPECT_EQ(moved.at(0).heaviest(), wsc[1].heaviest());
+
+    moved.clear();
+    EXPECT_TRUE(moved.empty());
+    EXPECT_EQ(moved.positions(), 0);
+
+    static_assert(!std::is_copy_constructible<flat_ws_collection<dna_container<dna_alph>>>::value, "The flat collection should be move-only");
+}
\ No newline at end of file
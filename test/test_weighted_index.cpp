@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <limits>
+#include <sstream>
+#include <algorithm>
+
+#include "config.h"
+#include "types.h"
+
+#include <wstr/weighted_index.hpp>
+#include <wstr/weighted_matching.hpp>
+#include <wstr/dna_weighted_string.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedIndexTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedIndexTest, MyTypes);
+
+//! All strings of length at most `length` over an alphabet
+static std::vector<std::string> patterns_up_to(const std::string& alph, size_t length)
+{
+    std::vector<std::string> patterns;
+    std::vector<std::string> last = {""};
+
+    for (size_t l = 0; l < length; ++l) {
+        std::vector<std::string> next;
+
+        for (const std::string& p : last) {
+            for (char c : alph) {
+                next.push_back(p + c);
+            }
+        }
+
+        patterns.insert(patterns.end(), next.begin(), next.end());
+        last.swap(next);
+    }
+
+    return patterns;
+}
+
+//! Occurrences of the index in increasing order, as given by the pattern matcher
+static std::vector<size_t> sorted_find(const weighted_index& index, const std::string& pattern)
+{
+    std::vector<size_t> occ = index.find(pattern);
+    std::sort(occ.begin(), occ.end());
+
+    return occ;
+}
+
+//! Check that the index gives the same occurrences than the pattern matcher
+template <class WString>
+static void expect_same_as_matcher(const WString& ws, double z, const std::string& alph, size_t length)
+{
+    weighted_index index(ws, z);
+    weighted_pattern_matcher<WString> matcher(ws, z);
+
+    EXPECT_EQ(index.strings(), static_cast<size_t>(z));
+    EXPECT_EQ(index.size(), ws.size());
+
+    for (const std::string& pattern : patterns_up_to(alph, length)) {
+        EXPECT_EQ(sorted_find(index, pattern), matcher.find(pattern)) << pattern << " " << z;
+    }
+}
+
+TYPED_TEST(WeightedIndexTest, Basic) {
+    weighted_string<TypeParam> ws;
+    TEST_FILE("ws1.txt") >> ws;
+
+    weighted_index index(ws, 1.);
+
+    EXPECT_EQ(index.strings(), 1);
+    EXPECT_EQ(index.estimation(0), "addb");
+    EXPECT_EQ(index.find("d"), std::vector<size_t>({1}));
+    EXPECT_EQ(index.find("a"), std::vector<size_t>());
+    EXPECT_EQ(index.find(""), std::vector<size_t>());
+    EXPECT_EQ(index.find("addba"), std::vector<size_t>());
+    EXPECT_TRUE(index.contains("d"));
+    EXPECT_FALSE(index.contains("b"));
+
+    EXPECT_THROW({
+        weighted_index(ws, .5);
+    }, std::invalid_argument);
+
+    for (double z : {1., 2., 3., 4.5, 10., 40.}) {
+        expect_same_as_matcher(ws, z, "abcd", 4);
+    }
+}
+
+TYPED_TEST(WeightedIndexTest, Gap) {
+    std::vector<weighted_string<TypeParam>> wsv;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    for (const auto& ws : wsv) {
+        for (double z : {1., 2., 2.5, 4., 7., 16.}) {
+            expect_same_as_matcher(ws, z, "ab-", 5);
+        }
+    }
+}
+
+TEST(WeightedIndexTest, Random) {
+    static const char alph[] = "abcd";
+
+    std::mt19937 gen(1);
+    std::uniform_real_distribution<double> dist(0., 1.);
+    std::bernoulli_distribution certain(.7);
+
+    w_string_array<alph> ws;
+
+    for (size_t i = 0; i < 400; ++i) {
+        w_char_array<alph> wc;
+
+        if (certain(gen)) {
+            wc[alph[i % 4]] = 1.;
+        }
+        else {
+            double sum = 0.;
+            for (char c : std::string(alph)) {
+                wc[c] = std::pow(dist(gen), 3);
+                sum += wc.at(c);
+            }
+            for (char c : std::string(alph)) {
+                wc[c] = wc.at(c) / sum;
+            }
+        }
+
+        ws.emplace_back(wc, false);
+    }
+
+    for (double z : {1., 3., 8., 12.5, 32.}) {
+        expect_same_as_matcher(ws, z, alph, 5);
+    }
+}
+
+TEST(WeightedIndexTest, Dna) {
+    w_string_dna_collection wsc;
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> wsc;
+
+    for (const auto& ws : wsc) {
+        for (double z : {1., 4., 50., 2000.}) {
+            weighted_index index(ws, z);
+            weighted_pattern_matcher<w_string_dna> matcher(ws, z);
+
+            std::string heaviest = ws.heaviest();
+
+            for (size_t i = 0; i < heaviest.size(); ++i) {
+                for (size_t m = 1; i + m <= heaviest.size() && m <= 6; ++m) {
+                    std::string pattern = heaviest.substr(i, m);
+
+                    EXPECT_EQ(sorted_find(index, pattern), matcher.find(pattern)) << pattern << " " << z;
+
+                    // One substitution
+                    for (char c : std::string(dna_alph)) {
+                        std::string other = pattern;
+                        other[m / 2] = c;
+                        EXPECT_EQ(sorted_find(index, other), matcher.find(other)) << other << " " << z;
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST(WeightedIndexTest, SaveLoad) {
+    std::vector<w_string_map> wsv;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    weighted_index index(wsv[0], 5.);
+
+    std::stringstream buffer;
+    index.save(buffer);
+
+    weighted_index loaded = weighted_index::load(buffer);
+
+    EXPECT_EQ(loaded.z(), index.z());
+    EXPECT_EQ(loaded.size(), index.size());
+    EXPECT_EQ(loaded.strings(), index.strings());
+    EXPECT_EQ(loaded.memory(), index.memory());
+
+    for (size_t j = 0; j < index.strings(); ++j) {
+        EXPECT_EQ(loaded.estimation(j), index.estimation(j));
+    }
+
+    for (const std::string& pattern : patterns_up_to("ab-", 4)) {
+        EXPECT_EQ(loaded.find(pattern), index.find(pattern)) << pattern;
+    }
+
+    std::stringstream wrong("not an index");
+    EXPECT_THROW({
+        weighted_index::load(wrong);
+    }, std::runtime_error);
+
+    std::string data = buffer.str();
+    std::stringstream truncated(data.substr(0, data.size() / 2));
+    EXPECT_THROW({
+        weighted_index::load(truncated);
+    }, std::runtime_error);
+
+    for (size_t size : {12, 20, 28}) {
+        std::stringstream header(data.substr(0, size));
+        EXPECT_THROW({
+            weighted_index::load(header);
+        }, std::runtime_error) << size;
+    }
+
+    // Sizes which do not match z or do not fit in memory, the header is magic (8), version (4), z, n and k (8 each)
+    for (uint64_t n : {uint64_t(1) << 62, std::numeric_limits<uint64_t>::max()}) {
+        std::string corrupted = data;
+        corrupted.replace(20, 8, reinterpret_cast<const char*>(&n), 8);
+
+        std::stringstream in(corrupted);
+        EXPECT_THROW({
+            weighted_index::load(in);
+        }, std::runtime_error) << n;
+    }
+
+    std::string corrupted = data;
+    corrupted[28] ^= 1;
+
+    std::stringstream wrong_k(corrupted);
+    EXPECT_THROW({
+        weighted_index::load(wrong_k);
+    }, std::runtime_error);
+}
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_kernels.hpp>
+
+using namespace wstr;
+
+//! Random probabilities of n positions, rounded so that there are ties
+template <size_t N>
+std::vector<double> random_positions(size_t n, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> proba(0, 4);
+    std::vector<double> p(n * N);
+
+    for (double& v : p) {
+        v = proba(gen) / 4.;
+    }
+
+    return p;
+}
+
+//! Heaviest letters found with std::max_element
+template <size_t N>
+std::string expected_letters(const std::vector<double>& p, const char* letters, size_t gap)
+{
+    std::string h;
+
+    for (size_t i = 0; i < p.size() / N; ++i) {
+        size_t best = std::distance(p.begin() + i * N, std::max_element(p.begin() + i * N, p.begin() + (i + 1) * N));
+
+        if (best != gap) {
+            h += letters[best];
+        }
+    }
+
+    return h;
+}
+
+template <size_t N>
+void check_kernels(const char* letters)
+{
+    for (size_t n : {0, 1, 3, 4, 5, 8, 13, 100}) {
+        std::vector<double> p = random_positions<N>(n, n);
+
+        for (size_t gap : {N - 1, N}) {
+            std::string expected = expected_letters<N>(p, letters, gap);
+            std::string h(n, ' ');
+
+            h.resize(heaviest_letters_scalar<N>(p.data(), n, letters, gap, &h[0]));
+            EXPECT_EQ(h, expected) << "scalar, n = " << n;
+
+            h.assign(n, ' ');
+            h.resize(heaviest_letters<N>(p.data(), n, letters, gap, &h[0]));
+            EXPECT_EQ(h, expected) << "dispatched, n = " << n;
+
+#ifdef WSTR_AVX2_KERNELS
+            if constexpr (N <= 8) {
+                if (has_avx2()) {
+                    h.assign(n, ' ');
+                    h.resize(heaviest_letters_avx2<N>(p.data(), n, letters, gap, &h[0]));
+                    EXPECT_EQ(h, expected) << "avx2, n = " << n;
+                }
+            }
+#endif
+        }
+    }
+}
+
+TEST(WeightedKernelsTest, Letters) {
+    check_kernels<2>("ab");
+    check_kernels<4>("ACGT");
+    check_kernels<5>("ACGT-");
+    check_kernels<8>("abcdefgh");
+    check_kernels<20>("ACDEFGHIKLMNPQRSTVWY");
+}
+
+TEST(WeightedKernelsTest, WeightedString) {
+    w_string_dna_gap ws = {
+        w_string_dna_gap::w_char({.2, .4, .2, .1, .1}),
+        w_string_dna_gap::w_char({.1, .1, .1, .2, .5}),
+        w_string_dna_gap::w_char({.5, .3, .2, 0., 0.}),
+        w_string_dna_gap::w_char({0., 0., 0., 0., 1.}),
+        w_string_dna_gap::w_char({0., 0., 0., 1., 0.}),
+    };
+
+    std::string h(ws.size(), ' ');
+
+    EXPECT_EQ(ws.heaviest(&h[0]), 5);
+    EXPECT_EQ(h, "C-A-T");
+    EXPECT_EQ(ws.heaviest_ungap(&h[0]), 3);
+    EXPECT_EQ(h.substr(0, 3), "CAT");
+    EXPECT_EQ(ws.heaviest(), "C-A-T");
+    EXPECT_EQ(ws.heaviest_ungap(), "CAT");
+
+    // Same with a container without kernel
+    weighted_string<w_char_map> wsm;
+
+    for (const auto& wc : ws) {
+        w_char_map m;
+        wc.for_each([&](char c, double p) { m[c] = p; });
+        wsm.emplace_back(m);
+    }
+
+    wsm.set_gap('-');
+
+    EXPECT_EQ(wsm.heaviest(&h[0]), 5);
+    EXPECT_EQ(wsm.heaviest_ungap(&h[0]), 3);
+    EXPECT_EQ(h.substr(0, 3), "CAT");
+}
\ No newline at end of file
@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <sstream>
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_mapped.hpp>
+
+using namespace wstr;
+
+//! Temporary file path for a test
+static std::string temp_path(const std::string& name)
+{
+    return testing::TempDir() + "wstr_" + name + ".bin";
+}
+
+//! Check that the view has exactly the probabilities of the weighted string
+template <class WString, class View>
+void expect_same(const View& view, const WString& ws)
+{
+    ASSERT_EQ(view.size(), ws.size());
+    EXPECT_EQ(view.gap(), ws.gap());
+
+    for (size_t i = 0; i < ws.size(); ++i) {
+        EXPECT_EQ(view[i], ws[i]) << "position " << i;
+    }
+
+    EXPECT_EQ(view.heaviest(), ws.heaviest());
+    EXPECT_EQ(view.heaviest_ungap(), ws.heaviest_ungap());
+}
+
+TEST(WeightedMappedTest, WeightedString) {
+    using Container = w_char_array<test_alphabet>;
+
+    weighted_string<Container> ws;
+    TEST_FILE("ws1.txt") >> ws;
+    ws.set_gap('d');
+
+    std::string path = temp_path("ws1");
+    save_ws_binary(path, ws);
+
+    mapped_ws_collection<Container> wsc(path);
+
+    ASSERT_EQ(wsc.size(), 1);
+    EXPECT_EQ(wsc.positions(), 4);
+    expect_same(wsc[0], ws);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(wsc[0].data()) % ws_binary_alignment, 0);
+    EXPECT_EQ(wsc[0].log_p(1, "dc"), ws.log_p(1, "dc"));
+    EXPECT_EQ(wsc[0].to_weighted_string(), ws);
+    EXPECT_THROW(wsc.at(1), std::out_of_range);
+    EXPECT_THROW(wsc[0].at(4), std::out_of_range);
+}
+
+TEST(WeightedMappedTest, Collection) {
+    using Container = w_char_array<test_alphabet>;
+
+    std::vector<weighted_string<Container>> wsv;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    wsv.insert(wsv.begin() + 1, weighted_string<Container>());
+
+    std::string path = temp_path("wsv2");
+    save_ws_binary(path, wsv);
+
+    mapped_ws_collection<Container> wsc(path);
+
+    ASSERT_EQ(wsc.size(), 4);
+    EXPECT_EQ(wsc.positions(), 21);
+    EXPECT_TRUE(wsc[1].empty());
+
+    for (size_t i = 0; i < wsv.size(); ++i) {
+        expect_same(wsc[i], wsv[i]);
+    }
+}
+
+TEST(WeightedMappedTest, Dna) {
+    w_string_dna_gap_collection wsv;
+    wsv.resize(2);
+    TEST_FILE("dna2.txt") >> ws_not_strict >> wsv[0];
+
+    std::string path = temp_path("dna");
+    save_ws_binary(path, wsv);
+
+    mapped_ws_collection<dna_container<dna_alph_gap>> wsc(path);
+
+    ASSERT_EQ(wsc.size(), 2);
+    EXPECT_EQ(wsc[0].gap(), dna_gap);
+    EXPECT_EQ(wsc[1].gap(), dna_gap);
+    expect_same(wsc[0], wsv[0]);
+    EXPECT_EQ(wsc[0][0].p('N'), wsv[0][0].p('N'));
+
+    // The alphabet of the file must be the one of the container
+    EXPECT_THROW(mapped_ws_collection<dna_container<dna_alph>>{path}, std::runtime_error);
+    EXPECT_THROW(mapped_ws_collection<w_char_array<test_alphabet>>{path}, std::runtime_error);
+}
+
+TEST(WeightedMappedTest, Buffer) {
+    using Container = w_char_array<test_alphabet>;
+
+    std::vector<weighted_string<Container>> wsv;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    std::ostringstream out;
+    write_ws_binary(out, wsv.data(), wsv.size());
+    std::string bytes = out.str();
+
+    // Copy into a buffer aligned for doubles
+    std::vector<double> buffer((bytes.size() + sizeof(double) - 1) / sizeof(double));
+    std::copy(bytes.begin(), bytes.end(), reinterpret_cast<char*>(buffer.data()));
+    const char* data = reinterpret_cast<const char*>(buffer.data());
+
+    mapped_ws_collection<Container> wsc(data, bytes.size());
+
+    ASSERT_EQ(wsc.size(), 3);
+    expect_same(wsc[2], wsv[2]);
+
+    EXPECT_THROW((mapped_ws_collection<Container>(data, bytes.size() - 1)), std::runtime_error);
+    EXPECT_THROW((mapped_ws_collection<Container>(data, 10)), std::runtime_error);
+    EXPECT_THROW((mapped_ws_collection<Container>(data + 8, bytes.size() - 8)), std::runtime_error);
+    EXPECT_THROW(mapped_ws_collection<Container>(temp_path("does_not_exist")), std::runtime_error);
+}
\ No newline at end of file
@@ -0,0 +1,186 @@
+#include <gtest/gtest.h>
+
+#include <random>
+
+#include "config.h"
+#include "types.h"
+
+#include <wstr/weighted_matching.hpp>
+#include <wstr/dna_weighted_string.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedMatchingTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedMatchingTest, MyTypes);
+
+//! Naive search which computes the probability of each occurrence
+template <class WString>
+std::vector<size_t> naive_find(const WString& ws, const std::string& pattern, double z)
+{
+    std::vector<size_t> occ;
+
+    for (size_t i = 0; pattern.size() > 0 && i + pattern.size() <= ws.size(); ++i) {
+        double log = 0.;
+
+        for (size_t j = 0; j < pattern.size(); ++j) {
+            log += std::log(ws[i + j].p(pattern[j]));
+        }
+
+        if (log >= -std::log(z) - 1e-10) {
+            occ.push_back(i);
+        }
+    }
+
+    return occ;
+}
+
+//! All strings of a given length over an alphabet
+std::vector<std::string> all_patterns(const std::string& alph, size_t length)
+{
+    std::vector<std::string> patterns = {""};
+
+    for (size_t l = 0; l < length; ++l) {
+        std::vector<std::string> next;
+
+        for (const std::string& p : patterns) {
+            for (char c : alph) {
+                next.push_back(p + c);
+            }
+        }
+
+        patterns.swap(next);
+    }
+
+    return patterns;
+}
+
+TYPED_TEST(WeightedMatchingTest, Basic) {
+    weighted_string<TypeParam> ws;
+    TEST_FILE("ws1.txt") >> ws;
+
+    weighted_pattern_matcher<weighted_string<TypeParam>> matcher(ws, 2.);
+
+    EXPECT_EQ(matcher.z(), 2.);
+    EXPECT_EQ(matcher.find("d"), std::vector<size_t>({1}));
+    EXPECT_EQ(matcher.find("ad"), std::vector<size_t>());
+    EXPECT_EQ(matcher.find(""), std::vector<size_t>());
+    EXPECT_EQ(matcher.find("abcda"), std::vector<size_t>());
+    EXPECT_EQ(matcher.find("z"), std::vector<size_t>());
+    EXPECT_TRUE(matcher.occurs_at("d", 1));
+    EXPECT_FALSE(matcher.occurs_at("d", 2));
+    EXPECT_FALSE(matcher.occurs_at("d", 4));
+
+    EXPECT_EQ(find_occurrences(ws, "dd", 3.), std::vector<size_t>({1}));
+    EXPECT_EQ(find_occurrences(ws, "d", 4.), std::vector<size_t>({0, 1, 2}));
+
+    EXPECT_THROW({
+        weighted_pattern_matcher<weighted_string<TypeParam>>(ws, .5);
+    }, std::invalid_argument);
+}
+
+TYPED_TEST(WeightedMatchingTest, Dead) {
+    weighted_string<TypeParam> ws;
+
+    ws.emplace_back(this->el({{'a', 1.}}), false);
+    ws.emplace_back(this->el({}), false);
+    ws.emplace_back(this->el({{'a', .5}, {'b', .5}}), false);
+
+    // Positions without any letter are allowed with ws_not_strict, no pattern occurs over them
+    EXPECT_EQ(find_occurrences(ws, "a", 2.), std::vector<size_t>({0, 2}));
+    EXPECT_EQ(find_occurrences(ws, "ab", 2.), std::vector<size_t>());
+    EXPECT_EQ(find_occurrences(ws, "b", 2.), std::vector<size_t>({2}));
+}
+
+TYPED_TEST(WeightedMatchingTest, Naive) {
+    std::vector<weighted_string<TypeParam>> wsv;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    for (const auto& ws : wsv) {
+        for (double z : {1., 2., 4., 10., 100.}) {
+            weighted_pattern_matcher<weighted_string<TypeParam>> matcher(ws, z);
+
+            for (size_t length = 1; length <= 4; ++length) {
+                std::vector<std::string> patterns = all_patterns("ab-", length);
+                std::vector<std::vector<size_t>> occ = matcher.find_all(patterns);
+
+                ASSERT_EQ(occ.size(), patterns.size());
+
+                for (size_t k = 0; k < patterns.size(); ++k) {
+                    EXPECT_EQ(occ[k], naive_find(ws, patterns[k], z)) << patterns[k] << " " << z;
+                }
+            }
+        }
+    }
+}
+
+TEST(WeightedMatchingTest, Random) {
+    static const char alph[] = "abcd";
+
+    std::mt19937 gen(0);
+    std::uniform_real_distribution<double> dist(0., 1.);
+
+    w_string_array<alph> ws;
+
+    for (size_t i = 0; i < 300; ++i) {
+        w_char_array<alph> wc;
+        double sum = 0.;
+
+        // Mostly certain positions with a few uncertain ones
+        for (char c : std::string(alph)) {
+            wc[c] = std::pow(dist(gen), 6);
+            sum += wc.at(c);
+        }
+        for (char c : std::string(alph)) {
+            wc[c] = wc.at(c) / sum;
+        }
+
+        ws.emplace_back(wc, false);
+    }
+
+    for (double z : {2., 16., 1000.}) {
+        weighted_pattern_matcher<w_string_array<alph>> matcher(ws, z);
+
+        for (size_t length = 1; length <= 5; ++length) {
+            for (const std::string& pattern : all_patterns(alph, length)) {
+                EXPECT_EQ(matcher.find(pattern), naive_find(ws, pattern, z)) << pattern << " " << z;
+            }
+        }
+    }
+}
+
+TEST(WeightedMatchingTest, Dna) {
+    w_string_dna ws;
+    TEST_FILE("dna1.txt") >> ws;
+
+    weighted_pattern_matcher<w_string_dna> matcher(ws, 1.);
+
+    // N has probability 1 at every position
+    EXPECT_EQ(matcher.find("NG"), std::vector<size_t>({0}));
+    EXPECT_EQ(matcher.find("NNNN"), std::vector<size_t>({0}));
+    EXPECT_EQ(matcher.find("G"), std::vector<size_t>({1}));
+    EXPECT_EQ(matcher.find("A"), std::vector<size_t>());
+
+    for (double z : {1., 2., 3., 5., 20.}) {
+        weighted_pattern_matcher<w_string_dna> m(ws, z);
+
+        for (size_t length = 1; length <= 3; ++length) {
+            for (const std::string& pattern : all_patterns("ACGTRYMKSWHBVDN", length)) {
+                EXPECT_EQ(m.find(pattern), naive_find(ws, pattern, z)) << pattern << " " << z;
+            }
+        }
+    }
+}
+
+TEST(WeightedMatchingTest, DnaGap) {
+    w_string_dna_gap ws;
+    TEST_FILE("dna2.txt") >> ws;
+
+    EXPECT_EQ(find_occurrences(ws, "G-G", 2.), std::vector<size_t>());
+    EXPECT_EQ(find_occurrences(ws, "G-G", 20.), std::vector<size_t>({0}));
+    EXPECT_EQ(find_occurrences(ws, "-", 2.), std::vector<size_t>({1}));
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <wstr/weighted_matrix.hpp>
+
+using namespace wstr;
+
+static const char abcd[] = "abcd";
+static const char ab_gap[] = "ab-";
+
+template <typename T>
+class WeightedMatrixTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedMatrixTest, MyTypes);
+
+TEST(WeightedMatrixTest, Basic) {
+    weighted_matrix<abcd> wm;
+
+    EXPECT_EQ(wm.size(), 0);
+    EXPECT_TRUE(wm.empty());
+    EXPECT_EQ(wm.heaviest(), "");
+
+    wm.resize(3);
+
+    EXPECT_EQ(wm.size(), 3);
+    EXPECT_EQ(wm.p(2, 'a'), 0.);
+
+    wm(0, 'a') = 1.;
+    wm(1, 'b') = .6;
+    wm(1, 'c') = .4;
+    wm(2, 'c') = .2;
+    wm(2, 'd') = .8;
+
+    EXPECT_EQ(wm.p(1, 'b'), .6);
+    EXPECT_EQ(wm.p(1, 'z'), 0.);
+    EXPECT_EQ(wm.heaviest_value(2), 'd');
+    EXPECT_EQ(wm.heaviest_proba(2), .8);
+    EXPECT_TRUE(wm.is_good(1));
+    EXPECT_EQ(wm.heaviest(), "abd");
+    EXPECT_EQ(wm.heaviest_ungap(), "abd");
+
+    EXPECT_FALSE(wm.has_gap());
+    wm.set_gap('b');
+    EXPECT_TRUE(wm.has_gap());
+    EXPECT_EQ(wm.heaviest_ungap(), "ad");
+
+    EXPECT_THROW({
+        wm(0, 'z');
+    }, std::runtime_error);
+
+    // Rows are aligned and keep their values when resized
+    wm.resize(100);
+
+    for (size_t k = 0; k < weighted_matrix<abcd>::sigma; ++k) {
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(wm.row_at(k)) % weighted_matrix<abcd>::alignment, 0);
+    }
+
+    EXPECT_EQ(wm.row('d')[2], .8);
+    EXPECT_EQ(wm.p(99, 'a'), 0.);
+    EXPECT_EQ(wm.heaviest().substr(0, 3), "abd");
+
+    // Positions removed inside the same stride are 0 when growing again
+    wm.resize(2);
+    wm.resize(3);
+
+    EXPECT_EQ(wm.row('d')[2], 0.);
+    EXPECT_EQ(wm.p(1, 'b'), .6);
+}
+
+TEST(WeightedMatrixTest, Tie) {
+    weighted_matrix<abcd> wm(2);
+
+    wm(0, 'b') = .5;
+    wm(0, 'c') = .5;
+    wm(1, 'a') = .25;
+    wm(1, 'b') = .25;
+    wm(1, 'c') = .25;
+    wm(1, 'd') = .25;
+
+    // Same as std::max_element, the first heaviest letter is kept
+    EXPECT_EQ(wm.heaviest(), "ba");
+}
+
+TYPED_TEST(WeightedMatrixTest, Conversion) {
+    weighted_string<TypeParam> ws;
+    TEST_FILE("ws1.txt") >> ws;
+
+    weighted_matrix<abcd> wm(ws);
+
+    EXPECT_EQ(wm.size(), ws.size());
+
+    for (size_t i = 0; i < ws.size(); ++i) {
+        for (char c : std::string(abcd)) {
+            EXPECT_EQ(wm.p(i, c), ws[i].p(c));
+        }
+    }
+
+    EXPECT_EQ(wm.heaviest(), ws.heaviest());
+
+    weighted_string<TypeParam> ws2 = wm.template to_weighted_string<TypeParam>();
+
+    EXPECT_EQ(ws2, ws);
+    EXPECT_EQ(weighted_matrix<abcd>(ws2), wm);
+}
+
+TEST(WeightedMatrixTest, ConversionGap) {
+    std::vector<w_string_array<ab_gap>> wsv;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    std::vector<std::string> heaviest = {"aab-aab-", "ab-aba", "aba-ba-"};
+    std::vector<std::string> heaviest_ungap = {"aabaab", "ababa", "ababa"};
+
+    for (size_t j = 0; j < wsv.size(); ++j) {
+        weighted_matrix<ab_gap> wm(wsv[j]);
+
+        EXPECT_EQ(wm.gap(), '-');
+        EXPECT_EQ(wm.heaviest(), heaviest[j]);
+        EXPECT_EQ(wm.heaviest_ungap(), heaviest_ungap[j]);
+
+        w_string_array<ab_gap> ws = wm.to_weighted_string<w_char_array<ab_gap>>();
+
+        EXPECT_EQ(ws.gap(), '-');
+        EXPECT_EQ(ws, wsv[j]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <cmath>
+#include <random>
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_pwm.hpp>
+
+using namespace wstr;
+
+//! Random profile of m positions, some probabilities are 0
+static w_string_dna random_profile(size_t m, std::mt19937& gen)
+{
+    return random_ws<dna_container<dna_alph>>(m, gen, "ACGT", .2);
+}
+
+//! Random DNA sequence with some N and lowercase letters
+static std::string random_sequence(size_t n, std::mt19937& gen, bool with_n = true)
+{
+    std::uniform_int_distribution<int> letter(0, with_n ? 99 : 7);
+    std::string seq(n, 'A');
+
+    for (char& c : seq) {
+        int l = letter(gen);
+        c = l < 8 ? "ACGTacgt"[l] : (l < 98 ? "ACGT"[l % 4] : 'N');
+    }
+
+    return seq;
+}
+
+//! Score of a window with the profile, in double
+static double naive_score(const w_string_dna& profile, const std::string& seq, size_t i, const std::array<double, 4>& background,
+                          double pseudocount)
+{
+    double score = 0.;
+
+    for (size_t j = 0; j < profile.size(); ++j) {
+        size_t b = pwm_codes[static_cast<unsigned char>(seq[i + j])];
+
+        if (b > 3) {
+            return -std::numeric_limits<double>::infinity();
+        }
+
+        double p = (profile[j].p("ACGT"[b]) + pseudocount * background[b]) / (1. + pseudocount);
+        score += std::log2(p / background[b]);
+    }
+
+    return score;
+}
+
+TEST(WeightedPwmTest, Scores) {
+    w_string_dna profile = {
+        dna_container<dna_alph>({.7, .1, .1, .1}),
+        dna_container<dna_alph>({0., .5, .5, 0.})
+    };
+
+    pwm_scanner scanner(profile);
+
+    ASSERT_EQ(scanner.size(), 2);
+    EXPECT_NEAR(scanner.score(0, 'A'), std::log2(2.8), 1e-6);
+    EXPECT_NEAR(scanner.score(0, 'c'), std::log2(.4), 1e-6);
+    EXPECT_EQ(scanner.score(1, 'G'), 1.f);
+    EXPECT_EQ(scanner.score(1, 'T'), -std::numeric_limits<float>::infinity());
+    EXPECT_EQ(scanner.score(1, 'N'), -std::numeric_limits<float>::infinity());
+    EXPECT_NEAR(scanner.max_score(), std::log2(2.8) + 1., 1e-6);
+    EXPECT_NEAR(scanner.score("AC"), std::log2(2.8) + 1., 1e-6);
+
+    // Background and pseudocount
+    pwm_scanner skewed(profile, {.4, .1, .1, .4}, 1.);
+
+    EXPECT_NEAR(skewed.score(0, 'A'), std::log2((.7 + .4) / 2. / .4), 1e-6);
+    EXPECT_NEAR(skewed.score(1, 'T'), std::log2(.4 / 2. / .4), 1e-6);
+
+    EXPECT_THROW(pwm_scanner(profile, {.5, .5, .5, .5}), std::invalid_argument);
+    EXPECT_THROW(pwm_scanner(profile, {1., 0., 0., 0.}), std::invalid_argument);
+    EXPECT_THROW(pwm_scanner(profile, {.25, .25, .25, .25}, -1.), std::invalid_argument);
+    EXPECT_THROW(pwm_scanner{w_string_dna()}, std::invalid_argument);
+}
+
+TEST(WeightedPwmTest, SameAsNaive) {
+    std::mt19937 gen(1);
+
+    for (size_t m : {1, 5, 12, 31}) {
+        for (double pseudocount : {0., .1}) {
+            w_string_dna profile = random_profile(m, gen);
+            std::string seq = random_sequence(10000, gen);
+            std::array<double, 4> background = {.3, .2, .2, .3};
+
+            pwm_scanner scanner(profile, background, pseudocount);
+            double threshold = scanner.max_score() / 3.;
+
+            auto hits = scanner.find(seq, threshold);
+            size_t k = 0;
+
+            for (size_t i = 0; i + m <= seq.size(); ++i) {
+                double score = naive_score(profile, seq, i, background, pseudocount);
+                bool hit = k < hits.size() && hits[k].first == i;
+
+                // Float scores may differ from double scores around the threshold
+                if (std::abs(score - threshold) > 1e-3) {
+                    ASSERT_EQ(hit, score >= threshold) << "m = " << m << ", window " << i;
+                }
+
+                if (hit) {
+                    EXPECT_NEAR(hits[k].second, score, 1e-3);
+                    EXPECT_EQ(hits[k].second, scanner.score(seq.data() + i));
+                    ++k;
+                }
+            }
+
+            EXPECT_EQ(k, hits.size());
+
+            if (m < 20) {
+                EXPECT_FALSE(hits.empty());
+            }
+        }
+    }
+}
+
+TEST(WeightedPwmTest, Simd) {
+    std::mt19937 gen(2);
+    w_string_dna profile = random_profile(10, gen);
+    std::string seq = random_sequence(3 * pwm_scanner::block_size + 77, gen);
+
+    pwm_scanner scanner(profile, {.25, .25, .25, .25}, .01);
+    auto hits = scanner.find(seq, 0.);
+
+    scanner.set_simd(false);
+
+    EXPECT_EQ(scanner.find(seq, 0.), hits);
+    EXPECT_TRUE(scanner.find(seq.substr(0, 9), -100.).empty());
+    EXPECT_EQ(scanner.find(seq.substr(0, 10), -1000.).size(), 'N' == seq[0] ? 0 : 1);
+}
+
+TEST(WeightedPwmTest, Packed) {
+    std::mt19937 gen(3);
+    w_string_dna profile = random_profile(8, gen);
+    std::string seq = random_sequence(2 * pwm_scanner::block_size + 13, gen, false);
+
+    pwm_scanner scanner(profile);
+    std::vector<std::uint8_t> packed = pack_dna(seq);
+
+    EXPECT_EQ(packed.size(), (seq.size() + 3) / 4);
+
+    for (size_t first : {0, 1, 3, 1000}) {
+        std::vector<std::pair<size_t, float>> hits;
+
+        scanner.scan_2bit(packed.data(), first, seq.size() - first, 2., [&hits](size_t i, float score) {
+            hits.emplace_back(i, score);
+        });
+
+        std::vector<std::pair<size_t, float>> expected;
+
+        scanner.scan(seq.data() + first, seq.size() - first, 2., [&expected](size_t i, float score) {
+            expected.emplace_back(i, score);
+        }, first);
+
+        EXPECT_EQ(hits, expected);
+        EXPECT_FALSE(hits.empty());
+    }
+
+    EXPECT_THROW(pack_dna("ACGN"), std::invalid_argument);
+}
+
+TEST(WeightedPwmTest, Stream) {
+    std::mt19937 gen(4);
+    w_string_dna profile = random_profile(15, gen);
+    std::string seq = random_sequence(50000, gen);
+
+    pwm_scanner scanner(profile, {.25, .25, .25, .25}, .1);
+    auto expected = scanner.find(seq, 1.);
+
+    for (size_t chunk : {1, 7, 1000, 60000}) {
+        pwm_stream stream(scanner, 1.);
+        std::vector<std::pair<size_t, float>> hits;
+
+        for (size_t i = 0; i < seq.size(); i += chunk) {
+            stream.feed(seq.data() + i, std::min(chunk, seq.size() - i), [&hits](size_t i, float score) {
+                hits.emplace_back(i, score);
+            });
+        }
+
+        EXPECT_EQ(hits, expected) << "chunk " << chunk;
+        EXPECT_EQ(stream.position(), seq.size() - 14);
+    }
+}
\ No newline at end of file
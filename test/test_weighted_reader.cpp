@@ -0,0 +1,209 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <sstream>
+#include <wstr/weighted_reader.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedReaderTest : public WstrTest<T>
+{
+    
+};
+
+TYPED_TEST_SUITE(WeightedReaderTest, MyTypes);
+
+//! Check that both weighted strings have exactly the same probabilities
+template <class WString>
+void expect_same(const WString& a, const WString& b, const std::string& alph)
+{
+    ASSERT_EQ(a.size(), b.size());
+    EXPECT_EQ(a.gap(), b.gap());
+
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (char c : alph) {
+            EXPECT_EQ(a[i].p(c), b[i].p(c)) << "position " << i << ", letter " << c;
+        }
+    }
+}
+
+TYPED_TEST(WeightedReaderTest, SameAsStream) {
+    using WType = weighted_string<TypeParam>;
+
+    WType expected, ws;
+
+    TEST_FILE("ws1.txt") >> expected;
+    load_ws(TEST_PATH("ws1.txt"), ws);
+
+    expect_same(ws, expected, "abcd");
+    EXPECT_EQ(ws.heaviest(), "addb");
+
+    // The weighted string is cleared before reading
+    load_ws(TEST_PATH("ws1.txt"), ws);
+
+    EXPECT_EQ(ws.size(), 4);
+}
+
+TYPED_TEST(WeightedReaderTest, Gap) {
+    using WType = weighted_string<TypeParam>;
+
+    WType expected, ws;
+
+    EXPECT_THROW({
+        load_ws(TEST_PATH("ws2.txt"), ws);
+    }, ws_parse_error);
+
+    TEST_FILE("ws2.txt") >> ws_not_strict >> ws_gap >> expected;
+    load_ws(TEST_PATH("ws2.txt"), ws, ws_options{false, true});
+
+    EXPECT_TRUE(ws.has_gap());
+    EXPECT_EQ(ws.gap(), 'j');
+    expect_same(ws, expected, "abcdefghij");
+}
+
+TYPED_TEST(WeightedReaderTest, Collection) {
+    using WType = std::vector<weighted_string<TypeParam>>;
+
+    WType expected, wsv;
+
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> expected;
+    load_ws(TEST_PATH("wsv1.txt"), wsv, ws_options{true, false, .000000001});
+
+    ASSERT_EQ(wsv.size(), 4);
+
+    for (size_t i = 0; i < 4; ++i) {
+        expect_same(wsv[i], expected[i], "ACGT");
+    }
+
+    EXPECT_EQ(wsv[2].heaviest(), "TACCTGGTTGATCCTGCCAGTAGT");
+
+    TEST_FILE("wsv2.txt") >> ws_gap >> expected;
+    load_ws(TEST_PATH("wsv2.txt"), wsv, ws_options{true, true});
+
+    ASSERT_EQ(wsv.size(), 3);
+
+    for (size_t i = 0; i < 3; ++i) {
+        EXPECT_EQ(wsv[i].gap(), '-');
+        expect_same(wsv[i], expected[i], "ab-");
+    }
+}
+
+TYPED_TEST(WeightedReaderTest, Format) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws;
+    std::string buffer = "3\r\nabc\r\n\t+.5\t.25 0.25\r\n\n1e0 -0 0\n  0.125 +0.375   5e-1  ";
+
+    parse_ws(buffer.data(), buffer.data() + buffer.size(), ws);
+
+    ASSERT_EQ(ws.size(), 3);
+    EXPECT_EQ(ws[0].p('a'), .5);
+    EXPECT_EQ(ws[0].p('c'), .25);
+    EXPECT_EQ(ws[1].p('a'), 1.);
+    EXPECT_EQ(ws[1].p('b'), 0.);
+    EXPECT_EQ(ws[2].p('b'), .375);
+    EXPECT_EQ(ws[2].p('c'), .5);
+}
+
+TYPED_TEST(WeightedReaderTest, Errors) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws;
+
+    auto error_line = [&ws](const std::string& buffer, const ws_options& options = ws_options()) -> size_t {
+        try {
+            parse_ws(buffer.data(), buffer.data() + buffer.size(), ws, options);
+        }
+        catch (const ws_parse_error& e) {
+            return e.line();
+        }
+
+        return 0;
+    };
+
+    // Missing value
+    EXPECT_EQ(error_line("2\nab\n.5 .5\n1\n"), 4);
+    // Extra value
+    EXPECT_EQ(error_line("2\nab\n.5 .5 0\n1 0\n"), 3);
+    // Not a number
+    EXPECT_EQ(error_line("2\nab\n.5 .5\n1 zero\n"), 4);
+    EXPECT_EQ(error_line("2\nab\n.5 .5\n1 0x\n"), 4);
+    // Not enough positions
+    EXPECT_EQ(error_line("3\nab\n.5 .5\n1 0\n"), 5);
+    // Bad size
+    EXPECT_EQ(error_line("two\nab\n.5 .5\n1 0\n"), 1);
+    // Sum different from 1
+    EXPECT_EQ(error_line("2\nab\n.5 .5\n\n\n.5 .4\n"), 6);
+    // Valid file
+    EXPECT_EQ(error_line("2\nab\n.5 .5\n1 0"), 0);
+
+    ws_options not_strict;
+    not_strict.strict = false;
+
+    EXPECT_EQ(error_line("2\nab\n.5 .5\n\n\n.5 .4\n", not_strict), 0);
+    EXPECT_EQ(ws.size(), 2);
+}
+
+TYPED_TEST(WeightedReaderTest, Parallel) {
+    using WType = std::vector<weighted_string<TypeParam>>;
+
+    for (size_t threads : {0, 1, 2, 3, 8}) {
+        WType expected, wsv;
+
+        load_ws(TEST_PATH("wsv1.txt"), expected, ws_options{true, false, .000000001});
+        load_ws_parallel(TEST_PATH("wsv1.txt"), wsv, ws_options{true, false, .000000001}, threads);
+
+        ASSERT_EQ(wsv.size(), expected.size());
+
+        for (size_t i = 0; i < wsv.size(); ++i) {
+            expect_same(wsv[i], expected[i], "ACGT");
+        }
+
+        load_ws(TEST_PATH("wsv2.txt"), expected, ws_options{true, true});
+        load_ws_parallel(TEST_PATH("wsv2.txt"), wsv, ws_options{true, true}, threads);
+
+        ASSERT_EQ(wsv.size(), expected.size());
+
+        for (size_t i = 0; i < wsv.size(); ++i) {
+            expect_same(wsv[i], expected[i], "ab-");
+        }
+    }
+}
+
+TYPED_TEST(WeightedReaderTest, ParallelErrors) {
+    using WType = std::vector<weighted_string<TypeParam>>;
+
+    WType wsv;
+
+    auto error_line = [&wsv](const std::string& buffer, size_t threads) -> size_t {
+        try {
+            parse_ws_parallel(buffer.data(), buffer.data() + buffer.size(), wsv, ws_options(), threads);
+        }
+        catch (const ws_parse_error& e) {
+            return e.line();
+        }
+
+        return 0;
+    };
+
+    for (size_t threads : {1, 2, 4}) {
+        // Valid, with empty strings and blank lines
+        EXPECT_EQ(error_line("4\nab\n1\n.5 .5\n0\n\n2\n1 0\n\n0 1\n0", threads), 0);
+        EXPECT_EQ(wsv.size(), 4);
+        EXPECT_EQ(wsv[2].size(), 2);
+        EXPECT_EQ(wsv[2][1].p('b'), 1.);
+
+        // Errors in the second and fourth strings, the first one is always reported
+        EXPECT_EQ(error_line("4\nab\n1\n.5 .5\n1\n.5 .4\n1\n1 0\n1\n.5 x\n", threads), 6);
+        // Missing position in the second string
+        EXPECT_EQ(error_line("3\nab\n1\n.5 .5\n2\n.5 .5\n1\n1 0\n", threads), 7);
+        // Error in the first string before an error in the sizes
+        EXPECT_EQ(error_line("3\nab\n1\n.5 .4\n1\n.5 .5\n.5 .5\n1\n1 0\n", threads), 4);
+        EXPECT_EQ(error_line("3\nab\n1\n.5 .5\n1\n.5 .5\n.5 .5\n1\n1 0\n", threads), 7);
+        // Missing strings
+        EXPECT_EQ(error_line("3\nab\n1\n.5 .5\n", threads), 5);
+    }
+}
\ No newline at end of file
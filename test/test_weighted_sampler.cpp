@@ -0,0 +1,166 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <map>
+#include <random>
+#include <wstr/weighted_sampler.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedSamplerTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedSamplerTest, MyTypes);
+
+TYPED_TEST(WeightedSamplerTest, Frequencies) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws = {
+        this->el({{'a', .5}, {'b', .25}, {'c', .125}, {'d', .125}}),
+        this->el({{'a', 1.}}),
+        this->el({{'b', .1}, {'c', .9}})
+    };
+
+    ws_sampler sampler(ws);
+
+    ASSERT_EQ(sampler.size(), 3);
+    EXPECT_EQ(sampler.table_size(0), 4);
+    EXPECT_EQ(sampler.table_size(1), 1);
+    EXPECT_EQ(sampler.table_size(2), 2);
+
+    const size_t count = 200000;
+    std::vector<std::map<char, size_t>> counts(3);
+    splitmix64 rng(42);
+    char s[3];
+
+    for (size_t _ = 0; _ < count; ++_) {
+        ASSERT_EQ(sampler.sample(s, rng), 3);
+
+        for (size_t i = 0; i < 3; ++i) {
+            ++counts[i][s[i]];
+        }
+    }
+
+    for (size_t i = 0; i < 3; ++i) {
+        for (const auto& c : counts[i]) {
+            // The standard deviation of a frequency is at most 0.5 / sqrt(count) ~ 0.0011
+            EXPECT_NEAR(static_cast<double>(c.second) / count, ws[i].p(c.first), .006) << "position " << i << ", letter " << c.first;
+            EXPECT_GT(ws[i].p(c.first), 0.);
+        }
+    }
+
+    EXPECT_EQ(counts[1]['a'], count);
+}
+
+TYPED_TEST(WeightedSamplerTest, Gaps) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws = {
+        this->el({{'a', 1.}}),
+        this->el({{'-', 1.}}),
+        this->el({{'a', .5}, {'-', .5}}),
+        this->el({{'b', 1.}})
+    };
+
+    ws.set_gap('-');
+
+    ws_sampler sampler(ws);
+    splitmix64 rng(1);
+
+    EXPECT_EQ(sampler.gap(), '-');
+
+    std::string s(4, '\0');
+    EXPECT_EQ(sampler.sample(&s[0], rng), 4);
+    EXPECT_EQ(s[1], '-');
+
+    std::map<std::string, size_t> counts;
+
+    for (size_t _ = 0; _ < 1000; ++_) {
+        std::string u(4, '\0');
+        u.resize(sampler.sample(&u[0], rng, false));
+        ++counts[u];
+    }
+
+    ASSERT_EQ(counts.size(), 2);
+    EXPECT_GT(counts["ab"], 400);
+    EXPECT_GT(counts["aab"], 400);
+
+    // A sampler on a view has the gap of the view
+    EXPECT_FALSE(ws_sampler(weighted_string_view<TypeParam>(ws.data(), ws.size())).has_gap());
+}
+
+TYPED_TEST(WeightedSamplerTest, Errors) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws = {this->el({{'a', 1.}}), weighted_char<TypeParam>()};
+
+    EXPECT_THROW({
+        ws_sampler sampler(ws);
+    }, std::invalid_argument);
+}
+
+TEST(WeightedSamplerTest, Batch) {
+    std::mt19937 gen(3);
+    w_string_map ws = random_ws<w_char_map>(50, gen, "ab-", 0.);
+    ws.set_gap('-');
+
+    ws_sampler sampler(ws);
+
+    const size_t count = 1000;
+    std::vector<char> expected(count * ws.size()), out(count * ws.size());
+    std::vector<size_t> expected_lengths(count), lengths(count);
+
+    sampler.sample_batch(expected.data(), expected_lengths.data(), count, 7, 0, 1, false);
+
+    // Each sample is the one of its own stream
+    for (size_t k = 0; k < count; k += 97) {
+        splitmix64 rng = splitmix64::stream(7, k);
+        std::string s(ws.size(), '\0');
+        s.resize(sampler.sample(&s[0], rng, false));
+
+        EXPECT_EQ(s, std::string(expected.data() + k * ws.size(), expected_lengths[k]));
+    }
+
+    // Same samples with several threads
+    sampler.sample_batch(out.data(), lengths.data(), count, 7, 0, 4, false);
+
+    EXPECT_EQ(out, expected);
+    EXPECT_EQ(lengths, expected_lengths);
+
+    // Same samples with two batches
+    sampler.sample_batch(out.data(), lengths.data(), count / 2, 7, 0, 2, false);
+    sampler.sample_batch(out.data() + count / 2 * ws.size(), lengths.data() + count / 2, count - count / 2, 7, count / 2, 3, false);
+
+    EXPECT_EQ(out, expected);
+    EXPECT_EQ(lengths, expected_lengths);
+
+    // Another seed gives other samples
+    sampler.sample_batch(out.data(), nullptr, count, 8);
+
+    EXPECT_NE(out, expected);
+}
+
+TEST(WeightedSamplerTest, Generator) {
+    splitmix64 a(5), b(5);
+
+    std::uniform_int_distribution<int> dice(1, 6);
+    std::vector<int> faces(7, 0);
+
+    for (size_t _ = 0; _ < 6000; ++_) {
+        EXPECT_EQ(a(), b());
+        ++faces[dice(a)];
+        b();
+    }
+
+    for (int f = 1; f <= 6; ++f) {
+        EXPECT_NEAR(faces[f], 1000, 150);
+    }
+
+    EXPECT_NE(splitmix64::stream(5, 0)(), splitmix64::stream(5, 1)());
+    EXPECT_NE(splitmix64::stream(5, 0)(), splitmix64::stream(6, 0)());
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+
+#include <random>
+#include <sstream>
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_stream.hpp>
+
+using namespace wstr;
+
+//! Text of a random DNA weighted string of n positions
+static std::string random_text(size_t n)
+{
+    std::mt19937 gen(n);
+    std::uniform_int_distribution<int> letter(0, 3);
+
+    std::ostringstream out;
+    out << n << "\n\nACGT\n";
+
+    for (size_t i = 0; i < n; ++i) {
+        std::vector<double> p(4, 0.);
+        p[letter(gen)] += .5;
+        p[letter(gen)] += .25;
+        p[letter(gen)] += .25;
+
+        out << p[0] << " " << p[1] << "\t" << p[2] << " " << p[3] << (i % 10 ? "\n" : "\n\n");
+    }
+
+    return out.str();
+}
+
+//! Read all blocks and check that they are the positions of the weighted string
+template <class Container>
+void expect_blocks(ws_stream_reader<Container>& reader, const weighted_string<Container>& ws)
+{
+    weighted_string_view<Container> block;
+    size_t position = 0;
+
+    EXPECT_EQ(reader.size(), ws.size());
+
+    while (reader.next(block)) {
+        ASSERT_EQ(reader.block_position(), position);
+        ASSERT_LE(block.size(), reader.block_size());
+        ASSERT_LE(position + block.size(), ws.size());
+        EXPECT_EQ(block.gap(), ws.gap());
+
+        for (size_t i = 0; i < block.size(); ++i) {
+            ASSERT_EQ(block[i], ws[position + i]) << "position " << position + i;
+        }
+
+        position += block.size();
+    }
+
+    EXPECT_EQ(position, ws.size());
+    EXPECT_FALSE(reader.next(block));
+}
+
+TEST(WeightedStreamTest, Blocks) {
+    for (size_t n : {0, 1, 10, 5000}) {
+        std::string text = random_text(n);
+
+        w_string_dna ws;
+        parse_ws(text.data(), text.data() + text.size(), ws);
+
+        for (size_t block_size : {1, 7, 1000, 100000}) {
+            for (bool background : {false, true}) {
+                std::istringstream in(text);
+                ws_stream_reader<dna_container<dna_alph>> reader(in, block_size, ws_options(), background);
+
+                EXPECT_EQ(reader.alphabet(), "ACGT");
+                expect_blocks(reader, ws);
+            }
+        }
+    }
+}
+
+TEST(WeightedStreamTest, File) {
+    weighted_string<dna_container<dna_alph_gap>> ws;
+    TEST_FILE("dna2.txt") >> ws_not_strict >> ws_gap >> ws;
+
+    ws_options options;
+    options.strict = false;
+    options.gap = true;
+
+    ws_stream_reader<dna_container<dna_alph_gap>> reader(TEST_PATH("dna2.txt"), 2, options);
+    expect_blocks(reader, ws);
+
+    EXPECT_THROW(ws_stream_reader<dna_container<dna_alph_gap>>(TEST_PATH("does_not_exist")), std::runtime_error);
+}
+
+TEST(WeightedStreamTest, Errors) {
+    for (bool background : {false, true}) {
+        weighted_string_view<dna_container<dna_alph>> block;
+
+        // Missing positions
+        std::istringstream missing("3\nACGT\n.25 .25 .25 .25\n");
+        ws_stream_reader<dna_container<dna_alph>> reader1(missing, 1, ws_options(), background);
+
+        EXPECT_TRUE(reader1.next(block));
+        EXPECT_THROW(reader1.next(block), ws_parse_error);
+        EXPECT_FALSE(reader1.next(block));
+
+        // Sum of probabilities, with the line of the error
+        std::istringstream strict("3\nACGT\n.25 .25 .25 .25\n.25 .25 .25 .25\n.5 .25 .25 .25\n");
+        ws_stream_reader<dna_container<dna_alph>> reader2(strict, 2, ws_options(), background);
+
+        EXPECT_TRUE(reader2.next(block));
+
+        try {
+            reader2.next(block);
+            FAIL() << "expected a ws_parse_error";
+        }
+        catch (const ws_parse_error& e) {
+            EXPECT_EQ(e.line(), 5);
+        }
+
+        // The reader can be destroyed before all blocks are read
+        std::string text = random_text(1000);
+        std::istringstream in(text);
+        ws_stream_reader<dna_container<dna_alph>> reader3(in, 10, ws_options(), background);
+
+        EXPECT_TRUE(reader3.next(block));
+    }
+
+    std::istringstream header("ACGT\n");
+    EXPECT_THROW((ws_stream_reader<dna_container<dna_alph>>(header)), ws_parse_error);
+
+    std::istringstream empty("");
+    EXPECT_THROW((ws_stream_reader<dna_container<dna_alph>>(empty)), ws_parse_error);
+}
\ No newline at end of file
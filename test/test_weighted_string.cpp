@@ -3,6 +3,8 @@
 #include "config.h"
 #include "types.h"
 
+#include <sstream>
+#include <thread>
 #include <wstr/weighted_string.hpp>
 
 using namespace wstr;
@@ -219,4 +221,308 @@ TYPED_TEST(WeightedStringTest, FromFileCollectionGap) {
     EXPECT_TRUE(wsv[0].heaviest_ungap() == "aabaab" || wsv[0].heaviest_ungap() == "aabab") << "value is " << wsv[0].heaviest_ungap();
     EXPECT_EQ(wsv[1].heaviest_ungap(), "ababa");
     EXPECT_TRUE(wsv[2].heaviest_ungap() == "ababa" || wsv[2].heaviest_ungap() == "aaba") << "value is " << wsv[2].heaviest_ungap();
+}
+
+TEST(WeightedStringTest, StaticTranslator) {
+    using Static = static_ws_translator<test_alphabet>;
+    using Basic = basic_ws_translator<test_alphabet>;
+
+    EXPECT_EQ(Static::size, strlen(test_alphabet));
+
+    for (size_t i = 0; i < strlen(test_alphabet); ++i) {
+        char c = test_alphabet[i];
+
+        EXPECT_EQ(Static::find_indice(c), Basic::get_indice(c));
+        EXPECT_EQ(Static::get_indice(c), i);
+        EXPECT_EQ(Static::get_element(i), c);
+    }
+
+    EXPECT_EQ(Static::find_indice('z'), Static::npos);
+    EXPECT_EQ(Static::find_indice('\0'), Static::npos);
+    EXPECT_EQ(Static::find_indice(static_cast<char>(0xE9)), Static::npos);
+
+    EXPECT_THROW({
+        Static::get_indice('z');
+    }, std::runtime_error);
+
+    w_char_array<test_alphabet> wc;
+    wc['b'] = 1.;
+
+    EXPECT_EQ(wc.at('b'), 1.);
+    EXPECT_EQ(wc.at('z'), 0.);
+    EXPECT_THROW({
+        wc['z'];
+    }, std::runtime_error);
+}
+
+TEST(WeightedStringTest, LogArray) {
+    static const char dna[] = "ACGT";
+
+    std::vector<w_string_array<dna>> wsv;
+    std::vector<w_string_log_array<dna>> wslv;
+
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> wsv;
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> wslv;
+
+    ASSERT_EQ(wslv.size(), wsv.size());
+
+    for (size_t j = 0; j < wsv.size(); ++j) {
+        ASSERT_EQ(wslv[j].size(), wsv[j].size());
+        EXPECT_EQ(wslv[j].heaviest(), wsv[j].heaviest());
+
+        for (size_t i = 0; i < wsv[j].size(); ++i) {
+            for (char c : std::string(dna)) {
+                EXPECT_NEAR(wslv[j][i].p(c), wsv[j][i].p(c), 1e-15);
+            }
+        }
+
+        std::string h = wsv[j].heaviest();
+        EXPECT_NEAR(wslv[j].log_p(0, h), wsv[j].log_p(0, h), 1e-12);
+    }
+
+    // The product of probabilities of a long string underflows but not its logarithm
+    w_string_log_array<dna> ws(2000, w_string_log_array<dna>::w_char({.6, .2, .1, .1}));
+
+    double product = 1.;
+    for (const auto& wc : ws) {
+        product *= wc.p('C');
+    }
+
+    EXPECT_EQ(product, 0.);
+    EXPECT_NEAR(ws.log_p(0, std::string(2000, 'C')), 2000 * std::log(.2), 1e-9);
+    EXPECT_EQ(ws.log_p(0, "ACGZ"), -std::numeric_limits<double>::infinity());
+
+    EXPECT_THROW({
+        ws.log_p(1999, "AA");
+    }, std::out_of_range);
+}
+
+TEST(WeightedStringTest, QuantizedArray) {
+    static const char dna[] = "ACGT";
+
+    std::vector<w_string_array<dna>> wsv;
+    std::vector<w_string_float_array<dna>> wsfv;
+    std::vector<w_string_u16_array<dna>> ws16v;
+    std::vector<w_string_u8_array<dna>> ws8v;
+
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> wsv;
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> wsfv;
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> ws16v;
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> ws8v;
+
+    ASSERT_EQ(wsfv.size(), wsv.size());
+    ASSERT_EQ(ws16v.size(), wsv.size());
+    ASSERT_EQ(ws8v.size(), wsv.size());
+
+    for (size_t j = 0; j < wsv.size(); ++j) {
+        EXPECT_EQ(wsfv[j].heaviest(), wsv[j].heaviest());
+        EXPECT_EQ(ws16v[j].heaviest(), wsv[j].heaviest());
+        EXPECT_EQ(ws8v[j].heaviest(), wsv[j].heaviest());
+
+        for (size_t i = 0; i < wsv[j].size(); ++i) {
+            for (char c : std::string(dna)) {
+                EXPECT_NEAR(wsfv[j][i].p(c), wsv[j][i].p(c), 1e-7);
+                EXPECT_NEAR(ws16v[j][i].p(c), wsv[j][i].p(c), .5 / 65535);
+                EXPECT_NEAR(ws8v[j][i].p(c), wsv[j][i].p(c), .5 / 255);
+            }
+        }
+    }
+
+    EXPECT_EQ(sizeof(w_string_u8_array<dna>::w_char), 4);
+    EXPECT_EQ(sizeof(w_string_u16_array<dna>::w_char), 8);
+    EXPECT_EQ(sizeof(w_string_float_array<dna>::w_char), 16);
+}
+
+TEST(WeightedStringTest, StreamOptions) {
+    std::string text = "2\nab-\n.5 .4 0\n.5 .5 0\n";
+
+    std::istringstream lax(text), strict(text);
+    lax >> ws_not_strict >> ws_gap;
+
+    // Options of a stream do not change the options of other streams
+    EXPECT_FALSE(ws_get_options(lax).strict);
+    EXPECT_TRUE(ws_get_options(lax).gap);
+    EXPECT_TRUE(ws_get_options(strict).strict);
+    EXPECT_FALSE(ws_get_options(strict).gap);
+
+    w_string_map ws;
+
+    lax >> ws;
+    EXPECT_EQ(ws.size(), 2);
+    EXPECT_EQ(ws.gap(), '-');
+
+    EXPECT_THROW({
+        strict >> ws;
+    }, std::invalid_argument);
+
+    // Options are copied with copyfmt
+    std::istringstream copy(text);
+    copy.copyfmt(lax);
+    ws_get_options(lax).precision = .5;
+
+    EXPECT_FALSE(ws_get_options(copy).strict);
+    EXPECT_TRUE(ws_get_options(copy).gap);
+    EXPECT_EQ(ws_get_options(copy).precision, 0.);
+
+    // All options at once
+    std::istringstream explicit_options(text);
+    explicit_options >> ws_options{true, false, .2};
+
+    EXPECT_TRUE(ws_get_options(explicit_options).strict);
+    EXPECT_FALSE(ws_get_options(explicit_options).gap);
+    EXPECT_EQ(ws_get_options(explicit_options).precision, .2);
+
+    w_string_map ws_lax;
+    explicit_options >> ws_lax;
+    EXPECT_EQ(ws_lax.size(), 2);
+}
+
+TEST(WeightedStringTest, ConcurrentStreamOptions) {
+    std::string text = "2\nab-\n.5 .4 0\n.5 .5 0\n";
+    std::vector<int> failures(8, 0);
+    std::vector<std::thread> threads;
+
+    for (size_t t = 0; t < failures.size(); ++t) {
+        threads.emplace_back([&text, &failures, t]() {
+            bool strict = t % 2;
+
+            for (size_t _ = 0; _ < 200; ++_) {
+                std::istringstream in(text);
+                w_string_map ws;
+
+                try {
+                    in >> (strict ? ws_strict : ws_not_strict) >> ws;
+                    failures[t] += strict;
+                }
+                catch (const std::invalid_argument&) {
+                    failures[t] += !strict;
+                }
+            }
+        });
+    }
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+
+    for (int f : failures) {
+        EXPECT_EQ(f, 0);
+    }
+}
+
+//! Memory resource which counts the allocations it makes
+class counting_resource : public std::pmr::memory_resource
+{
+    public:
+
+        size_t allocations = 0;
+        size_t deallocations = 0;
+
+    private:
+
+        void* do_allocate(size_t bytes, size_t alignment) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        void do_deallocate(void* p, size_t bytes, size_t alignment) override
+        {
+            ++deallocations;
+            std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+        }
+
+        bool do_is_equal(const std::pmr::memory_resource& oth) const noexcept override
+        {
+            return this == &oth;
+        }
+};
+
+//! Check that a pmr weighted string and all its containers allocate in a resource
+template <class WString>
+void expect_resource(const WString& ws, std::pmr::memory_resource* resource)
+{
+    EXPECT_EQ(ws.get_allocator().resource(), resource);
+
+    for (const auto& wc : ws) {
+        EXPECT_EQ(wc.probabilities().get_allocator().resource(), resource);
+    }
+}
+
+TEST(WeightedStringTest, PmrCollection) {
+    counting_resource resource;
+
+    w_string_map_collection expected;
+    TEST_FILE("wsv2.txt") >> ws_gap >> expected;
+
+    {
+        pmr::w_string_map_collection wsc(&resource);
+
+        // Nothing should be allocated with the default resource
+        std::pmr::memory_resource* previous = std::pmr::set_default_resource(std::pmr::null_memory_resource());
+        TEST_FILE("wsv2.txt") >> ws_gap >> wsc;
+        std::pmr::set_default_resource(previous);
+
+        ASSERT_EQ(wsc.size(), expected.size());
+
+        for (size_t i = 0; i < wsc.size(); ++i) {
+            ASSERT_EQ(wsc[i].size(), expected[i].size());
+            EXPECT_EQ(wsc[i].gap(), '-');
+            EXPECT_EQ(wsc[i].heaviest(), expected[i].heaviest());
+
+            for (size_t j = 0; j < wsc[i].size(); ++j) {
+                for (char c : std::string("ab-")) {
+                    EXPECT_EQ(wsc[i][j].p(c), expected[i][j].p(c));
+                }
+            }
+
+            expect_resource(wsc[i], &resource);
+        }
+
+        EXPECT_GT(resource.allocations, wsc.size());
+    }
+
+    EXPECT_EQ(resource.allocations, resource.deallocations);
+}
+
+TEST(WeightedStringTest, PmrCopy) {
+    std::pmr::monotonic_buffer_resource first, second;
+
+    pmr::w_string_map ws(&first);
+    TEST_FILE("ws2.txt") >> ws_not_strict >> ws_gap >> ws;
+
+    expect_resource(ws, &first);
+
+    pmr::w_string_map copy(ws, &second);
+
+    EXPECT_EQ(copy, ws);
+    EXPECT_EQ(copy.gap(), 'j');
+    expect_resource(copy, &second);
+
+    pmr::w_string_map moved(std::move(copy), &first);
+
+    EXPECT_EQ(moved, ws);
+    EXPECT_EQ(moved.gap(), 'j');
+    expect_resource(moved, &first);
+}
+
+TEST(WeightedStringTest, PmrParse) {
+    std::string text = "2\nabcd\n2\n.5 .5 0 0\n0 0 0 1\n1\n.25 .25 .25 .25\n";
+
+    std::pmr::monotonic_buffer_resource resource;
+
+    pmr::w_string_sparse_collection wsc(&resource);
+    std::istringstream(text) >> wsc;
+
+    ASSERT_EQ(wsc.size(), 2);
+    EXPECT_EQ(wsc[0].heaviest(), "ad");
+    EXPECT_EQ(wsc[1][0].p('c'), .25);
+    expect_resource(wsc[1], &resource);
+
+    pmr::w_string_array_collection<test_alphabet> wsa(&resource);
+    std::istringstream(text) >> wsa;
+
+    ASSERT_EQ(wsa.size(), 2);
+    EXPECT_EQ(wsa[0].heaviest(), "ad");
+    EXPECT_EQ(wsa[0].get_allocator().resource(), &resource);
 }
\ No newline at end of file
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "config.h"
+#include "types.h"
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_string_view.hpp>
+#include <wstr/weighted_matching.hpp>
+#include <wstr/weighted_index.hpp>
+#include <wstr/weighted_matrix.hpp>
+#include <wstr/weighted_mapped.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedStringViewTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedStringViewTest, MyTypes);
+
+TYPED_TEST(WeightedStringViewTest, Basic) {
+    using CType = WeightedStringViewTest<TypeParam>;
+
+    weighted_string<TypeParam> ws = {
+        CType::el({{'a', 1.}}),
+        CType::el({{'a', .2}, {'b', .6}, {'c', .2}}),
+        CType::el({{'a', .4}, {'-', .6}}),
+        CType::el({{'c', .9}, {'d', .1}}),
+    };
+
+    ws.set_gap('-');
+
+    weighted_string_view view(ws);
+
+    ASSERT_EQ(view.size(), 4);
+    EXPECT_FALSE(view.empty());
+    EXPECT_EQ(view.data(), ws.data());
+    EXPECT_EQ(view.gap(), '-');
+    EXPECT_EQ(&view[1], &ws[1]);
+    EXPECT_EQ(&view.front(), &ws[0]);
+    EXPECT_EQ(&view.back(), &ws[3]);
+    EXPECT_EQ(view.heaviest(), ws.heaviest());
+    EXPECT_EQ(view.heaviest_ungap(), ws.heaviest_ungap());
+    EXPECT_EQ(view.log_p(1, "b-c"), ws.log_p(1, "b-c"));
+    EXPECT_EQ(view.to_weighted_string(), ws);
+    EXPECT_EQ(std::distance(view.begin(), view.end()), 4);
+    EXPECT_THROW(view.at(4), std::out_of_range);
+    EXPECT_THROW(view.log_p(2, "-cc"), std::out_of_range);
+
+    // Substrings do not copy positions
+    weighted_string_view<TypeParam> sub(ws, 1, 2);
+
+    ASSERT_EQ(sub.size(), 2);
+    EXPECT_EQ(sub.data(), ws.data() + 1);
+    EXPECT_EQ(sub.heaviest(), "b-");
+    EXPECT_EQ(sub.heaviest_ungap(), "b");
+    EXPECT_EQ(sub.subview(1).heaviest(), "-");
+    EXPECT_EQ(sub.subview(0, 10).size(), 2);
+    EXPECT_TRUE(sub.subview(2).empty());
+    EXPECT_THROW(sub.subview(3), std::out_of_range);
+    EXPECT_THROW((weighted_string_view<TypeParam>(ws, 5)), std::out_of_range);
+
+    std::string h(sub.size(), ' ');
+    EXPECT_EQ(sub.heaviest_ungap(&h[0]), 1);
+    EXPECT_EQ(h[0], 'b');
+
+    sub.set_gap(NO_GAP);
+    EXPECT_EQ(sub.heaviest_ungap(), "b-");
+    EXPECT_EQ(ws.gap(), '-');
+}
+
+TEST(WeightedStringViewTest, Algorithms) {
+    w_string_dna ws;
+    TEST_FILE("dna1.txt") >> ws;
+
+    weighted_string_view<dna_container<dna_alph>> view(ws, 1, 3);
+
+    // Pattern matching on a view (the matcher keeps a copy of the view)
+    weighted_pattern_matcher<weighted_string_view<dna_container<dna_alph>>> matcher(weighted_string_view(ws, 1), 4.);
+    std::vector<size_t> occ = find_occurrences(ws, "GN", 4.);
+    std::vector<size_t> view_occ = matcher.find("GN");
+
+    // The first occurrence is not in the view
+    ASSERT_EQ(occ.front(), 0);
+    occ.erase(occ.begin());
+
+    ASSERT_EQ(view_occ.size(), occ.size());
+
+    for (size_t i = 0; i < occ.size(); ++i) {
+        EXPECT_EQ(view_occ[i] + 1, occ[i]);
+    }
+
+    EXPECT_EQ(find_occurrences(view, "GN", 4.), view_occ);
+
+    // Index of a view
+    weighted_index index(view, 4.);
+    std::vector<size_t> index_occ = index.find("G");
+    std::sort(index_occ.begin(), index_occ.end());
+    EXPECT_EQ(index_occ, find_occurrences(view, "G", 4.));
+
+    // Matrix from a view
+    weighted_matrix<dna_alph> matrix(view);
+    ASSERT_EQ(matrix.size(), 3);
+    EXPECT_EQ(matrix.heaviest(), view.heaviest());
+    EXPECT_EQ(matrix.p(0, 'G'), ws[1].p('G'));
+
+    // Bulk probabilities of a view
+    std::vector<double> p = dna_p_range(view, 'R');
+    ASSERT_EQ(p.size(), 3);
+    EXPECT_EQ(p[2], ws[3].p('R'));
+
+    // Binary file of a view
+    std::string path = testing::TempDir() + "wstr_view.bin";
+    save_ws_binary(path, view);
+
+    mapped_ws_collection<dna_container<dna_alph>> wsc(path);
+    mapped_weighted_string<dna_container<dna_alph>> mapped = wsc[0];
+
+    ASSERT_EQ(mapped.size(), 3);
+    EXPECT_EQ(mapped.to_weighted_string(), view.to_weighted_string());
+}
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <set>
+#include <cmath>
+#include <random>
+#include <algorithm>
+#include <wstr/weighted_top.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedTopTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedTopTest, MyTypes);
+
+//! All strings of non-zero probability, in decreasing order of probability
+template <class WString>
+std::vector<std::pair<std::string, double>> brute_force(const WString& ws)
+{
+    std::vector<std::pair<std::string, double>> strings = {{"", 0.}};
+
+    for (const auto& wc : ws) {
+        std::vector<std::pair<std::string, double>> longer;
+
+        for (const auto& s : strings) {
+            wc.probabilities().for_each([&](char c, double p) {
+                if (p > 0.) {
+                    longer.emplace_back(s.first + c, s.second + wc.log_p(c));
+                }
+            });
+        }
+
+        strings = std::move(longer);
+    }
+
+    std::sort(strings.begin(), strings.end(), [](const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+
+    return strings;
+}
+
+TYPED_TEST(WeightedTopTest, SameAsBruteForce) {
+    using WType = weighted_string<TypeParam>;
+
+    std::mt19937 gen(42);
+
+    for (size_t _ = 0; _ < 20; ++_) {
+        WType ws = random_ws<TypeParam>(1 + gen() % 7, gen);
+        auto expected = brute_force(ws);
+
+        ws_top_strings top(ws);
+        std::set<std::string> seen;
+
+        std::string s;
+        double log_p;
+
+        for (size_t k = 0; k < expected.size(); ++k) {
+            ASSERT_TRUE(top.next(s, log_p));
+            EXPECT_NEAR(log_p, expected[k].second, 1e-9) << "string " << k;
+            EXPECT_NEAR(ws.log_p(0, s), log_p, 1e-9);
+            EXPECT_TRUE(seen.insert(s).second) << s << " given twice";
+        }
+
+        EXPECT_FALSE(top.next(s, log_p));
+        EXPECT_EQ(top_k_strings(ws, 1)[0].first, ws.heaviest());
+    }
+}
+
+TYPED_TEST(WeightedTopTest, Threshold) {
+    using WType = weighted_string<TypeParam>;
+
+    std::mt19937 gen(7);
+    WType ws = random_ws<TypeParam>(6, gen);
+    auto all = brute_force(ws);
+
+    for (double z : {1., 2., 10., 100., 1000.}) {
+        auto strings = strings_above(ws, z);
+        size_t expected = std::count_if(all.begin(), all.end(), [z](const auto& s) {
+            return s.second >= -std::log(z) - log_epsilon;
+        });
+
+        ASSERT_EQ(strings.size(), expected) << "z = " << z;
+        EXPECT_LE(strings.size(), z);
+
+        for (size_t k = 0; k < strings.size(); ++k) {
+            EXPECT_NEAR(strings[k].second, all[k].second, 1e-9);
+        }
+    }
+
+    auto top = top_k_strings(ws, 5);
+
+    ASSERT_EQ(top.size(), std::min<size_t>(5, all.size()));
+    EXPECT_EQ(top[0].first, ws.heaviest());
+}
+
+TYPED_TEST(WeightedTopTest, Window) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws = {
+        this->el({{'a', .9}, {'b', .1}}),
+        this->el({{'a', .4}, {'c', .6}}),
+        this->el({{'b', 1.}}),
+        this->el({{'a', .3}, {'d', .7}})
+    };
+
+    weighted_string_view<TypeParam> window(ws, 1, 3);
+    auto strings = top_k_strings(window, 10);
+
+    ASSERT_EQ(strings.size(), 4);
+    EXPECT_EQ(strings[0].first, "cbd");
+    EXPECT_EQ(strings[1].first, "abd");
+    EXPECT_EQ(strings[2].first, "cba");
+    EXPECT_EQ(strings[3].first, "aba");
+    EXPECT_NEAR(std::exp(strings[3].second), .12, 1e-12);
+}
+
+TYPED_TEST(WeightedTopTest, Errors) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws = {this->el({{'a', 1.}}), weighted_char<TypeParam>()};
+
+    EXPECT_TRUE(top_k_strings(ws, 3).empty());
+    EXPECT_TRUE(top_k_strings(WType(), 3).size() == 1);
+
+    EXPECT_THROW({
+        ws_top_strings top(ws, .5);
+    }, std::invalid_argument);
+}
+
+TEST(WeightedTopTest, FromFile) {
+    std::vector<w_string_map> wsv;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    for (const auto& ws : wsv) {
+        auto expected = brute_force(ws);
+        auto strings = strings_above(ws, 1e9);
+
+        ASSERT_EQ(strings.size(), expected.size());
+
+        for (size_t k = 0; k < strings.size(); ++k) {
+            EXPECT_NEAR(strings[k].second, expected[k].second, 1e-9);
+        }
+    }
+}
\ No newline at end of file
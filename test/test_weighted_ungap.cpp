@@ -0,0 +1,176 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <vector>
+
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_matching.hpp>
+#include <wstr/weighted_ungap.hpp>
+
+using namespace wstr;
+
+//! Compare rank and select with a naive computation on random bits
+static void check_bitvector(size_t n, double density, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution bit(density);
+
+    rank_select_bitvector bv(n);
+    std::vector<size_t> ones;
+
+    for (size_t i = 0; i < n; ++i) {
+        if (bit(gen)) {
+            bv.set(i);
+            ones.push_back(i);
+        }
+    }
+
+    bv.build();
+
+    ASSERT_EQ(bv.size(), n);
+    ASSERT_EQ(bv.ones(), ones.size());
+
+    size_t r = 0;
+
+    for (size_t i = 0; i <= n; ++i) {
+        ASSERT_EQ(bv.rank(i), r) << "rank(" << i << "), n = " << n << ", density = " << density;
+
+        if (i < n) {
+            EXPECT_EQ(bv[i], r < ones.size() && ones[r] == i);
+            EXPECT_EQ(bv.next_one(i), r < ones.size() ? ones[r] : n);
+            r += bv[i];
+        }
+    }
+
+    for (size_t k = 0; k < ones.size(); ++k) {
+        ASSERT_EQ(bv.select(k), ones[k]) << "select(" << k << "), n = " << n << ", density = " << density;
+    }
+}
+
+TEST(WeightedUngapTest, Bitvector) {
+    for (size_t n : {0, 1, 63, 64, 65, 511, 512, 513, 5000, 100000}) {
+        for (double density : {0., 0.001, 0.05, 0.5, 0.99, 1.}) {
+            check_bitvector(n, density, n);
+        }
+    }
+
+    // Long runs of zeros between ones
+    rank_select_bitvector bv(1 << 20);
+    bv.set(3);
+    bv.set(600000);
+    bv.set((1 << 20) - 1);
+    bv.build();
+
+    EXPECT_EQ(bv.select(0), 3);
+    EXPECT_EQ(bv.select(1), 600000);
+    EXPECT_EQ(bv.select(2), (1 << 20) - 1);
+    EXPECT_EQ(bv.rank(600001), 2);
+
+    // Dense and sparse groups of ones, the positions of the sparse groups are stored
+    std::mt19937 gen(1);
+    std::bernoulli_distribution dense(.5), sparse(.002);
+    rank_select_bitvector mixed(3000000);
+    std::vector<size_t> ones;
+
+    for (size_t i = 0; i < mixed.size(); ++i) {
+        if ((i / 500000 % 2 ? sparse : dense)(gen)) {
+            mixed.set(i);
+            ones.push_back(i);
+        }
+    }
+
+    mixed.build();
+
+    ASSERT_EQ(mixed.ones(), ones.size());
+
+    for (size_t k = 0; k < ones.size(); ++k) {
+        ASSERT_EQ(mixed.select(k), ones[k]) << "select(" << k << ")";
+    }
+
+    EXPECT_LT(mixed.memory(), mixed.size() / 8 * 7 / 4);
+}
+
+//! Random gapped DNA weighted string where the gap is the heaviest letter with a given probability
+static w_string_dna_gap random_gapped(size_t n, double gaps, unsigned seed)
+{
+    std::mt19937 gen(seed);
+    std::bernoulli_distribution gap(gaps);
+    std::uniform_int_distribution<size_t> letter(0, 3);
+
+    w_string_dna_gap ws;
+
+    for (size_t i = 0; i < n; ++i) {
+        w_string_dna_gap::w_char wc;
+
+        if (gap(gen)) {
+            wc['-'] = .6;
+            wc[dna_alph[letter(gen)]] = .4;
+        }
+        else {
+            wc[dna_alph[letter(gen)]] = .7;
+            wc['-'] = .3;
+        }
+
+        ws.push_back(wc);
+    }
+
+    return ws;
+}
+
+TEST(WeightedUngapTest, View) {
+    for (double gaps : {0., 0.3, 0.95, 1.}) {
+        w_string_dna_gap ws = random_gapped(3000, gaps, 7);
+        weighted_string_ungap_view<dna_container<dna_alph_gap>> ungap(ws);
+
+        // Reference: copy of the positions which are not gaps
+        w_string_dna_gap copy;
+        std::vector<size_t> positions;
+
+        for (size_t i = 0; i < ws.size(); ++i) {
+            if (ws[i].heaviest_value() != '-') {
+                copy.push_back(ws[i]);
+                positions.push_back(i);
+            }
+        }
+
+        ASSERT_EQ(ungap.size(), copy.size());
+        EXPECT_EQ(ungap.gap(), '-');
+        EXPECT_EQ(ungap.heaviest(), ws.heaviest_ungap());
+        EXPECT_EQ(ungap.heaviest_ungap(), ws.heaviest_ungap());
+        EXPECT_EQ(ungap.to_weighted_string(), copy);
+        EXPECT_EQ(static_cast<size_t>(std::distance(ungap.begin(), ungap.end())), copy.size());
+        EXPECT_EQ(ungap.original().data(), ws.data());
+
+        for (size_t k = 0; k < copy.size(); ++k) {
+            ASSERT_EQ(&ungap[k], &ws[positions[k]]);
+            EXPECT_EQ(ungap.original_position(k), positions[k]);
+            EXPECT_EQ(ungap.ungapped_position(positions[k]), k);
+            EXPECT_FALSE(ungap.is_gap(positions[k]));
+        }
+
+        if (copy.size() >= 3) {
+            std::string s = copy.heaviest().substr(1, 3);
+            EXPECT_EQ(ungap.log_p(1, s), copy.log_p(1, s));
+            EXPECT_EQ(find_occurrences(ungap, s, 10.), find_occurrences(copy, s, 10.));
+        }
+
+        EXPECT_THROW(ungap.at(copy.size()), std::out_of_range);
+    }
+}
+
+TEST(WeightedUngapTest, NoGap) {
+    w_string_dna ws = {
+        w_string_dna::w_char({.2, .4, .2, .2}),
+        w_string_dna::w_char({.1, .5, .1, .3}),
+    };
+
+    weighted_string_ungap_view<dna_container<dna_alph>> ungap(ws);
+
+    EXPECT_EQ(ungap.size(), 2);
+    EXPECT_FALSE(ungap.has_gap());
+    EXPECT_EQ(ungap.heaviest(), "CC");
+
+    weighted_string_ungap_view<dna_container<dna_alph>> empty;
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.begin(), empty.end());
+}
\ No newline at end of file
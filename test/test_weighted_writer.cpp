@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+
+#include "config.h"
+#include "types.h"
+
+#include <cmath>
+#include <random>
+#include <charconv>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <wstr/dna_weighted_string.hpp>
+#include <wstr/weighted_flat.hpp>
+#include <wstr/weighted_reader.hpp>
+#include <wstr/weighted_writer.hpp>
+
+using namespace wstr;
+
+template <typename T>
+class WeightedWriterTest : public WstrTest<T>
+{
+
+};
+
+TYPED_TEST_SUITE(WeightedWriterTest, MyTypes);
+
+static std::string temp_path(const std::string& name)
+{
+    return testing::TempDir() + "wstr_" + name + ".txt";
+}
+
+TYPED_TEST(WeightedWriterTest, RoundTrip) {
+    using WType = weighted_string<TypeParam>;
+
+    WType ws, read;
+    TEST_FILE("ws2.txt") >> ws_not_strict >> ws_gap >> ws;
+
+    std::stringstream text;
+    text << ws;
+    text >> ws_not_strict >> ws_gap >> read;
+
+    EXPECT_EQ(read, ws);
+    EXPECT_EQ(read.gap(), 'j');
+
+    // Same with the buffer reader
+    const std::string s = text.str();
+    parse_ws(s.data(), s.data() + s.size(), read, ws_options{false, true});
+
+    EXPECT_EQ(read, ws);
+}
+
+TYPED_TEST(WeightedWriterTest, RandomRoundTrip) {
+    using WType = weighted_string<TypeParam>;
+
+    std::mt19937 gen(42);
+    WType ws = random_ws<TypeParam>(5000, gen, std::string(test_alphabet, sizeof(test_alphabet) - 2));
+    ws.set_gap('-');
+
+    // The text is larger than the buffer, which is flushed several times
+    std::ostringstream out;
+    ws_writer writer(out, -1, 4096);
+    writer.write(ws);
+    writer.flush();
+
+    WType read;
+    std::string text = out.str();
+    parse_ws(text.data(), text.data() + text.size(), read, ws_options{false, true});
+
+    EXPECT_EQ(read, ws);
+    EXPECT_EQ(read.gap(), '-');
+}
+
+TYPED_TEST(WeightedWriterTest, Collection) {
+    using WType = std::vector<weighted_string<TypeParam>>;
+
+    WType wsv, read;
+    TEST_FILE("wsv2.txt") >> ws_gap >> wsv;
+
+    std::string path = temp_path("wsv2");
+    save_ws(path, wsv);
+    load_ws(path, read, ws_options{true, true});
+
+    EXPECT_EQ(read, wsv);
+
+    for (const auto& ws : read) {
+        EXPECT_EQ(ws.gap(), '-');
+    }
+
+    TEST_FILE("wsv1.txt") >> ws_no_gap >> ws_set_precision(.000000001) >> wsv;
+
+    std::stringstream text;
+    text << wsv;
+    text >> ws_set_precision(.000000001) >> read;
+
+    EXPECT_EQ(read, wsv);
+}
+
+TYPED_TEST(WeightedWriterTest, Empty) {
+    using WType = weighted_string<TypeParam>;
+
+    // Without any letter, the alphabet line still has one letter so that the text is read back
+    std::vector<WType> wsv(2), read;
+
+    std::stringstream text;
+    text << wsv;
+    text >> read;
+
+    EXPECT_FALSE(text.fail());
+    EXPECT_EQ(read, wsv);
+
+    WType ws, read_ws;
+
+    std::stringstream single;
+    single << ws;
+    single >> read_ws;
+
+    EXPECT_FALSE(single.fail());
+    EXPECT_TRUE(read_ws.empty());
+}
+
+TEST(WeightedWriterTest, DnaGap) {
+    w_string_dna_gap_collection wsc;
+    TEST_FILE("dna3.txt") >> wsc;
+
+    // A class inheriting from weighted_string is written as a weighted string, not as a collection
+    std::stringstream text;
+    ws_writer(text).write(wsc[0]);
+
+    w_string_dna_gap read;
+    text >> read;
+
+    EXPECT_EQ(read, wsc[0]);
+    EXPECT_EQ(read.gap(), '-');
+
+    std::string path = temp_path("dna_gap");
+    save_ws(path, wsc[1]);
+
+    w_string_dna_gap saved;
+    std::ifstream file(path);
+    file >> saved;
+
+    EXPECT_EQ(saved, wsc[1]);
+    EXPECT_EQ(saved.gap(), '-');
+
+    // Round trip of the collection, which has its own >> operator
+    std::stringstream collection;
+    collection << wsc;
+
+    w_string_dna_gap_collection read_wsc;
+    collection >> read_wsc;
+
+    ASSERT_EQ(read_wsc.size(), wsc.size());
+
+    for (size_t i = 0; i < wsc.size(); ++i) {
+        EXPECT_EQ(read_wsc[i], wsc[i]);
+        EXPECT_EQ(read_wsc[i].gap(), '-');
+    }
+
+    // Empty weighted strings are written with a letter of the alphabet of the Container
+    w_string_dna_collection empty(2), read_empty;
+
+    std::stringstream empty_text;
+    empty_text << empty;
+    empty_text >> read_empty;
+
+    EXPECT_FALSE(empty_text.fail());
+    EXPECT_EQ(read_empty.size(), 2);
+}
+
+TEST(WeightedWriterTest, Format) {
+    w_string_map ws = {w_char_map({{'b', .75}, {'a', .25}}), w_char_map({{'a', 1.}})};
+
+    std::ostringstream shortest;
+    shortest << ws;
+
+    EXPECT_EQ(shortest.str(), "2\nab\n0.25 0.75\n1 0\n");
+
+    std::ostringstream fixed;
+    fixed << std::fixed << std::setprecision(3) << ws;
+
+    EXPECT_EQ(fixed.str(), "2\nab\n0.250 0.750\n1.000 0\n");
+
+    // The gap is the last letter of the alphabet, even if it has no probability
+    ws.set_gap('0');
+
+    std::ostringstream gap;
+    gap << ws;
+
+    EXPECT_EQ(gap.str(), "2\nab0\n0.25 0.75 0\n1 0 0\n");
+}
+
+//! Text written for a probability
+static std::string format(double v, int precision)
+{
+    w_string_map ws;
+    ws.emplace_back(w_char_map({{'a', v}}), false);
+
+    std::ostringstream out;
+    ws_writer(out, precision).write(ws);
+
+    std::string text = out.str();
+    return text.substr(4, text.size() - 5);
+}
+
+TEST(WeightedWriterTest, Decimals) {
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> uniform(0., 1.);
+
+    std::vector<double> values = {1., .5, .125, .0625, 1e-12, 1.5e-12, 999.999, 1e300, .1 + .2, 2.675};
+
+    for (size_t i = 0; i < 2000; ++i) {
+        double v = uniform(gen);
+        values.push_back(v);
+        values.push_back(std::round(v * 1e6) / 1e6);
+        values.push_back(std::round(v * 1e3) / 1e3);
+    }
+
+    char expected[512];
+
+    for (double v : values) {
+        // Shortest form: same double, and no more digits than std::to_chars
+        std::string shortest = format(v, -1);
+        double read;
+
+        std::from_chars(shortest.data(), shortest.data() + shortest.size(), read);
+        EXPECT_EQ(read, v) << shortest;
+
+        char* last = std::to_chars(expected, expected + sizeof(expected), v).ptr;
+        std::string digits(expected, last);
+        auto significant = [](const std::string& s) {
+            std::string mantissa = s.substr(0, s.find('e'));
+            size_t first = mantissa.find_first_not_of("0.");
+            return std::count_if(mantissa.begin() + std::min(first, mantissa.size()), mantissa.end(), ::isdigit);
+        };
+
+        EXPECT_LE(significant(shortest), significant(digits)) << shortest << " " << digits;
+
+        // Fixed form: exactly the one of std::to_chars (except 0 which is always "0")
+        for (int precision : {0, 1, 2, 3, 6, 9, 12, 15}) {
+            if (0. == v) {
+                EXPECT_EQ(format(v, precision), "0");
+                continue;
+            }
+
+            last = std::to_chars(expected, expected + sizeof(expected), v, std::chars_format::fixed, precision).ptr;
+            EXPECT_EQ(format(v, precision), std::string(expected, last));
+        }
+    }
+}
+
+TEST(WeightedWriterTest, Errors) {
+    std::vector<w_string_map> wsv(2);
+
+    wsv[0].set_gap('-');
+    wsv[1].set_gap('$');
+
+    std::ostringstream out;
+
+    EXPECT_THROW({
+        out << wsv;
+    }, std::invalid_argument);
+
+    EXPECT_THROW({
+        save_ws("/nonexistent/wstr.txt", wsv[0]);
+    }, std::runtime_error);
+}
+
+TEST(WeightedWriterTest, Views) {
+    using Container = dna_container<dna_alph>;
+
+    std::vector<weighted_string<Container>> wsv;
+    TEST_FILE("wsv1.txt") >> ws_set_precision(.000000001) >> wsv;
+
+    flat_ws_collection<Container> flat;
+    flat.append(wsv);
+
+    std::stringstream text;
+    ws_writer(text).write(flat);
+
+    std::vector<weighted_string<Container>> read;
+    text >> ws_set_precision(.000000001) >> read;
+
+    EXPECT_EQ(read, wsv);
+
+    std::ostringstream view, ws;
+    view << weighted_string_view<Container>(wsv[1], 2, 5);
+    ws << weighted_string<Container>(wsv[1].begin() + 2, wsv[1].begin() + 7);
+
+    EXPECT_EQ(view.str(), ws.str());
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
 
+#include <random>
+#include <string>
+#include <vector>
 #include <wstr/weighted_string.hpp>
 
 using namespace wstr;
@@ -31,8 +34,71 @@ inline w_char_array<test_alphabet> WstrTest<w_char_array<test_alphabet>>::el(con
     return new_el;
 }
 
+//! Specify the creation of an element when we use a sparse container
+template<>
+inline w_char_sparse WstrTest<w_char_sparse>::el(const w_char_map& u)
+{
+    w_char_sparse new_el;
+
+    for (const auto& p : u) {
+        new_el[p.first] = p.second;
+    }
+
+    return new_el;
+}
+
+//! Weighted string of n random positions over an alphabet, strict up to rounding errors
+/*!
+  * \param alph     Letters of the positions
+  * \param zero     Probability that a letter has probability 0 at a position
+  * \param certain  Probability that a position has a single letter of probability 1
+  *
+  * Letters with probability 0 are not stored, as by the readers. When all the letters of a position get
+  * probability 0, the first one gets probability 1.
+ */
+template <class Container>
+weighted_string<Container> random_ws(size_t n, std::mt19937& gen, const std::string& alph = "abcd", double zero = .3,
+                                     double certain = 0.)
+{
+    std::uniform_real_distribution<double> uniform(0., 1.);
+    std::uniform_int_distribution<size_t> letter(0, alph.size() - 1);
+    std::vector<double> p(alph.size());
+    weighted_string<Container> ws;
+
+    for (size_t i = 0; i < n; ++i) {
+        Container wc;
+
+        if (uniform(gen) < certain) {
+            wc[alph[letter(gen)]] = 1.;
+        }
+        else {
+            double sum = 0.;
+
+            for (double& x : p) {
+                x = uniform(gen) < zero ? 0. : uniform(gen);
+                sum += x;
+            }
+
+            if (0. == sum) {
+                p[0] = sum = 1.;
+            }
+
+            for (size_t k = 0; k < p.size(); ++k) {
+                if (0. != p[k]) {
+                    wc[alph[k]] = p[k] / sum;
+                }
+            }
+        }
+
+        ws.emplace_back(std::move(wc), false);
+    }
+
+    return ws;
+}
+
 //! Container type to test
 using MyTypes = testing::Types<
     w_char_map,
-    w_char_array<test_alphabet>
+    w_char_array<test_alphabet>,
+    w_char_sparse
 >;
\ No newline at end of file